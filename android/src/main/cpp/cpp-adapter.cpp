@@ -1,6 +1,14 @@
 #include <jni.h>
 #include "cactusOnLoad.hpp"
+#include "CactusModelRegistry.hpp"
 
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void*) {
   return margelo::nitro::cactus::initialize(vm);
 }
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_margelo_nitro_cactus_CactusTrimMemoryProvider_nativeTrimCritical(
+    JNIEnv*, jclass) {
+  margelo::nitro::cactus::CactusModelRegistry::shared().trim(
+      margelo::nitro::cactus::CactusMemoryPressure::Critical);
+}
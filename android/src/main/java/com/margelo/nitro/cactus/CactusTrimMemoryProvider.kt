@@ -0,0 +1,65 @@
+package com.margelo.nitro.cactus
+
+import android.content.ComponentCallbacks2
+import android.content.ContentProvider
+import android.content.ContentValues
+import android.content.res.Configuration
+import android.database.Cursor
+import android.net.Uri
+import kotlin.concurrent.thread
+
+// Created by the system when the app starts, so idle models are unloaded
+// before the process is killed for memory, also while the JS thread is paused
+class CactusTrimMemoryProvider : ContentProvider() {
+  private val callbacks =
+    object : ComponentCallbacks2 {
+      override fun onTrimMemory(level: Int) {
+        if (level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL ||
+          level == ComponentCallbacks2.TRIM_MEMORY_COMPLETE
+        ) {
+          trimCritical()
+        }
+      }
+
+      override fun onLowMemory() = trimCritical()
+
+      override fun onConfigurationChanged(newConfig: Configuration) {}
+    }
+
+  override fun onCreate(): Boolean {
+    System.loadLibrary("cactus")
+    context?.applicationContext?.registerComponentCallbacks(callbacks)
+    return true
+  }
+
+  // Unloading a model can take a while, so it stays off the main thread
+  private fun trimCritical() {
+    thread { nativeTrimCritical() }
+  }
+
+  override fun query(
+    uri: Uri,
+    projection: Array<String>?,
+    selection: String?,
+    selectionArgs: Array<String>?,
+    sortOrder: String?,
+  ): Cursor? = null
+
+  override fun getType(uri: Uri): String? = null
+
+  override fun insert(uri: Uri, values: ContentValues?): Uri? = null
+
+  override fun delete(uri: Uri, selection: String?, selectionArgs: Array<String>?): Int = 0
+
+  override fun update(
+    uri: Uri,
+    values: ContentValues?,
+    selection: String?,
+    selectionArgs: Array<String>?,
+  ): Int = 0
+
+  companion object {
+    @JvmStatic
+    external fun nativeTrimCritical()
+  }
+}
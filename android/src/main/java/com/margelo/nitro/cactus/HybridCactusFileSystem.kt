@@ -7,6 +7,7 @@ import java.io.BufferedOutputStream
 import java.io.File
 import java.io.FileInputStream
 import java.io.FileOutputStream
+import java.io.IOException
 import java.net.HttpURLConnection
 import java.net.URL
 import java.util.zip.ZipEntry
@@ -84,81 +85,133 @@ class HybridCactusFileSystem : HybridCactusFileSystemSpec() {
           throw Error("Invalid URL")
         }
 
-      val tmpZip = File.createTempFile("dl_", ".zip", context.cacheDir)
-      var connection: HttpURLConnection? = null
+      // Kept across calls so an interrupted download resumes where it stopped
+      val partZip = File(context.cacheDir, "dl_${model.replace('/', '_')}.zip.part")
+      var lastPct = -1.0
 
-      try {
-        connection =
-          (url.openConnection() as HttpURLConnection).apply {
-            connectTimeout = 30_000
-            readTimeout = 5 * 60_000
-            instanceFollowRedirects = true
-          }
-        connection.connect()
-        val code = connection.responseCode
-
-        if (code !in 200..299) {
-          connection.disconnect()
-          throw Error("Download failed with HTTP status code: $code")
-        }
+      callback?.invoke(0.0)
 
-        val contentLength = connection.getHeaderFieldLong("Content-Length", -1L)
-        var downloaded = 0L
-        var lastPct = -1.0
-
-        callback?.invoke(0.0)
-
-        connection.inputStream.use { input ->
-          BufferedInputStream(input).use { bis ->
-            FileOutputStream(tmpZip).use { fos ->
-              BufferedOutputStream(fos).use { bos ->
-                val buf = ByteArray(256 * 1024)
-
-                while (true) {
-                  val read = bis.read(buf)
-
-                  if (read == -1) {
-                    break
-                  }
-
-                  bos.write(buf, 0, read)
-                  downloaded += read
-
-                  if (contentLength > 0) {
-                    // cap at 0.99; 1.0 will be sent after unzip
-                    val pct =
-                      floor(
-                        (downloaded.toDouble() / contentLength.toDouble()).coerceIn(
-                          0.0,
-                          1.0,
-                        ) * 99,
-                      ) / 100.0
-
-                    if (pct - lastPct >= 0.01) {
-                      callback?.invoke(pct)
-                      lastPct = pct
-                    }
-                  }
-                }
-              }
+      var attempt = 0
+      while (true) {
+        try {
+          downloadPart(url, partZip) { downloaded, total ->
+            // cap at 0.99; 1.0 will be sent after unzip
+            val pct =
+              floor((downloaded.toDouble() / total.toDouble()).coerceIn(0.0, 1.0) * 99) / 100.0
+
+            if (pct - lastPct >= 0.01) {
+              callback?.invoke(pct)
+              lastPct = pct
             }
           }
+          break
+        } catch (e: IOException) {
+          if (++attempt >= MAX_DOWNLOAD_ATTEMPTS) {
+            throw Error("Failed to download model: ${e.message}")
+          }
         }
+      }
 
+      try {
         modelFile.mkdirs()
-        unzipItem(tmpZip, modelFile)
+        unzipItem(partZip, modelFile)
 
         callback?.invoke(1.0)
       } catch (t: Throwable) {
         modelFile.deleteRecursively()
         throw Error("Failed to download and unzip model: ${t.message}")
       } finally {
-        tmpZip.delete()
-        connection?.disconnect()
+        partZip.delete()
+        validatorFile(partZip).delete()
       }
     }
   }
 
+  private fun downloadPart(
+    url: URL,
+    partZip: File,
+    onProgress: (downloaded: Long, total: Long) -> Unit,
+  ) {
+    val validatorFile = validatorFile(partZip)
+    // A partial file is only resumed against the response it came from
+    val validator = validatorFile.takeIf { it.exists() }?.readText()?.takeIf { it.isNotEmpty() }
+    var downloaded = if (validator != null) partZip.length() else 0L
+    val connection =
+      (url.openConnection() as HttpURLConnection).apply {
+        connectTimeout = 30_000
+        readTimeout = 5 * 60_000
+        instanceFollowRedirects = true
+        if (validator != null && downloaded > 0) {
+          setRequestProperty("Range", "bytes=$downloaded-")
+          // The server sends the whole file instead when it changed since
+          setRequestProperty("If-Range", validator)
+        }
+      }
+
+    try {
+      connection.connect()
+      val code = connection.responseCode
+
+      if (code == 416) {
+        // The partial file no longer matches the remote file
+        partZip.delete()
+        validatorFile.delete()
+        throw IOException("Download range not satisfiable")
+      }
+
+      if (code !in 200..299) {
+        throw Error("Download failed with HTTP status code: $code")
+      }
+
+      // Servers without range support, or whose file changed, send the whole
+      // file again
+      val resumed = code == 206
+      if (!resumed) {
+        downloaded = 0
+        // Weak ETags cannot be used in If-Range
+        val etag = connection.getHeaderField("ETag")?.takeUnless { it.startsWith("W/") }
+        validatorFile.writeText(etag ?: connection.getHeaderField("Last-Modified") ?: "")
+      }
+
+      val contentLength = connection.getHeaderFieldLong("Content-Length", -1L)
+      val total = if (contentLength > 0) downloaded + contentLength else -1L
+
+      connection.inputStream.use { input ->
+        BufferedInputStream(input).use { bis ->
+          FileOutputStream(partZip, resumed).use { fos ->
+            BufferedOutputStream(fos).use { bos ->
+              val buf = ByteArray(256 * 1024)
+
+              while (true) {
+                val read = bis.read(buf)
+
+                if (read == -1) {
+                  break
+                }
+
+                bos.write(buf, 0, read)
+                downloaded += read
+
+                if (total > 0) {
+                  onProgress(downloaded, total)
+                }
+              }
+            }
+          }
+        }
+      }
+
+      if (total > 0 && downloaded < total) {
+        throw IOException("Connection closed after $downloaded of $total bytes")
+      }
+    } finally {
+      connection.disconnect()
+    }
+  }
+
+  // Holds the ETag or Last-Modified of the response a partial file came from
+  private fun validatorFile(partZip: File): File = File(partZip.path + ".validator")
+
   private fun unzipItem(
     zipFile: File,
     outDir: File,
@@ -225,4 +278,8 @@ class HybridCactusFileSystem : HybridCactusFileSystemSpec() {
     val cactusDir = cactusFile()
     return File(cactusDir, "models/$model")
   }
+
+  companion object {
+    private const val MAX_DOWNLOAD_ATTEMPTS = 3
+  }
 }
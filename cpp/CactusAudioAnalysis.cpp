@@ -0,0 +1,73 @@
+#include "CactusAudioAnalysis.hpp"
+
+#include <algorithm>
+
+namespace margelo::nitro::cactus {
+
+CactusAudioAnalysis::CactusAudioAnalysis(const std::vector<float> &samples,
+                                         uint32_t sampleRate)
+    : _sampleCount(samples.size()), _sampleRate(sampleRate),
+      _frameSamples(std::max<size_t>(1, sampleRate * kFrameSeconds)) {
+  const size_t frames = (samples.size() + _frameSamples - 1) / _frameSamples;
+  _energies.resize(frames);
+
+  for (size_t frame = 0; frame < frames; ++frame) {
+    const size_t begin = frame * _frameSamples;
+    const size_t end = std::min(begin + _frameSamples, samples.size());
+    float sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+      sum += samples[i] * samples[i];
+    }
+    _energies[frame] = sum / static_cast<float>(end - begin);
+  }
+}
+
+std::vector<size_t>
+CactusAudioAnalysis::windowBoundaries(double maxWindowSeconds) const {
+  const size_t maxWindowFrames = std::max<size_t>(
+      1, maxWindowSeconds * this->_sampleRate / this->_frameSamples);
+  const size_t searchFrames = std::min<size_t>(
+      maxWindowFrames / 2,
+      kCutSearchSeconds * this->_sampleRate / this->_frameSamples);
+
+  std::vector<size_t> boundaries{0};
+  size_t start = 0;
+  while (this->_energies.size() - start > maxWindowFrames) {
+    const auto searchBegin =
+        this->_energies.begin() + start + maxWindowFrames - searchFrames;
+    const auto searchEnd = this->_energies.begin() + start + maxWindowFrames;
+    start = std::min_element(searchBegin, searchEnd) - this->_energies.begin();
+    boundaries.push_back(start * this->_frameSamples);
+  }
+  boundaries.push_back(this->_sampleCount);
+  return boundaries;
+}
+
+std::vector<bool> CactusAudioAnalysis::speechFrames() const {
+  const size_t frames = this->_energies.size();
+  std::vector<bool> speech(frames, false);
+  if (frames == 0) {
+    return speech;
+  }
+
+  // The quietest tenth of the recording estimates the noise floor
+  std::vector<float> sorted = this->_energies;
+  const auto floor = sorted.begin() + frames / 10;
+  std::nth_element(sorted.begin(), floor, sorted.end());
+  const float threshold =
+      std::max(*floor * kSpeechToNoiseRatio, kMinSpeechEnergy);
+
+  const size_t padding =
+      kSpeechPaddingSeconds * this->_sampleRate / this->_frameSamples;
+  for (size_t frame = 0; frame < frames; ++frame) {
+    if (this->_energies[frame] < threshold) {
+      continue;
+    }
+    const size_t begin = frame > padding ? frame - padding : 0;
+    const size_t end = std::min(frame + padding + 1, frames);
+    std::fill(speech.begin() + begin, speech.begin() + end, true);
+  }
+  return speech;
+}
+
+} // namespace margelo::nitro::cactus
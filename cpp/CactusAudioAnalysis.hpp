@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Energy analysis over 20 ms frames
+class CactusAudioAnalysis {
+public:
+  CactusAudioAnalysis(const std::vector<float> &samples, uint32_t sampleRate);
+
+  size_t frameSamples() const { return _frameSamples; }
+
+  // Sample offsets at which to cut the audio into windows of at most
+  // maxWindowSeconds. Each cut is placed at the quietest frame in the last
+  // seconds of its window, so words are not split between windows.
+  std::vector<size_t> windowBoundaries(double maxWindowSeconds) const;
+
+  // Marks the frames that contain speech, by comparing their energy to the
+  // noise floor of the recording. Frames close to speech are kept as well,
+  // so word onsets and endings are not clipped.
+  std::vector<bool> speechFrames() const;
+
+private:
+  static constexpr double kFrameSeconds = 0.02;
+  static constexpr double kCutSearchSeconds = 5.0;
+  static constexpr double kSpeechPaddingSeconds = 0.2;
+  // Energy of a -50 dBFS signal, below which a frame is never speech
+  static constexpr float kMinSpeechEnergy = 1e-5f;
+  // Speech is at least 6 dB above the noise floor
+  static constexpr float kSpeechToNoiseRatio = 4.0f;
+
+  size_t _sampleCount;
+  uint32_t _sampleRate;
+  size_t _frameSamples;
+  std::vector<float> _energies;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,40 @@
+#include "CactusAudioStream.hpp"
+#include "CactusAudioAnalysis.hpp"
+#include "CactusWav.hpp"
+
+namespace margelo::nitro::cactus {
+
+void CactusAudioStream::push(const float *samples, size_t count) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_samples.insert(this->_samples.end(), samples, samples + count);
+}
+
+size_t CactusAudioStream::write(const std::string &path, bool commit) {
+  std::vector<float> window;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    if (commit) {
+      window.swap(this->_samples);
+      const auto boundaries = CactusAudioAnalysis(window, kWhisperSampleRate)
+                                  .windowBoundaries(kCommitSeconds);
+      // The first window ends at the second boundary
+      const size_t cut = boundaries[1];
+      this->_samples.assign(window.begin() + cut, window.end());
+      window.resize(cut);
+    } else {
+      window = this->_samples;
+    }
+  }
+
+  if (!window.empty()) {
+    writeWav(path, window.data(), window.size());
+  }
+  return window.size();
+}
+
+void CactusAudioStream::clear() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_samples.clear();
+}
+
+} // namespace margelo::nitro::cactus
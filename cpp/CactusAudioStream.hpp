@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Buffers live audio between transcription steps. The JS thread pushes
+// samples while a step writes the current window to disk.
+class CactusAudioStream {
+public:
+  // Longest window a commit writes, which leaves room in the 30 s Whisper
+  // window for the audio pushed while it is transcribed
+  static constexpr double kCommitSeconds = 28;
+
+  void push(const float *samples, size_t count);
+
+  // Writes the buffered window as a WAV file and returns its length in
+  // samples. A committed window is dropped, so the next one starts with the
+  // audio pushed after it. A buffer longer than kCommitSeconds is committed
+  // up to the quietest point of its last seconds, so no word is split, and
+  // the audio after the cut stays buffered.
+  size_t write(const std::string &path, bool commit);
+
+  void clear();
+
+private:
+  std::mutex _mutex;
+  std::vector<float> _samples;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,297 @@
+#include "CactusBenchmark.hpp"
+#include "CactusResponseJson.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <thread>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Nearest-rank percentiles
+std::string latencyJson(std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+
+  auto percentile = [&samples](double p) {
+    if (samples.empty()) {
+      return 0.0;
+    }
+    const size_t rank = std::ceil(p / 100 * samples.size());
+    return samples[std::max<size_t>(rank, 1) - 1];
+  };
+
+  return "{\"p50\":" + std::to_string(percentile(50)) +
+         ",\"p90\":" + std::to_string(percentile(90)) +
+         ",\"p99\":" + std::to_string(percentile(99)) + "}";
+}
+
+double mean(const std::vector<double> &values) {
+  if (values.empty()) {
+    return 0;
+  }
+  double sum = 0;
+  for (const double value : values) {
+    sum += value;
+  }
+  return sum / values.size();
+}
+
+size_t peakResidentBytes() {
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+std::string messagesJson(const std::string &prompt) {
+  return "[{\"role\":\"user\",\"content\":\"" + prompt + "\"}]";
+}
+
+// Common words encode to about one token each
+std::string syntheticPrompt(size_t tokens) {
+  std::string prompt;
+  prompt.reserve(tokens * 6);
+  for (size_t i = 0; i < tokens; i++) {
+    prompt += i ? " hello" : "hello";
+  }
+  return prompt;
+}
+
+template <typename Sections>
+std::string joinJson(const Sections &sections) {
+  std::string json = "[";
+  for (size_t i = 0; i < sections.size(); i++) {
+    json += (i ? "," : "") + sections[i];
+  }
+  return json + "]";
+}
+
+size_t benchmarkCount(double value, const char *name, size_t max) {
+  if (!std::isfinite(value) || value != std::floor(value) || value < 0 ||
+      value > static_cast<double>(max)) {
+    throw std::invalid_argument(std::string("Benchmark ") + name +
+                                " must be a whole number from 0 to " +
+                                std::to_string(max));
+  }
+  return static_cast<size_t>(value);
+}
+
+std::vector<size_t> benchmarkCounts(const std::vector<double> &values,
+                                    const char *name, size_t max) {
+  std::vector<size_t> counts;
+  counts.reserve(values.size());
+  for (const double value : values) {
+    counts.push_back(benchmarkCount(value, name, max));
+  }
+  return counts;
+}
+
+} // namespace
+
+CactusBenchmarkOptions CactusBenchmarkOptions::from(
+    const std::vector<double> &prefillLengths,
+    const std::vector<double> &decodeLengths,
+    const std::vector<double> &embeddingBatchSizes, double iterations,
+    const std::optional<std::string> &imagePath,
+    const std::optional<std::string> &audioPath) {
+  CactusBenchmarkOptions options;
+  options.prefillLengths =
+      benchmarkCounts(prefillLengths, "prefill length", kMaxTokens);
+  options.decodeLengths =
+      benchmarkCounts(decodeLengths, "decode length", kMaxTokens);
+  options.embeddingBatchSizes = benchmarkCounts(
+      embeddingBatchSizes, "embedding batch size", kMaxBatchSize);
+  options.iterations = benchmarkCount(iterations, "iterations", kMaxIterations);
+  options.imagePath = imagePath;
+  options.audioPath = audioPath;
+  return options;
+}
+
+CactusBenchmark::CactusBenchmark(cactus_model_t model, size_t contextSize)
+    : _model(model), _contextSize(contextSize),
+      _responseBuffer(kResponseBufferSize),
+      _embeddingBuffer(kEmbeddingBufferSize) {}
+
+std::string CactusBenchmark::run(const CactusBenchmarkOptions &options) {
+  const size_t iterations = std::max<size_t>(options.iterations, 1);
+
+  std::vector<std::string> prefill;
+  for (const size_t length : options.prefillLengths) {
+    // Leave room for the chat template and the generated token
+    if (length + 64 > this->_contextSize) {
+      continue;
+    }
+    prefill.push_back(this->prefillJson(length, iterations));
+  }
+
+  std::vector<std::string> decode;
+  for (const size_t length : options.decodeLengths) {
+    if (length + 64 > this->_contextSize) {
+      continue;
+    }
+    decode.push_back(this->decodeJson(length, iterations));
+  }
+
+  std::vector<std::string> embedding;
+  for (const size_t batchSize : options.embeddingBatchSizes) {
+    embedding.push_back(this->embeddingJson(batchSize, iterations));
+  }
+
+  std::string json =
+      "{\"thread_count\":" +
+      std::to_string(std::thread::hardware_concurrency()) +
+      ",\"iterations\":" + std::to_string(iterations) +
+      ",\"prefill\":" + joinJson(prefill) + ",\"decode\":" + joinJson(decode) +
+      ",\"embedding\":" + joinJson(embedding);
+
+  if (options.imagePath) {
+    json += ",\"image_embed\":" +
+            this->encodeJson(*options.imagePath, false, iterations);
+  }
+  if (options.audioPath) {
+    json += ",\"audio_embed\":" +
+            this->encodeJson(*options.audioPath, true, iterations);
+  }
+
+  cactus_reset(this->_model);
+
+  return json + ",\"peak_memory_bytes\":" +
+         std::to_string(peakResidentBytes()) + "}";
+}
+
+std::string CactusBenchmark::complete(const std::string &prompt,
+                                      size_t maxTokens) {
+  // Every run starts from an empty cache so prefill is measured in full
+  cactus_reset(this->_model);
+
+  const std::string messages = messagesJson(prompt);
+  const std::string options =
+      "{\"max_tokens\":" + std::to_string(maxTokens) + "}";
+
+  int result = cactus_complete(this->_model, messages.c_str(),
+                               this->_responseBuffer.data(),
+                               this->_responseBuffer.size(), options.c_str(),
+                               nullptr, nullptr, nullptr);
+
+  if (result < 0) {
+    throw std::runtime_error("Cactus benchmark completion failed");
+  }
+
+  return std::string(this->_responseBuffer.data());
+}
+
+std::string CactusBenchmark::prefillJson(size_t promptTokens,
+                                         size_t iterations) {
+  const std::string prompt = syntheticPrompt(promptTokens);
+
+  std::vector<double> timeToFirstToken;
+  std::vector<double> tokensPerSecond;
+  double prefillTokens = 0;
+
+  for (size_t i = 0; i < iterations; i++) {
+    const std::string response = this->complete(prompt, 1);
+    const double ttft = responseNumber(response, "time_to_first_token_ms");
+    prefillTokens = responseNumber(response, "prefill_tokens");
+
+    timeToFirstToken.push_back(ttft);
+    if (ttft > 0) {
+      tokensPerSecond.push_back(prefillTokens * 1000 / ttft);
+    }
+  }
+
+  return "{\"prompt_tokens\":" + std::to_string(promptTokens) +
+         ",\"prefill_tokens\":" + std::to_string(prefillTokens) +
+         ",\"time_to_first_token_ms\":" + latencyJson(timeToFirstToken) +
+         ",\"tokens_per_second\":" + std::to_string(mean(tokensPerSecond)) +
+         "}";
+}
+
+std::string CactusBenchmark::decodeJson(size_t maxTokens, size_t iterations) {
+  const std::string prompt = "Count upwards from one, one number per line.";
+
+  std::vector<double> totalTime;
+  std::vector<double> tokensPerSecond;
+  double decodeTokens = 0;
+
+  for (size_t i = 0; i < iterations; i++) {
+    const std::string response = this->complete(prompt, maxTokens);
+    decodeTokens = responseNumber(response, "decode_tokens");
+
+    totalTime.push_back(responseNumber(response, "total_time_ms"));
+    tokensPerSecond.push_back(responseNumber(response, "tokens_per_second"));
+  }
+
+  return "{\"max_tokens\":" + std::to_string(maxTokens) +
+         ",\"decode_tokens\":" + std::to_string(decodeTokens) +
+         ",\"total_time_ms\":" + latencyJson(totalTime) +
+         ",\"tokens_per_second\":" + std::to_string(mean(tokensPerSecond)) +
+         "}";
+}
+
+std::string CactusBenchmark::embeddingJson(size_t batchSize,
+                                           size_t iterations) {
+  const std::string text = syntheticPrompt(64);
+
+  std::vector<double> latency;
+  for (size_t i = 0; i < iterations; i++) {
+    const auto start = Clock::now();
+    for (size_t j = 0; j < batchSize; j++) {
+      size_t embeddingDim;
+      int result = cactus_embed(this->_model, text.c_str(),
+                                this->_embeddingBuffer.data(),
+                                this->_embeddingBuffer.size() * sizeof(float),
+                                &embeddingDim);
+      if (result < 0) {
+        throw std::runtime_error("Cactus benchmark embedding failed");
+      }
+    }
+    latency.push_back(elapsedMs(start));
+  }
+
+  const double meanLatency = mean(latency);
+  return "{\"batch_size\":" + std::to_string(batchSize) +
+         ",\"latency_ms\":" + latencyJson(latency) +
+         ",\"embeddings_per_second\":" +
+         std::to_string(meanLatency > 0 ? batchSize * 1000 / meanLatency : 0) +
+         "}";
+}
+
+std::string CactusBenchmark::encodeJson(const std::string &path, bool audio,
+                                        size_t iterations) {
+  std::vector<double> latency;
+  for (size_t i = 0; i < iterations; i++) {
+    const auto start = Clock::now();
+    size_t embeddingDim;
+    int result =
+        audio ? cactus_audio_embed(
+                    this->_model, path.c_str(), this->_embeddingBuffer.data(),
+                    this->_embeddingBuffer.size() * sizeof(float),
+                    &embeddingDim)
+              : cactus_image_embed(
+                    this->_model, path.c_str(), this->_embeddingBuffer.data(),
+                    this->_embeddingBuffer.size() * sizeof(float),
+                    &embeddingDim);
+    if (result < 0) {
+      throw std::runtime_error("Cactus benchmark encode failed");
+    }
+    latency.push_back(elapsedMs(start));
+  }
+
+  return "{\"latency_ms\":" + latencyJson(latency) + "}";
+}
+
+} // namespace margelo::nitro::cactus
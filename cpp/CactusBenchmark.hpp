@@ -0,0 +1,59 @@
+#pragma once
+
+#include "cactus_ffi.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+struct CactusBenchmarkOptions {
+  static constexpr size_t kMaxTokens = 1 << 17;
+  static constexpr size_t kMaxBatchSize = 4096;
+  static constexpr size_t kMaxIterations = 1000;
+
+  std::vector<size_t> prefillLengths;
+  std::vector<size_t> decodeLengths;
+  std::vector<size_t> embeddingBatchSizes;
+  size_t iterations = 3;
+  std::optional<std::string> imagePath;
+  std::optional<std::string> audioPath;
+
+  // Throws std::invalid_argument unless every count is a whole number within
+  // its bound, so no JS number reaches a size_t conversion unchecked
+  static CactusBenchmarkOptions
+  from(const std::vector<double> &prefillLengths,
+       const std::vector<double> &decodeLengths,
+       const std::vector<double> &embeddingBatchSizes, double iterations,
+       const std::optional<std::string> &imagePath,
+       const std::optional<std::string> &audioPath);
+};
+
+// Runs a fixed set of workloads through the FFI and reports latency
+// percentiles and throughput as JSON
+class CactusBenchmark {
+public:
+  CactusBenchmark(cactus_model_t model, size_t contextSize);
+
+  std::string run(const CactusBenchmarkOptions &options);
+
+private:
+  static constexpr size_t kResponseBufferSize = 8192;
+  static constexpr size_t kEmbeddingBufferSize = 4096;
+
+  cactus_model_t _model;
+  size_t _contextSize;
+  std::vector<char> _responseBuffer;
+  std::vector<float> _embeddingBuffer;
+
+  std::string complete(const std::string &prompt, size_t maxTokens);
+  std::string prefillJson(size_t promptTokens, size_t iterations);
+  std::string decodeJson(size_t maxTokens, size_t iterations);
+  std::string embeddingJson(size_t batchSize, size_t iterations);
+  std::string encodeJson(const std::string &path, bool audio,
+                         size_t iterations);
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// The sliding window of the KV cache as passed to init. Sizes left unset keep
+// the defaults of the engine.
+struct CactusCacheWindow {
+  static constexpr size_t kDefaultWindowSize = 1024;
+  static constexpr size_t kDefaultSinkSize = 4;
+  static constexpr size_t kMaxWindowSize = 1 << 20;
+
+  std::optional<size_t> windowSize;
+  std::optional<size_t> sinkSize;
+
+  // Throws unless both are whole token counts and the sink leaves room for
+  // recent tokens in the window
+  static CactusCacheWindow from(std::optional<double> windowSize,
+                                std::optional<double> sinkSize) {
+    CactusCacheWindow window{tokenCount("kvWindowSize", windowSize),
+                             tokenCount("kvSinkSize", sinkSize)};
+    if (window.windowSize && *window.windowSize == 0) {
+      throw std::runtime_error("kvWindowSize must be greater than 0");
+    }
+    if (window.sinkSize.value_or(kDefaultSinkSize) >=
+        window.windowSize.value_or(kDefaultWindowSize)) {
+      throw std::runtime_error("kvSinkSize must be smaller than kvWindowSize");
+    }
+    return window;
+  }
+
+private:
+  static std::optional<size_t> tokenCount(const char *name,
+                                          std::optional<double> value) {
+    if (!value) {
+      return std::nullopt;
+    }
+    if (!std::isfinite(*value) || *value != std::floor(*value) ||
+        *value < 0 || *value > kMaxWindowSize) {
+      throw std::runtime_error(std::string(name) +
+                               " must be a whole number from 0 to " +
+                               std::to_string(kMaxWindowSize));
+    }
+    return static_cast<size_t>(*value);
+  }
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,49 @@
+#include "CactusCancellation.hpp"
+#include "CactusJsonReader.hpp"
+
+namespace margelo::nitro::cactus {
+
+CactusCancellation::Request
+CactusCancellation::issue(const std::optional<std::string> &optionsJson) {
+  Request request{++this->_issued, std::nullopt};
+  if (!optionsJson) {
+    return request;
+  }
+
+  double timeoutMs = 0;
+  CactusJsonReader reader(*optionsJson);
+  reader.object([&](const std::string &key) {
+    return key == "timeout_ms" ? reader.number(timeoutMs) : reader.skip();
+  });
+  if (timeoutMs > 0) {
+    const std::chrono::duration<double, std::milli> timeout(timeoutMs);
+    request.deadline =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+  }
+  return request;
+}
+
+void CactusCancellation::stop(uint64_t ticket) {
+  uint64_t stopped = this->_stoppedThrough.load();
+  while (stopped < ticket &&
+         !this->_stoppedThrough.compare_exchange_weak(stopped, ticket)) {
+  }
+
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (this->_running && this->_runningTicket <= ticket) {
+    cactus_stop(this->_running);
+  }
+}
+
+void CactusCancellation::begin(const Request &request, cactus_model_t model) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_running = model;
+  this->_runningTicket = request.ticket;
+}
+
+void CactusCancellation::end() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_running = nullptr;
+}
+
+} // namespace margelo::nitro::cactus
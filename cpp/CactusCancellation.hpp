@@ -0,0 +1,57 @@
+#pragma once
+
+#include "cactus_ffi.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Stops the generations of a model when asked to or when they run past their
+// deadline. The engine only checks for a stop between tokens, so a stop that
+// arrives during prefill is checked again on the first token, and requests
+// still waiting for the model when it arrives never start.
+class CactusCancellation {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    uint64_t ticket;
+    std::optional<Clock::time_point> deadline;
+  };
+
+  // Called when the request is made, so a stop covers it while queued. The
+  // timeout is the timeout_ms of the options passed to the engine.
+  Request issue(const std::optional<std::string> &optionsJson);
+
+  // Stops every request up to the ticket
+  void stop(uint64_t ticket);
+
+  uint64_t lastTicket() const { return _issued.load(); }
+
+  bool stopped(const Request &request) const {
+    return request.ticket <= _stoppedThrough.load(std::memory_order_relaxed);
+  }
+  bool expired(const Request &request) const {
+    return request.deadline && Clock::now() >= *request.deadline;
+  }
+
+  // Brackets the engine call that a stop interrupts
+  void begin(const Request &request, cactus_model_t model);
+  void end();
+
+private:
+  std::atomic<uint64_t> _issued{0};
+  std::atomic<uint64_t> _stoppedThrough{0};
+
+  // Held while stopping, so the model cannot be released under cactus_stop
+  std::mutex _mutex;
+  cactus_model_t _running = nullptr;
+  uint64_t _runningTicket = 0;
+};
+
+} // namespace margelo::nitro::cactus
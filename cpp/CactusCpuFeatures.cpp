@@ -0,0 +1,51 @@
+#include "CactusCpuFeatures.hpp"
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+#ifdef __APPLE__
+
+bool hasFeature(const char *name) {
+  int value = 0;
+  size_t size = sizeof(value);
+  return sysctlbyname(name, &value, &size, nullptr, 0) == 0 && value != 0;
+}
+
+CactusCpuFeatures detect() {
+  CactusCpuFeatures features;
+  features.dotprod = hasFeature("hw.optional.arm.FEAT_DotProd");
+  return features;
+}
+
+#elif defined(__aarch64__) && defined(__linux__)
+
+// HWCAP_ASIMDDP from asm/hwcap.h, which older NDKs ship without
+constexpr unsigned long kHwcapAsimdDp = 1 << 20;
+
+CactusCpuFeatures detect() {
+  CactusCpuFeatures features;
+  features.dotprod = getauxval(AT_HWCAP) & kHwcapAsimdDp;
+  return features;
+}
+
+#else
+
+CactusCpuFeatures detect() { return {}; }
+
+#endif
+
+} // namespace
+
+const CactusCpuFeatures &CactusCpuFeatures::current() {
+  static const CactusCpuFeatures features = detect();
+  return features;
+}
+
+} // namespace margelo::nitro::cactus
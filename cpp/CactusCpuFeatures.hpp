@@ -0,0 +1,13 @@
+#pragma once
+
+namespace margelo::nitro::cactus {
+
+// Arm extensions of the cores the app runs on, detected once at runtime so
+// that one build can use kernels for newer cores and still run on older ones
+struct CactusCpuFeatures {
+  bool dotprod = false;
+
+  static const CactusCpuFeatures &current();
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,71 @@
+#include "CactusDeviceMemory.hpp"
+
+#ifdef __APPLE__
+#include <TargetConditionals.h>
+#endif
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+#if defined(__APPLE__) && TARGET_OS_IPHONE
+#include <os/proc.h>
+#else
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#endif
+
+namespace margelo::nitro::cactus {
+
+size_t availableMemoryBytes() {
+#if defined(__APPLE__) && TARGET_OS_IPHONE
+  // Accounts for the per-app limit, which is far below the physical memory
+  return os_proc_available_memory();
+#else
+  // Counts reclaimable page cache, unlike the free pages
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  size_t kilobytes = 0;
+  std::string unit;
+  while (meminfo >> key >> kilobytes >> unit) {
+    if (key == "MemAvailable:") {
+      return kilobytes * 1024;
+    }
+  }
+
+  const long pages = sysconf(_SC_AVPHYS_PAGES);
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  if (pages <= 0 || pageSize <= 0) {
+    return 0;
+  }
+  return static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+#endif
+}
+
+size_t privateMemoryBytes() {
+#ifdef __APPLE__
+  // The footprint the system holds against the app's memory limit
+  task_vm_info_data_t info;
+  mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+  if (task_info(mach_task_self(), TASK_VM_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return 0;
+  }
+  return info.phys_footprint;
+#else
+  // Resident pages that are not backed by a file
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0;
+  size_t resident = 0;
+  size_t shared = 0;
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  if (!(statm >> size >> resident >> shared) || pageSize <= 0 ||
+      resident < shared) {
+    return 0;
+  }
+  return (resident - shared) * static_cast<size_t>(pageSize);
+#endif
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+namespace margelo::nitro::cactus {
+
+// Memory the process can still allocate before the system reclaims it, or 0
+// when it cannot be determined
+size_t availableMemoryBytes();
+
+// Memory the process has written to, which leaves out clean file pages such
+// as mapped weights, or 0 when it cannot be determined
+size_t privateMemoryBytes();
+
+} // namespace margelo::nitro::cactus
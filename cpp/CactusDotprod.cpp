@@ -0,0 +1,28 @@
+#include "CactusDotprod.hpp"
+
+#ifdef CACTUS_DOTPROD_DISPATCH
+
+#ifndef __ARM_FEATURE_DOTPROD
+#error "CactusDotprod.cpp has to be built with the dotprod extension"
+#endif
+
+#include <arm_neon.h>
+
+namespace margelo::nitro::cactus {
+
+int32_t dotInt8Dotprod(const int8_t *a, const int8_t *b, size_t n) {
+  size_t i = 0;
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 16 <= n; i += 16) {
+    acc = vdotq_s32(acc, vld1q_s8(a + i), vld1q_s8(b + i));
+  }
+  int32_t sum = vaddvq_s32(acc);
+  for (; i < n; ++i) {
+    sum += static_cast<int32_t>(a[i]) * b[i];
+  }
+  return sum;
+}
+
+} // namespace margelo::nitro::cactus
+
+#endif
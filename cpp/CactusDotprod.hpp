@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace margelo::nitro::cactus {
+
+// Built with the dot product extension when CACTUS_DOTPROD_DISPATCH is set,
+// and only called once CactusCpuFeatures reports it
+int32_t dotInt8Dotprod(const int8_t *a, const int8_t *b, size_t n);
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,315 @@
+#include "CactusEmbeddingCache.hpp"
+#include "CactusMetrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+constexpr char kMagic[4] = {'C', 'E', 'M', 'B'};
+constexpr uint32_t kVersion = 2;
+// The magic, the version and the identity of the model files
+constexpr size_t kHeaderSize = 16;
+constexpr size_t kMinMapSize = 1 << 20;
+
+// Each record is the text hash, the text length and the dimension followed by
+// the text and the floats. The text is compared on every hit, so a hash
+// collision is a miss rather than another text's embedding.
+constexpr size_t kRecordHeaderSize = 16;
+
+uint64_t hashBytes(const void *data, size_t size,
+                   uint64_t hash = 14695981039346656037ull) {
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+uint64_t hashText(const std::string &text) {
+  return hashBytes(text.data(), text.size());
+}
+
+// Changes whenever a model file is added, removed, resized or rewritten, as a
+// new download of the model does
+uint64_t modelIdentity(const std::string &modelPath) {
+  std::vector<std::filesystem::path> paths;
+  std::error_code error;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(modelPath, error)) {
+    if (entry.is_regular_file(error)) {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+
+  uint64_t hash = hashText(modelPath);
+  for (const auto &path : paths) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+      continue;
+    }
+    const std::string name = path.string();
+    const int64_t size = info.st_size;
+    const int64_t modified = info.st_mtime;
+    hash = hashBytes(name.data(), name.size(), hash);
+    hash = hashBytes(&size, sizeof(size), hash);
+    hash = hashBytes(&modified, sizeof(modified), hash);
+  }
+  return hash;
+}
+
+void writeHeader(uint8_t *header, uint64_t modelIdentity) {
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  std::memcpy(header + sizeof(kMagic), &kVersion, sizeof(kVersion));
+  std::memcpy(header + 8, &modelIdentity, sizeof(modelIdentity));
+}
+
+template <typename T> T readAt(const uint8_t *data, size_t offset) {
+  T value;
+  std::memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+bool writeAll(int fd, const uint8_t *data, size_t size, off_t offset) {
+  while (size > 0) {
+    const ssize_t written = pwrite(fd, data, size, offset);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+} // namespace
+
+std::shared_ptr<CactusEmbeddingCache>
+CactusEmbeddingCache::open(const std::string &directory,
+                           const std::string &modelPath, size_t maxBytes) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<CactusEmbeddingCache>>
+      caches;
+
+  const uint64_t identity = modelIdentity(modelPath);
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.cache",
+                static_cast<unsigned long long>(identity));
+  const std::string path = (std::filesystem::path(directory) / name).string();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto cache = caches[path].lock();
+  if (cache) {
+    return cache;
+  }
+  cache.reset(new CactusEmbeddingCache(path, identity, maxBytes));
+  caches[path] = cache;
+
+  // Another version of the model files may still be in use by another
+  // instance, which keeps its file
+  std::error_code error;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(directory, error)) {
+    const std::string stale = entry.path().string();
+    if (entry.path().extension() == ".cache" && stale != path &&
+        !caches[stale].lock()) {
+      caches.erase(stale);
+      std::filesystem::remove(entry.path(), error);
+    }
+  }
+  return cache;
+}
+
+CactusEmbeddingCache::CactusEmbeddingCache(const std::string &path,
+                                           uint64_t modelIdentity,
+                                           size_t maxBytes)
+    : _modelIdentity(modelIdentity), _maxBytes(maxBytes) {
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path());
+
+  this->_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (this->_fd < 0) {
+    throw std::runtime_error("Failed to open embedding cache " + path);
+  }
+
+  struct stat info;
+  fstat(this->_fd, &info);
+  this->_fileSize = info.st_size;
+
+  uint8_t header[kHeaderSize];
+  writeHeader(header, modelIdentity);
+
+  bool valid = this->_fileSize >= kHeaderSize;
+  if (valid) {
+    uint8_t existing[kHeaderSize];
+    valid = pread(this->_fd, existing, kHeaderSize, 0) ==
+                static_cast<ssize_t>(kHeaderSize) &&
+            std::memcmp(existing, header, kHeaderSize) == 0;
+  }
+  // Written by another version, for other model files, or never finished
+  // being created
+  try {
+    if (!valid) {
+      this->reset(modelIdentity);
+    }
+    this->remap();
+  } catch (...) {
+    ::close(this->_fd);
+    throw;
+  }
+
+  size_t offset = kHeaderSize;
+  while (offset + kRecordHeaderSize <= this->_fileSize) {
+    const uint32_t length = readAt<uint32_t>(this->_map, offset + 8);
+    const uint32_t dimension = readAt<uint32_t>(this->_map, offset + 12);
+    const size_t end = offset + kRecordHeaderSize + length +
+                       static_cast<size_t>(dimension) * sizeof(float);
+    if (end > this->_fileSize) {
+      break;
+    }
+    this->_offsets[readAt<uint64_t>(this->_map, offset)] = offset;
+    offset = end;
+  }
+
+  // A record cut short by the app being killed mid-append is dropped
+  if (offset != this->_fileSize && ftruncate(this->_fd, offset) == 0) {
+    this->_fileSize = offset;
+  }
+}
+
+CactusEmbeddingCache::~CactusEmbeddingCache() {
+  if (this->_map) {
+    munmap(this->_map, this->_mapSize);
+  }
+  ::close(this->_fd);
+}
+
+bool CactusEmbeddingCache::find(const std::string &text,
+                                std::vector<float> &embedding) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  static auto &hits = CactusMetrics::shared().counter("embedding_cache_hits");
+  static auto &misses =
+      CactusMetrics::shared().counter("embedding_cache_misses");
+
+  const auto it = this->_offsets.find(hashText(text));
+  const uint8_t *const stored =
+      it == this->_offsets.end()
+          ? nullptr
+          : this->_map + it->second + kRecordHeaderSize;
+  if (!stored || readAt<uint32_t>(this->_map, it->second + 8) != text.size() ||
+      std::memcmp(stored, text.data(), text.size()) != 0) {
+    misses.add();
+    return false;
+  }
+  hits.add();
+
+  const uint32_t dimension = readAt<uint32_t>(this->_map, it->second + 12);
+  embedding.resize(dimension);
+  std::memcpy(embedding.data(), stored + text.size(),
+              dimension * sizeof(float));
+  return true;
+}
+
+void CactusEmbeddingCache::insert(const std::string &text,
+                                  const float *embedding, size_t dimension) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  const uint64_t hash = hashText(text);
+  const size_t recordSize =
+      kRecordHeaderSize + text.size() + dimension * sizeof(float);
+  if (this->_offsets.count(hash) ||
+      kHeaderSize + recordSize > this->_maxBytes) {
+    return;
+  }
+
+  try {
+    if (this->_fileSize + recordSize > this->_maxBytes) {
+      this->reset(this->_modelIdentity);
+    }
+    this->append(hash, text, embedding, dimension);
+  } catch (...) {
+    // Caching is an optimization, the embedding is returned either way
+  }
+}
+
+void CactusEmbeddingCache::append(uint64_t hash, const std::string &text,
+                                  const float *embedding, size_t dimension) {
+  std::vector<uint8_t> record(kRecordHeaderSize + text.size() +
+                              dimension * sizeof(float));
+  const uint32_t length = text.size();
+  const uint32_t dim = dimension;
+  std::memcpy(record.data(), &hash, sizeof(hash));
+  std::memcpy(record.data() + 8, &length, sizeof(length));
+  std::memcpy(record.data() + 12, &dim, sizeof(dim));
+  std::memcpy(record.data() + kRecordHeaderSize, text.data(), text.size());
+  std::memcpy(record.data() + kRecordHeaderSize + text.size(), embedding,
+              dimension * sizeof(float));
+
+  const size_t offset = this->_fileSize;
+  if (!writeAll(this->_fd, record.data(), record.size(), offset)) {
+    // Leaves no partial record behind for the next append to follow
+    ftruncate(this->_fd, offset);
+    return;
+  }
+
+  this->_fileSize += record.size();
+  try {
+    this->remap();
+  } catch (...) {
+    ftruncate(this->_fd, offset);
+    this->_fileSize = offset;
+    throw;
+  }
+  this->_offsets[hash] = offset;
+}
+
+void CactusEmbeddingCache::reset(uint64_t modelIdentity) {
+  // Nothing is read from the file again until records are appended to it
+  this->_offsets.clear();
+  this->_modelIdentity = modelIdentity;
+
+  uint8_t header[kHeaderSize];
+  writeHeader(header, modelIdentity);
+
+  if (ftruncate(this->_fd, 0) != 0 ||
+      !writeAll(this->_fd, header, kHeaderSize, 0)) {
+    throw std::runtime_error("Failed to create embedding cache");
+  }
+  this->_fileSize = kHeaderSize;
+}
+
+void CactusEmbeddingCache::remap() {
+  // Mapped with room to grow, so appends rarely need a new mapping. Only the
+  // part backed by the file is ever read.
+  if (this->_map && this->_fileSize <= this->_mapSize) {
+    return;
+  }
+
+  // The old mapping stays valid until the new one exists, so a failure
+  // leaves the records mapped so far readable
+  const size_t mapSize = std::max(this->_fileSize * 2, kMinMapSize);
+  void *map = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, this->_fd, 0);
+  if (map == MAP_FAILED) {
+    throw std::runtime_error("Failed to map embedding cache");
+  }
+  if (this->_map) {
+    munmap(this->_map, this->_mapSize);
+  }
+  this->_map = static_cast<uint8_t *>(map);
+  this->_mapSize = mapSize;
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Text embeddings persisted in an append-only file, one file per version of
+// the model files. The file is memory-mapped for lookups and indexed by a
+// hash of the text when opened, so a hit costs a hash, a map lookup, a
+// compare of the stored text and a copy.
+class CactusEmbeddingCache {
+public:
+  static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+  // The file in directory is named after the model files, so instances
+  // opened for the same files share it and appends never interleave. Files
+  // left by earlier versions of the model are deleted. Once the file would
+  // grow past maxBytes it is emptied and filled again.
+  static std::shared_ptr<CactusEmbeddingCache>
+  open(const std::string &directory, const std::string &modelPath,
+       size_t maxBytes = kDefaultMaxBytes);
+
+  ~CactusEmbeddingCache();
+
+  CactusEmbeddingCache(const CactusEmbeddingCache &) = delete;
+  CactusEmbeddingCache &operator=(const CactusEmbeddingCache &) = delete;
+
+  bool find(const std::string &text, std::vector<float> &embedding);
+
+  // Best effort and never throws: a failed write leaves the file as it was
+  void insert(const std::string &text, const float *embedding,
+              size_t dimension);
+
+private:
+  CactusEmbeddingCache(const std::string &path, uint64_t modelIdentity,
+                       size_t maxBytes);
+
+  std::mutex _mutex;
+  int _fd = -1;
+  uint8_t *_map = nullptr;
+  size_t _mapSize = 0;
+  size_t _fileSize = 0;
+  // Text hash to the offset of its record
+  std::unordered_map<uint64_t, size_t> _offsets;
+  uint64_t _modelIdentity;
+  size_t _maxBytes;
+
+  void append(uint64_t hash, const std::string &text, const float *embedding,
+              size_t dimension);
+  void reset(uint64_t modelIdentity);
+  void remap();
+};
+
+} // namespace margelo::nitro::cactus
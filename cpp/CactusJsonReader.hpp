@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Just enough JSON to read the tools and options passed to the engine, which
+// only need a few fields picked out of them
+class CactusJsonReader {
+public:
+  explicit CactusJsonReader(const std::string &json) : _json(json) {}
+
+  bool string(std::string &out) {
+    this->whitespace();
+    if (!this->consume('"')) {
+      return false;
+    }
+    out.clear();
+    while (this->_pos < this->_json.size()) {
+      const char c = this->_json[this->_pos++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        out += c;
+      } else if (!this->escape(out)) {
+        return false;
+      }
+    }
+    return false;
+  }
+
+  // The next character that is not whitespace, or 0 at the end
+  char peek() {
+    this->whitespace();
+    return this->_pos < this->_json.size() ? this->_json[this->_pos] : 0;
+  }
+
+  bool number(double &out) {
+    this->whitespace();
+    const char *start = this->_json.c_str() + this->_pos;
+    char *end;
+    out = std::strtod(start, &end);
+    this->_pos += end - start;
+    return end != start;
+  }
+
+  bool skip() {
+    this->whitespace();
+    if (this->_pos >= this->_json.size()) {
+      return false;
+    }
+    std::string ignored;
+    switch (this->_json[this->_pos]) {
+    case '"':
+      return this->string(ignored);
+    case '{':
+      return this->object([this](const std::string &) { return this->skip(); });
+    case '[':
+      return this->array([this]() { return this->skip(); });
+    default:
+      while (this->_pos < this->_json.size() &&
+             std::string(",]} \t\r\n").find(this->_json[this->_pos]) ==
+                 std::string::npos) {
+        this->_pos++;
+      }
+      return true;
+    }
+  }
+
+  // visit is called with every key and has to read its value
+  template <typename Visit> bool object(Visit visit) {
+    this->whitespace();
+    if (!this->consume('{')) {
+      return false;
+    }
+    this->whitespace();
+    if (this->consume('}')) {
+      return true;
+    }
+    std::string key;
+    do {
+      if (!this->string(key)) {
+        return false;
+      }
+      this->whitespace();
+      if (!this->consume(':') || !visit(key)) {
+        return false;
+      }
+      this->whitespace();
+    } while (this->consume(','));
+    return this->consume('}');
+  }
+
+  template <typename Visit> bool array(Visit visit) {
+    this->whitespace();
+    if (!this->consume('[')) {
+      return false;
+    }
+    this->whitespace();
+    if (this->consume(']')) {
+      return true;
+    }
+    do {
+      if (!visit()) {
+        return false;
+      }
+      this->whitespace();
+    } while (this->consume(','));
+    return this->consume(']');
+  }
+
+private:
+  const std::string &_json;
+  size_t _pos = 0;
+
+  void whitespace() {
+    while (this->_pos < this->_json.size() &&
+           std::isspace(static_cast<unsigned char>(this->_json[this->_pos]))) {
+      this->_pos++;
+    }
+  }
+
+  bool consume(char c) {
+    if (this->_pos < this->_json.size() && this->_json[this->_pos] == c) {
+      this->_pos++;
+      return true;
+    }
+    return false;
+  }
+
+  bool escape(std::string &out) {
+    if (this->_pos >= this->_json.size()) {
+      return false;
+    }
+    const char c = this->_json[this->_pos++];
+    switch (c) {
+    case 'b':
+      out += '\b';
+      return true;
+    case 'f':
+      out += '\f';
+      return true;
+    case 'n':
+      out += '\n';
+      return true;
+    case 'r':
+      out += '\r';
+      return true;
+    case 't':
+      out += '\t';
+      return true;
+    case 'u':
+      break;
+    default:
+      out += c;
+      return true;
+    }
+
+    uint32_t code;
+    if (!this->hex(code)) {
+      return false;
+    }
+    // Characters outside the basic plane come as a surrogate pair
+    if (code >= 0xD800 && code < 0xDC00 &&
+        this->_json.compare(this->_pos, 2, "\\u") == 0) {
+      this->_pos += 2;
+      uint32_t low;
+      if (!this->hex(low)) {
+        return false;
+      }
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    }
+    utf8(code, out);
+    return true;
+  }
+
+  bool hex(uint32_t &code) {
+    if (this->_pos + 4 > this->_json.size()) {
+      return false;
+    }
+    const std::string digits = this->_json.substr(this->_pos, 4);
+    char *end;
+    code = std::strtoul(digits.c_str(), &end, 16);
+    this->_pos += 4;
+    return end == digits.c_str() + 4;
+  }
+
+  static void utf8(uint32_t code, std::string &out) {
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xC0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xE0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+  }
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,342 @@
+#include "CactusKernelBenchmark.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__ANDROID__) && defined(__aarch64__)
+#include "cactus_kernel.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#endif
+
+namespace margelo::nitro::cactus {
+
+#if defined(__ANDROID__) && defined(__aarch64__)
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ModelShape {
+  const char *family;
+  size_t hidden;
+  size_t intermediate;
+  size_t queryHeads;
+  size_t kvHeads;
+  size_t headDim;
+  size_t vocab;
+};
+
+constexpr ModelShape kModelShapes[] = {
+    {"qwen3-0.6b", 1024, 3072, 16, 8, 128, 151936},
+    {"gemma3-270m", 640, 2048, 4, 1, 256, 262144},
+    {"whisper-small", 768, 3072, 12, 12, 64, 51865},
+};
+
+// A decode step and a prefill chunk
+constexpr size_t kTokenCounts[] = {1, 128};
+constexpr size_t kKvLength = 1024;
+
+// Rows of a prefill compared with the reference, which is too slow to run on
+// every row
+constexpr size_t kCheckedRows = 8;
+
+struct Run {
+  std::string kernel;
+  std::string family;
+  std::string shape;
+  double ms;
+  double flops;
+  double bytes;
+  double maxError;
+};
+
+template <typename Kernel> double medianMs(size_t iterations, Kernel kernel) {
+  kernel();
+  std::vector<double> samples;
+  for (size_t i = 0; i < iterations; i++) {
+    const auto start = Clock::now();
+    kernel();
+    samples.push_back(
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count());
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+std::vector<float> randomFloats(size_t count, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  std::vector<float> values(count);
+  for (auto &value : values) {
+    value = distribution(rng);
+  }
+  return values;
+}
+
+std::vector<int8_t> randomInt8(size_t count, std::mt19937 &rng) {
+  std::uniform_int_distribution<int> distribution(-127, 127);
+  std::vector<int8_t> values(count);
+  for (auto &value : values) {
+    value = static_cast<int8_t>(distribution(rng));
+  }
+  return values;
+}
+
+// Rounds through half precision, so that the reference sees the same
+// inputs as the kernel
+std::vector<__fp16> toHalf(std::vector<float> &values) {
+  std::vector<__fp16> half(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    half[i] = static_cast<__fp16>(values[i]);
+    values[i] = half[i];
+  }
+  return half;
+}
+
+class ErrorTracker {
+public:
+  void add(double actual, double expected) {
+    _error = std::max(_error, std::fabs(actual - expected));
+    _scale = std::max(_scale, std::fabs(expected));
+  }
+
+  double relative() const { return _scale > 0 ? _error / _scale : _error; }
+
+private:
+  double _error = 0;
+  double _scale = 0;
+};
+
+std::string shapeName(std::initializer_list<size_t> dims) {
+  std::string name;
+  for (const size_t dim : dims) {
+    name += (name.empty() ? "" : "x") + std::to_string(dim);
+  }
+  return name;
+}
+
+Run matmulInt8(const ModelShape &model, size_t m, size_t iterations,
+               std::mt19937 &rng) {
+  const size_t k = model.hidden;
+  const size_t n = model.intermediate;
+  const auto a = randomInt8(m * k, rng);
+  const auto b = randomInt8(n * k, rng);
+  std::vector<int32_t> c(m * n);
+
+  const double ms = medianMs(iterations, [&]() {
+    cactus_matmul_int8_to_int32(a.data(), b.data(), c.data(), m, k, n);
+  });
+
+  ErrorTracker error;
+  for (size_t row = 0; row < m; row += std::max<size_t>(m / kCheckedRows, 1)) {
+    for (size_t col = 0; col < n; col++) {
+      int64_t expected = 0;
+      for (size_t i = 0; i < k; i++) {
+        expected += a[row * k + i] * b[col * k + i];
+      }
+      error.add(c[row * n + col], expected);
+    }
+  }
+
+  return {"matmul_int8_to_int32", model.family, shapeName({m, k, n}), ms,
+          2.0 * m * n * k, double(m * k + n * k + 4 * m * n),
+          error.relative()};
+}
+
+Run matmulF16(const ModelShape &model, size_t m, size_t iterations,
+              std::mt19937 &rng) {
+  const size_t k = model.hidden;
+  const size_t n = model.intermediate;
+  auto aFloat = randomFloats(m * k, rng);
+  auto bFloat = randomFloats(n * k, rng);
+  const auto a = toHalf(aFloat);
+  const auto b = toHalf(bFloat);
+  std::vector<__fp16> c(m * n);
+
+  const double ms = medianMs(iterations, [&]() {
+    cactus_matmul_f16(a.data(), b.data(), c.data(), m, k, n);
+  });
+
+  ErrorTracker error;
+  for (size_t row = 0; row < m; row += std::max<size_t>(m / kCheckedRows, 1)) {
+    for (size_t col = 0; col < n; col++) {
+      double expected = 0;
+      for (size_t i = 0; i < k; i++) {
+        expected += aFloat[row * k + i] * bFloat[col * k + i];
+      }
+      error.add(c[row * n + col], expected);
+    }
+  }
+
+  return {"matmul_f16", model.family, shapeName({m, k, n}), ms,
+          2.0 * m * n * k, 2.0 * (m * k + n * k + m * n), error.relative()};
+}
+
+// Queries, keys and values are laid out as [tokens, heads, head_dim]
+Run attentionF16(const ModelShape &model, size_t tokens, size_t iterations,
+                 std::mt19937 &rng) {
+  const size_t dim = model.headDim;
+  const size_t queryHeads = model.queryHeads;
+  const size_t kvHeads = model.kvHeads;
+  auto qFloat = randomFloats(tokens * queryHeads * dim, rng);
+  auto kFloat = randomFloats(kKvLength * kvHeads * dim, rng);
+  auto vFloat = randomFloats(kKvLength * kvHeads * dim, rng);
+  const auto q = toHalf(qFloat);
+  const auto k = toHalf(kFloat);
+  const auto v = toHalf(vFloat);
+  std::vector<__fp16> out(tokens * queryHeads * dim);
+  const float scale = 1 / std::sqrt(static_cast<float>(dim));
+
+  // Every query attends to the whole window, which keeps the reference free
+  // of the kernel's conventions for causal masks
+  const double ms = medianMs(iterations, [&]() {
+    cactus_attention_f16(q.data(), k.data(), v.data(), out.data(), 1, tokens,
+                         kKvLength, queryHeads, kvHeads, dim, scale, nullptr,
+                         0, 0, false);
+  });
+
+  ErrorTracker error;
+  std::vector<double> weights(kKvLength);
+  for (size_t t = 0; t < tokens;
+       t += std::max<size_t>(tokens / kCheckedRows, 1)) {
+    for (size_t h = 0; h < queryHeads; h++) {
+      const size_t kvHead = h / (queryHeads / kvHeads);
+      const float *query = &qFloat[(t * queryHeads + h) * dim];
+      double maxWeight = -INFINITY;
+      for (size_t j = 0; j < kKvLength; j++) {
+        const float *key = &kFloat[(j * kvHeads + kvHead) * dim];
+        double dot = 0;
+        for (size_t i = 0; i < dim; i++) {
+          dot += query[i] * key[i];
+        }
+        weights[j] = dot * scale;
+        maxWeight = std::max(maxWeight, weights[j]);
+      }
+      double sum = 0;
+      for (auto &weight : weights) {
+        weight = std::exp(weight - maxWeight);
+        sum += weight;
+      }
+      for (size_t i = 0; i < dim; i++) {
+        double expected = 0;
+        for (size_t j = 0; j < kKvLength; j++) {
+          expected += weights[j] * vFloat[(j * kvHeads + kvHead) * dim + i];
+        }
+        error.add(out[(t * queryHeads + h) * dim + i], expected / sum);
+      }
+    }
+  }
+
+  return {"attention_f16",
+          model.family,
+          shapeName({tokens, kKvLength, queryHeads, kvHeads, dim}),
+          ms,
+          4.0 * tokens * kKvLength * queryHeads * dim,
+          2.0 * (2 * tokens * queryHeads + 2 * kKvLength * kvHeads) * dim,
+          error.relative()};
+}
+
+Run rmsNormF16(const ModelShape &model, size_t tokens, size_t iterations,
+               std::mt19937 &rng) {
+  const size_t dims = model.hidden;
+  constexpr float eps = 1e-6f;
+  auto inputFloat = randomFloats(tokens * dims, rng);
+  auto weightFloat = randomFloats(dims, rng);
+  const auto input = toHalf(inputFloat);
+  const auto weight = toHalf(weightFloat);
+  std::vector<__fp16> output(tokens * dims);
+
+  const double ms = medianMs(iterations, [&]() {
+    cactus_rms_norm_f16(input.data(), weight.data(), output.data(), tokens,
+                        dims, eps);
+  });
+
+  ErrorTracker error;
+  for (size_t t = 0; t < tokens; t++) {
+    double squares = 0;
+    for (size_t i = 0; i < dims; i++) {
+      squares += inputFloat[t * dims + i] * inputFloat[t * dims + i];
+    }
+    const double norm = 1 / std::sqrt(squares / dims + eps);
+    for (size_t i = 0; i < dims; i++) {
+      error.add(output[t * dims + i],
+                inputFloat[t * dims + i] * norm * weightFloat[i]);
+    }
+  }
+
+  return {"rms_norm_f16", model.family, shapeName({tokens, dims}), ms,
+          4.0 * tokens * dims, 2.0 * (2 * tokens * dims + dims),
+          error.relative()};
+}
+
+// Over the logits of the sampled token
+Run softmaxF32(const ModelShape &model, size_t iterations, std::mt19937 &rng) {
+  const size_t vocab = model.vocab;
+  const auto input = randomFloats(vocab, rng);
+  std::vector<float> output(vocab);
+
+  const double ms = medianMs(iterations, [&]() {
+    cactus_softmax_f32(input.data(), output.data(), 1, 1, vocab);
+  });
+
+  ErrorTracker error;
+  const double maxLogit = *std::max_element(input.begin(), input.end());
+  double sum = 0;
+  for (const float logit : input) {
+    sum += std::exp(logit - maxLogit);
+  }
+  for (size_t i = 0; i < vocab; i++) {
+    error.add(output[i], std::exp(input[i] - maxLogit) / sum);
+  }
+
+  return {"softmax_f32", model.family, shapeName({vocab}), ms, 3.0 * vocab,
+          8.0 * vocab, error.relative()};
+}
+
+std::string runJson(const Run &run) {
+  const double seconds = run.ms / 1000;
+  return "{\"kernel\":\"" + run.kernel + "\",\"family\":\"" + run.family +
+         "\",\"shape\":\"" + run.shape +
+         "\",\"ms\":" + std::to_string(run.ms) +
+         ",\"gflops\":" + std::to_string(run.flops / seconds / 1e9) +
+         ",\"gb_per_second\":" + std::to_string(run.bytes / seconds / 1e9) +
+         ",\"max_error\":" + std::to_string(run.maxError) + "}";
+}
+
+} // namespace
+
+#endif
+
+CactusKernelBenchmark::CactusKernelBenchmark(size_t iterations)
+    : _iterations(std::max<size_t>(iterations, 1)) {}
+
+std::string CactusKernelBenchmark::run() {
+#if defined(__ANDROID__) && defined(__aarch64__)
+  std::mt19937 rng(42);
+  std::vector<Run> runs;
+  for (const auto &model : kModelShapes) {
+    for (const size_t tokens : kTokenCounts) {
+      runs.push_back(matmulInt8(model, tokens, this->_iterations, rng));
+      runs.push_back(matmulF16(model, tokens, this->_iterations, rng));
+      runs.push_back(attentionF16(model, tokens, this->_iterations, rng));
+      runs.push_back(rmsNormF16(model, tokens, this->_iterations, rng));
+    }
+    runs.push_back(softmaxF32(model, this->_iterations, rng));
+  }
+
+  std::string json = "[";
+  for (size_t i = 0; i < runs.size(); i++) {
+    json += (i ? "," : "") + runJson(runs[i]);
+  }
+  return json + "]";
+#else
+  throw std::runtime_error(
+      "Cactus kernel benchmarks are only available on Android arm64");
+#endif
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Times the engine's matmul, attention, norm and softmax kernels on the layer
+// shapes of the supported model families, and checks their output against
+// plain reference implementations. Reports throughput and the largest error
+// relative to the reference output as JSON.
+class CactusKernelBenchmark {
+public:
+  explicit CactusKernelBenchmark(size_t iterations);
+
+  // Throws where the kernels are not linked into the app
+  std::string run();
+
+private:
+  size_t _iterations;
+};
+
+} // namespace margelo::nitro::cactus
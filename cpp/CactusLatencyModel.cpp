@@ -0,0 +1,159 @@
+#include "CactusLatencyModel.hpp"
+#include "CactusJsonReader.hpp"
+#include "CactusResponseJson.hpp"
+#include "CactusThermalState.hpp"
+
+#include <cmath>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+// Roughly what the engine spends per image at the input size of the wrapper
+constexpr size_t kTokensPerImage = 64;
+// Role markers and separators of the chat template
+constexpr size_t kTokensPerMessage = 4;
+constexpr size_t kBytesPerToken = 4;
+
+} // namespace
+
+void CactusLatencyModel::learn(double &msPerToken, double sample) {
+  if (!std::isfinite(sample) || sample <= 0) {
+    return;
+  }
+  msPerToken = msPerToken > 0
+                   ? msPerToken + kSmoothing * (sample - msPerToken)
+                   : sample;
+}
+
+void CactusLatencyModel::calibrate(const std::string &benchmarkJson) {
+  double prefillTokens = 0;
+  double prefillMs = 0;
+  double decodeTokens = 0;
+  double tokensPerSecond = 0;
+
+  // Takes the longest runs, which are the least skewed by fixed costs
+  CactusJsonReader reader(benchmarkJson);
+  reader.object([&](const std::string &key) {
+    if (key != "prefill" && key != "decode") {
+      return reader.skip();
+    }
+    const bool prefill = key == "prefill";
+    return reader.array([&]() {
+      double tokens = 0;
+      double value = 0;
+      const bool ok = reader.object([&](const std::string &field) {
+        if (field == (prefill ? "prefill_tokens" : "decode_tokens")) {
+          return reader.number(tokens);
+        }
+        if (!prefill && field == "tokens_per_second") {
+          return reader.number(value);
+        }
+        if (prefill && field == "time_to_first_token_ms") {
+          return reader.object([&](const std::string &percentile) {
+            return percentile == "p50" ? reader.number(value) : reader.skip();
+          });
+        }
+        return reader.skip();
+      });
+      if (ok && prefill && tokens > prefillTokens) {
+        prefillTokens = tokens;
+        prefillMs = value;
+      } else if (ok && !prefill && tokens > decodeTokens) {
+        decodeTokens = tokens;
+        tokensPerSecond = value;
+      }
+      return ok;
+    });
+  });
+
+  const double fraction = thermalSpeedFraction(currentThermalState());
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (prefillTokens >= kMinPrefillTokens && prefillMs > 0) {
+    this->_prefillMsPerToken = prefillMs / prefillTokens * fraction;
+  }
+  if (tokensPerSecond > 0) {
+    this->_decodeMsPerToken = 1000 / tokensPerSecond * fraction;
+  }
+}
+
+void CactusLatencyModel::observe(const std::string &responseJson) {
+  const double prefillTokens = responseNumber(responseJson, "prefill_tokens");
+  const double timeToFirstTokenMs =
+      responseNumber(responseJson, "time_to_first_token_ms");
+  const double decodeTokens = responseNumber(responseJson, "decode_tokens");
+  const double tokensPerSecond =
+      responseNumber(responseJson, "tokens_per_second");
+
+  const double fraction = thermalSpeedFraction(currentThermalState());
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (prefillTokens >= kMinPrefillTokens) {
+    learn(this->_prefillMsPerToken,
+          timeToFirstTokenMs / prefillTokens * fraction);
+  }
+  if (decodeTokens > 1 && tokensPerSecond > 0) {
+    learn(this->_decodeMsPerToken, 1000 / tokensPerSecond * fraction);
+  }
+}
+
+std::string CactusLatencyModel::predict(const std::string &messagesJson,
+                                        size_t maxTokens) const {
+  const size_t promptTokens = estimatePromptTokens(messagesJson);
+  const CactusThermalState state = currentThermalState();
+  const double fraction = thermalSpeedFraction(state);
+
+  double prefillMsPerToken;
+  double decodeMsPerToken;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    prefillMsPerToken = this->_prefillMsPerToken;
+    decodeMsPerToken = this->_decodeMsPerToken;
+  }
+
+  const double prefillMs = promptTokens * prefillMsPerToken / fraction;
+  const double decodeMs = maxTokens * decodeMsPerToken / fraction;
+  const bool calibrated = prefillMsPerToken > 0 && decodeMsPerToken > 0;
+
+  return "{\"prompt_tokens\":" + std::to_string(promptTokens) +
+         ",\"prefill_ms\":" + std::to_string(prefillMs) +
+         ",\"decode_ms\":" + std::to_string(decodeMs) +
+         ",\"total_ms\":" + std::to_string(prefillMs + decodeMs) +
+         ",\"thermal_state\":\"" + thermalStateName(state) +
+         "\",\"calibrated\":" + (calibrated ? "true" : "false") + "}";
+}
+
+size_t CactusLatencyModel::estimatePromptTokens(
+    const std::string &messagesJson) {
+  size_t bytes = 0;
+  size_t images = 0;
+  size_t messages = 0;
+
+  CactusJsonReader reader(messagesJson);
+  const bool parsed = reader.array([&]() {
+    messages++;
+    return reader.object([&](const std::string &key) {
+      if (key == "images") {
+        return reader.array([&]() {
+          images++;
+          return reader.skip();
+        });
+      }
+      if (key != "content") {
+        return reader.skip();
+      }
+      std::string content;
+      const bool ok = reader.string(content);
+      bytes += content.size();
+      return ok;
+    });
+  });
+
+  // Falls back to the size of the whole JSON
+  if (!parsed) {
+    bytes = messagesJson.size();
+  }
+  return (bytes + kBytesPerToken - 1) / kBytesPerToken +
+         messages * kTokensPerMessage + images * kTokensPerImage;
+}
+
+} // namespace margelo::nitro::cactus
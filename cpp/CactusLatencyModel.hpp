@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Predicts how long a completion takes on this device from the prefill and
+// decode speed of the model, learned from benchmarks and earlier completions.
+// Speeds are kept as if measured at a nominal thermal state and scaled by the
+// current state when predicting.
+class CactusLatencyModel {
+public:
+  // Replaces the learned speeds with those of a benchmark report
+  void calibrate(const std::string &benchmarkJson);
+
+  // Learns from the response of a completion
+  void observe(const std::string &responseJson);
+
+  // JSON with the estimated prompt tokens, the predicted prefill, decode and
+  // total milliseconds, the thermal state and whether any speed was learned
+  std::string predict(const std::string &messagesJson,
+                      size_t maxTokens) const;
+
+  // A rough count from the text and images of the messages, as the engine
+  // does not expose its tokenizer
+  static size_t estimatePromptTokens(const std::string &messagesJson);
+
+private:
+  // Weight of a new completion against what was learned before
+  static constexpr double kSmoothing = 0.3;
+  // Shorter prefills are dominated by fixed costs
+  static constexpr double kMinPrefillTokens = 16;
+
+  mutable std::mutex _mutex;
+  double _prefillMsPerToken = 0;
+  double _decodeMsPerToken = 0;
+
+  static void learn(double &msPerToken, double sample);
+};
+
+} // namespace margelo::nitro::cactus
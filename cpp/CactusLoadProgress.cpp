@@ -0,0 +1,56 @@
+#include "CactusLoadProgress.hpp"
+
+#include <algorithm>
+
+namespace margelo::nitro::cactus {
+
+void CactusLoadProgress::begin(const std::string &modelPath) {
+  stop();
+  _progress.store(0, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = false;
+  }
+  // The files are listed and mapped once, on the sampling thread
+  _sampler = std::thread([this, modelPath]() {
+    this->sample(std::make_unique<CactusMappedModelFiles>(modelPath));
+  });
+}
+
+void CactusLoadProgress::end(bool loaded) {
+  stop();
+  _progress.store(loaded ? 1 : 0, std::memory_order_relaxed);
+}
+
+void CactusLoadProgress::sample(std::unique_ptr<CactusMappedModelFiles> files) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (!_stopping && files->bytes() > 0) {
+    lock.unlock();
+    const double read =
+        static_cast<double>(files->residentBytes()) / files->bytes();
+    lock.lock();
+    if (_stopping) {
+      break;
+    }
+    _progress.store(kReadShare * std::min(read, 1.0),
+                    std::memory_order_relaxed);
+    // Nothing is left to follow once every page is in
+    if (read >= 1) {
+      break;
+    }
+    _condition.wait_for(lock, _interval, [this]() { return _stopping; });
+  }
+}
+
+void CactusLoadProgress::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _condition.notify_all();
+  if (_sampler.joinable()) {
+    _sampler.join();
+  }
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CactusModelFiles.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace margelo::nitro::cactus {
+
+// Progress of a model load. Reading the weights into the page cache is the
+// first stage and opening the engine the second, which reports nothing, so
+// progress stays at kReadShare until the load ends. Residency is sampled on
+// a thread of its own and published through an atomic, so reading the
+// progress costs the caller nothing while the weights are read ahead.
+class CactusLoadProgress {
+public:
+  static constexpr double kReadShare = 0.9;
+
+  explicit CactusLoadProgress(
+      std::chrono::milliseconds interval = std::chrono::milliseconds(100))
+      : _interval(interval) {}
+
+  ~CactusLoadProgress() { stop(); }
+
+  CactusLoadProgress(const CactusLoadProgress &) = delete;
+  CactusLoadProgress &operator=(const CactusLoadProgress &) = delete;
+
+  // Starts sampling the model files at 0
+  void begin(const std::string &modelPath);
+
+  // Stops sampling, then reports 1 for a loaded model and 0 otherwise
+  void end(bool loaded);
+
+  double progress() const { return _progress.load(std::memory_order_relaxed); }
+
+private:
+  const std::chrono::milliseconds _interval;
+  std::atomic<double> _progress{0};
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  bool _stopping = false;
+  std::thread _sampler;
+
+  void sample(std::unique_ptr<CactusMappedModelFiles> files);
+  void stop();
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,188 @@
+#include "CactusMetrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+template <typename T>
+T &findOrCreate(std::map<std::string, std::unique_ptr<T>> &metrics,
+                const std::string &name) {
+  auto &metric = metrics[name];
+  if (!metric) {
+    metric = std::make_unique<T>();
+  }
+  return *metric;
+}
+
+std::string jsonNumber(double value) {
+  if (!std::isfinite(value)) {
+    return "0";
+  }
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.6g", value);
+  return buffer;
+}
+
+} // namespace
+
+void CactusMetrics::Gauge::set(int64_t value) {
+  this->_value.store(value, std::memory_order_relaxed);
+  int64_t peak = this->_peak.load(std::memory_order_relaxed);
+  while (value > peak && !this->_peak.compare_exchange_weak(
+                             peak, value, std::memory_order_relaxed)) {
+  }
+}
+
+void CactusMetrics::Histogram::record(double value) {
+  if (!std::isfinite(value)) {
+    return;
+  }
+
+  size_t bucket = 0;
+  if (value >= std::ldexp(1.0, kMinExponent)) {
+    const double index = std::floor(
+        (std::log2(value) - kMinExponent) * kBucketsPerDoubling);
+    bucket = std::min<size_t>(static_cast<size_t>(index) + 1,
+                              kBucketCount - 1);
+  }
+  this->_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  this->_count.fetch_add(1, std::memory_order_relaxed);
+
+  double sum = this->_sum.load(std::memory_order_relaxed);
+  while (!this->_sum.compare_exchange_weak(sum, sum + value,
+                                           std::memory_order_relaxed)) {
+  }
+  double max = this->_max.load(std::memory_order_relaxed);
+  while (value > max && !this->_max.compare_exchange_weak(
+                            max, value, std::memory_order_relaxed)) {
+  }
+}
+
+double CactusMetrics::Histogram::upperBound(size_t bucket) {
+  return std::exp2(kMinExponent +
+                   static_cast<double>(bucket) / kBucketsPerDoubling);
+}
+
+double CactusMetrics::Histogram::percentile(double fraction,
+                                            uint64_t count) const {
+  const uint64_t rank = std::max<uint64_t>(std::ceil(fraction * count), 1);
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < kBucketCount; bucket++) {
+    seen += this->_buckets[bucket].load(std::memory_order_relaxed);
+    if (seen < rank) {
+      continue;
+    }
+    // The geometric middle of the bucket, never above the largest value
+    const double middle =
+        bucket == 0 ? 0
+                    : upperBound(bucket) *
+                          std::exp2(-0.5 / kBucketsPerDoubling);
+    return std::min(middle, this->_max.load(std::memory_order_relaxed));
+  }
+  return this->_max.load(std::memory_order_relaxed);
+}
+
+CactusMetrics &CactusMetrics::shared() {
+  static CactusMetrics metrics;
+  return metrics;
+}
+
+CactusMetrics::Counter &CactusMetrics::counter(const std::string &name) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return findOrCreate(this->_counters, name);
+}
+
+CactusMetrics::Gauge &CactusMetrics::gauge(const std::string &name) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return findOrCreate(this->_gauges, name);
+}
+
+CactusMetrics::Histogram &CactusMetrics::histogram(const std::string &name) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return findOrCreate(this->_histograms, name);
+}
+
+std::string CactusMetrics::snapshot() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  std::string json = "{\"counters\":{";
+  for (auto it = this->_counters.begin(); it != this->_counters.end(); ++it) {
+    if (it != this->_counters.begin()) {
+      json += ",";
+    }
+    json += "\"" + it->first + "\":" +
+            std::to_string(it->second->_value.load(std::memory_order_relaxed));
+  }
+
+  json += "},\"gauges\":{";
+  for (auto it = this->_gauges.begin(); it != this->_gauges.end(); ++it) {
+    if (it != this->_gauges.begin()) {
+      json += ",";
+    }
+    const auto &gauge = *it->second;
+    json += "\"" + it->first + "\":{\"value\":" +
+            std::to_string(gauge._value.load(std::memory_order_relaxed)) +
+            ",\"peak\":" +
+            std::to_string(gauge._peak.load(std::memory_order_relaxed)) + "}";
+  }
+
+  json += "},\"histograms\":{";
+  for (auto it = this->_histograms.begin(); it != this->_histograms.end();
+       ++it) {
+    if (it != this->_histograms.begin()) {
+      json += ",";
+    }
+    const auto &histogram = *it->second;
+    const uint64_t count = histogram._count.load(std::memory_order_relaxed);
+    json += "\"" + it->first + "\":{\"count\":" + std::to_string(count) +
+            ",\"sum\":" +
+            jsonNumber(histogram._sum.load(std::memory_order_relaxed)) +
+            ",\"max\":" +
+            jsonNumber(histogram._max.load(std::memory_order_relaxed)) +
+            ",\"p50\":" + jsonNumber(histogram.percentile(0.5, count)) +
+            ",\"p90\":" + jsonNumber(histogram.percentile(0.9, count)) +
+            ",\"p99\":" + jsonNumber(histogram.percentile(0.99, count)) +
+            ",\"buckets\":[";
+    bool first = true;
+    for (size_t bucket = 0; bucket < Histogram::kBucketCount; bucket++) {
+      const uint64_t bucketCount =
+          histogram._buckets[bucket].load(std::memory_order_relaxed);
+      if (bucketCount == 0) {
+        continue;
+      }
+      json += (first ? "[" : ",[") +
+              jsonNumber(Histogram::upperBound(bucket)) + "," +
+              std::to_string(bucketCount) + "]";
+      first = false;
+    }
+    json += "]}";
+  }
+
+  return json + "}}";
+}
+
+void CactusMetrics::reset() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  for (auto &[name, counter] : this->_counters) {
+    counter->_value.store(0, std::memory_order_relaxed);
+  }
+  for (auto &[name, gauge] : this->_gauges) {
+    gauge->_peak.store(gauge->_value.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+  }
+  for (auto &[name, histogram] : this->_histograms) {
+    for (auto &bucket : histogram->_buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    histogram->_count.store(0, std::memory_order_relaxed);
+    histogram->_sum.store(0, std::memory_order_relaxed);
+    histogram->_max.store(0, std::memory_order_relaxed);
+  }
+}
+
+} // namespace margelo::nitro::cactus
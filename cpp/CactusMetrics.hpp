@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Process-wide counters, gauges and histograms of model operations. Metrics
+// are created on first use and never removed, so callers may keep the
+// references. Recording is lock free; only creating a metric and taking a
+// snapshot lock the registry.
+class CactusMetrics {
+public:
+  class Counter {
+  public:
+    void add(uint64_t count = 1) {
+      _value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+  private:
+    friend class CactusMetrics;
+    std::atomic<uint64_t> _value{0};
+  };
+
+  class Gauge {
+  public:
+    void set(int64_t value);
+
+  private:
+    friend class CactusMetrics;
+    std::atomic<int64_t> _value{0};
+    std::atomic<int64_t> _peak{0};
+  };
+
+  // Counts values in buckets four to every doubling, which bounds the error
+  // of a reported percentile to about 9%
+  class Histogram {
+  public:
+    void record(double value);
+
+  private:
+    friend class CactusMetrics;
+
+    static constexpr int kBucketsPerDoubling = 4;
+    static constexpr int kMinExponent = -10;
+    static constexpr int kMaxExponent = 32;
+    // The first bucket holds everything below 2^kMinExponent
+    static constexpr size_t kBucketCount =
+        (kMaxExponent - kMinExponent) * kBucketsPerDoubling + 1;
+
+    std::array<std::atomic<uint64_t>, kBucketCount> _buckets{};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<double> _sum{0};
+    std::atomic<double> _max{0};
+
+    static double upperBound(size_t bucket);
+    double percentile(double fraction, uint64_t count) const;
+  };
+
+  static CactusMetrics &shared();
+
+  Counter &counter(const std::string &name);
+  Gauge &gauge(const std::string &name);
+  Histogram &histogram(const std::string &name);
+
+  // JSON with every metric by name. Histograms report their count, sum, max,
+  // percentiles and non-empty buckets by upper bound.
+  std::string snapshot();
+
+  // Zeroes every metric, keeping gauges at their current value
+  void reset();
+
+private:
+  std::mutex _mutex;
+  std::map<std::string, std::unique_ptr<Counter>> _counters;
+  std::map<std::string, std::unique_ptr<Gauge>> _gauges;
+  std::map<std::string, std::unique_ptr<Histogram>> _histograms;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,69 @@
+#include "CactusModelConfig.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace margelo::nitro::cactus {
+
+std::optional<CactusModelConfig>
+CactusModelConfig::fromModelPath(const std::string &modelPath) {
+  std::ifstream file(modelPath + "/config.txt");
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+
+  CactusModelConfig config;
+  std::string line;
+  while (std::getline(file, line)) {
+    const size_t separator = line.find('=');
+    if (separator == std::string::npos) {
+      continue;
+    }
+
+    const std::string key = line.substr(0, separator);
+    const std::string value = line.substr(separator + 1);
+
+    try {
+      if (key == "num_layers") {
+        config.numLayers = std::stoul(value);
+      } else if (key == "attention_kv_heads") {
+        config.attentionKvHeads = std::stoul(value);
+      } else if (key == "attention_head_dim") {
+        config.attentionHeadDim = std::stoul(value);
+      } else if (key == "context_size") {
+        config.maxContextSize = std::stoul(value);
+      } else if (key == "precision") {
+        config.elementSize = value.rfind("INT8", 0) == 0   ? 1
+                             : value.rfind("FP16", 0) == 0 ? 2
+                                                           : 4;
+      }
+    } catch (const std::exception &) {
+      return std::nullopt;
+    }
+  }
+
+  if (!config.numLayers || !config.attentionKvHeads ||
+      !config.attentionHeadDim) {
+    return std::nullopt;
+  }
+
+  return config;
+}
+
+size_t CactusModelConfig::kvCacheBytes(size_t contextSize) const {
+  // Keys and values for every layer
+  return 2 * static_cast<size_t>(numLayers) * contextSize * attentionKvHeads *
+         attentionHeadDim * elementSize;
+}
+
+size_t CactusModelConfig::contextSizeFitting(size_t memoryBytes) const {
+  constexpr size_t granularity = 256;
+
+  size_t contextSize = memoryBytes / kvCacheBytes(1);
+  if (maxContextSize) {
+    contextSize = std::min(contextSize, maxContextSize);
+  }
+  return contextSize / granularity * granularity;
+}
+
+} // namespace margelo::nitro::cactus
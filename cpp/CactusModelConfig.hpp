@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+struct CactusModelConfig {
+  uint32_t numLayers = 0;
+  uint32_t attentionKvHeads = 0;
+  uint32_t attentionHeadDim = 0;
+  size_t elementSize = 4;
+  size_t maxContextSize = 0;
+
+  static std::optional<CactusModelConfig>
+  fromModelPath(const std::string &modelPath);
+
+  size_t kvCacheBytes(size_t contextSize) const;
+
+  // Largest context whose cache fits in memoryBytes, or 0 if none does
+  size_t contextSizeFitting(size_t memoryBytes) const;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,152 @@
+#include "CactusModelFiles.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <optional>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+// The engine writes one layer_<n>_*.weights file per tensor. Files that do
+// not name a layer sort before the layers, as they hold the embeddings and
+// the configuration the first forward pass reads first.
+std::optional<size_t> layerIndex(const std::filesystem::path &path) {
+  const std::string name = path.filename().string();
+  const std::string prefix = "layer_";
+  if (name.compare(0, prefix.size(), prefix) != 0) {
+    return std::nullopt;
+  }
+  size_t index = 0;
+  size_t position = prefix.size();
+  while (position < name.size() &&
+         std::isdigit(static_cast<unsigned char>(name[position]))) {
+    index = index * 10 + static_cast<size_t>(name[position] - '0');
+    position++;
+  }
+  if (position == prefix.size()) {
+    return std::nullopt;
+  }
+  return index;
+}
+
+} // namespace
+
+size_t modelFileBytes(const std::string &modelPath) {
+  std::error_code error;
+  size_t bytes = 0;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(modelPath, error)) {
+    if (entry.is_regular_file(error)) {
+      bytes += entry.file_size(error);
+    }
+  }
+  return bytes;
+}
+
+std::vector<std::filesystem::path>
+modelFilePaths(const std::string &modelPath) {
+  std::error_code error;
+  std::vector<std::filesystem::path> paths;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(modelPath, error)) {
+    if (entry.is_regular_file(error)) {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end(),
+            [](const std::filesystem::path &a, const std::filesystem::path &b) {
+              const auto aLayer = layerIndex(a);
+              const auto bLayer = layerIndex(b);
+              if (aLayer != bLayer) {
+                // nullopt orders before every layer index
+                return aLayer < bLayer;
+              }
+              return a < b;
+            });
+  return paths;
+}
+
+CactusMappedModelFiles::CactusMappedModelFiles(const std::string &modelPath) {
+  std::error_code error;
+  for (const auto &path : modelFilePaths(modelPath)) {
+    const size_t size = std::filesystem::file_size(path, error);
+    if (error || size == 0) {
+      continue;
+    }
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      continue;
+    }
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      continue;
+    }
+    _mappings.push_back({data, size});
+    _bytes += size;
+  }
+}
+
+CactusMappedModelFiles::~CactusMappedModelFiles() {
+  for (const auto &mapping : _mappings) {
+    munmap(mapping.data, mapping.size);
+  }
+}
+
+size_t CactusMappedModelFiles::residentBytes() const {
+  const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::vector<unsigned char> resident;
+  size_t bytes = 0;
+  for (const auto &mapping : _mappings) {
+    resident.resize((mapping.size + pageSize - 1) / pageSize);
+#ifdef __APPLE__
+    const int result = mincore(mapping.data, mapping.size,
+                               reinterpret_cast<char *>(resident.data()));
+#else
+    const int result = mincore(mapping.data, mapping.size, resident.data());
+#endif
+    if (result != 0) {
+      continue;
+    }
+    size_t pages = 0;
+    for (const unsigned char page : resident) {
+      pages += page & 1;
+    }
+    bytes += std::min(pages * pageSize, mapping.size);
+  }
+  return bytes;
+}
+
+size_t residentModelFileBytes(const std::string &modelPath) {
+  return CactusMappedModelFiles(modelPath).residentBytes();
+}
+
+size_t prefetchModelFiles(const std::string &modelPath) {
+  std::error_code error;
+  size_t advised = 0;
+  for (const auto &path : modelFilePaths(modelPath)) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      continue;
+    }
+#ifdef __APPLE__
+    radvisory advisory{};
+    advisory.ra_offset = 0;
+    advisory.ra_count = static_cast<int>(std::min<uintmax_t>(
+        std::filesystem::file_size(path, error), INT_MAX));
+    fcntl(fd, F_RDADVISE, &advisory);
+#else
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    close(fd);
+    advised++;
+  }
+  return advised;
+}
+
+} // namespace margelo::nitro::cactus
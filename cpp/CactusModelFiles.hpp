@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Total size of the files in a model directory
+size_t modelFileBytes(const std::string &modelPath);
+
+// Files that are not layer_<n>_* first, then the layers by numeric index,
+// ties in name order
+std::vector<std::filesystem::path> modelFilePaths(const std::string &modelPath);
+
+// Read-only mappings of the model files, kept so that how much of them the
+// page cache holds can be sampled repeatedly without listing the directory
+// or mapping the files again. Mapping a file does not read it.
+class CactusMappedModelFiles {
+public:
+  explicit CactusMappedModelFiles(const std::string &modelPath);
+  ~CactusMappedModelFiles();
+
+  CactusMappedModelFiles(const CactusMappedModelFiles &) = delete;
+  CactusMappedModelFiles &operator=(const CactusMappedModelFiles &) = delete;
+
+  // Total size of the mapped files
+  size_t bytes() const { return _bytes; }
+
+  // Bytes of the mapped files currently in the page cache
+  size_t residentBytes() const;
+
+private:
+  struct Mapping {
+    void *data;
+    size_t size;
+  };
+
+  std::vector<Mapping> _mappings;
+  size_t _bytes = 0;
+};
+
+// Bytes of the model files currently in the page cache, which is how far
+// the read-ahead issued by prefetchModelFiles has come
+size_t residentModelFileBytes(const std::string &modelPath);
+
+// Asks the kernel to read the weight files ahead, so the first forward pass
+// after the pages were dropped does not fault them in one by one. Only issues
+// the advice, the reads run while the engine maps the weights and warms up.
+// Returns the number of files advised.
+size_t prefetchModelFiles(const std::string &modelPath);
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,119 @@
+#include "CactusModelRegistry.hpp"
+#include "CactusMetrics.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+namespace margelo::nitro::cactus {
+
+CactusModelRegistry &CactusModelRegistry::shared() {
+  static CactusModelRegistry registry;
+  return registry;
+}
+
+void CactusModelRegistry::setMemoryBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  this->_memoryBudget = bytes;
+  this->evict(nullptr);
+  this->publish();
+}
+
+void CactusModelRegistry::acquire(
+    const void *owner, const std::string &weightsPath, size_t weightBytes,
+    size_t bytes, std::function<bool()> unload,
+    std::function<std::optional<size_t>()> shed) {
+  // Every spelling of the same directory maps to the same weights
+  std::filesystem::path path(weightsPath);
+  if (!path.has_filename()) {
+    path = path.parent_path();
+  }
+  std::error_code error;
+  const auto canonical = std::filesystem::weakly_canonical(path, error);
+  std::string canonicalPath = error ? path.string() : canonical.string();
+
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  const auto resident = std::find_if(
+      this->_residents.begin(), this->_residents.end(),
+      [owner](const Resident &resident) { return resident.owner == owner; });
+  if (resident != this->_residents.end()) {
+    this->_residents.erase(resident);
+  }
+
+  this->_residents.push_front({owner, std::move(canonicalPath), weightBytes,
+                              bytes, std::move(unload), std::move(shed)});
+  this->evict(owner);
+  this->publish();
+}
+
+void CactusModelRegistry::release(const void *owner) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  this->_residents.remove_if(
+      [owner](const Resident &resident) { return resident.owner == owner; });
+  this->publish();
+}
+
+void CactusModelRegistry::trim(CactusMemoryPressure pressure) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  for (auto it = this->_residents.begin(); it != this->_residents.end();) {
+    if (pressure == CactusMemoryPressure::Critical && it->unload()) {
+      it = this->_residents.erase(it);
+      continue;
+    }
+    if (const auto bytes = it->shed()) {
+      it->bytes = *bytes;
+    }
+    ++it;
+  }
+  this->publish();
+}
+
+size_t CactusModelRegistry::residentBytes() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  return this->totalBytes();
+}
+
+size_t CactusModelRegistry::totalBytes() const {
+  std::unordered_map<std::string, size_t> weightBytes;
+  size_t totalBytes = 0;
+  for (const auto &resident : this->_residents) {
+    auto &bytes = weightBytes[resident.weightsPath];
+    bytes = std::max(bytes, resident.weightBytes);
+    totalBytes += resident.bytes;
+  }
+  for (const auto &[path, bytes] : weightBytes) {
+    totalBytes += bytes;
+  }
+  return totalBytes;
+}
+
+void CactusModelRegistry::publish() {
+  CactusMetrics::shared()
+      .gauge("resident_model_bytes")
+      .set(this->totalBytes());
+}
+
+void CactusModelRegistry::evict(const void *except) {
+  if (!this->_memoryBudget) {
+    return;
+  }
+
+  // Models that are busy refuse to unload and are skipped. Unloading one of
+  // several owners of the same weights only frees what it holds on its own.
+  auto it = this->_residents.end();
+  while (this->totalBytes() > this->_memoryBudget &&
+         it != this->_residents.begin()) {
+    --it;
+    if (it->owner == except || !it->unload()) {
+      continue;
+    }
+    it = this->_residents.erase(it);
+  }
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+enum class CactusMemoryPressure { Moderate, Critical };
+
+// Process-wide accounting of the memory held by loaded models. Once the
+// budget is exceeded, idle models are unloaded least recently used first and
+// reopened by their owner on next use. Weights are mapped from their files, so
+// owners of the same files share them and they are counted once.
+class CactusModelRegistry {
+public:
+  static CactusModelRegistry &shared();
+
+  // A budget of 0 disables eviction
+  void setMemoryBudget(size_t bytes);
+
+  // Records the resident size of owner, the weights it maps from the files at
+  // weightsPath and the bytes it holds on its own, and marks it most recently
+  // used. unload and shed are called with the registry locked and must not
+  // call back into it. shed releases what the owner can rebuild and returns
+  // the bytes it still holds on its own, or nothing while the model is busy.
+  void acquire(const void *owner, const std::string &weightsPath,
+               size_t weightBytes, size_t bytes, std::function<bool()> unload,
+               std::function<std::optional<size_t>()> shed);
+
+  // Called when the system runs low on memory. Idle models shed their caches,
+  // and under critical pressure they are unloaded.
+  void trim(CactusMemoryPressure pressure);
+
+  void release(const void *owner);
+
+  size_t residentBytes();
+
+private:
+  struct Resident {
+    const void *owner;
+    std::string weightsPath;
+    size_t weightBytes;
+    size_t bytes;
+    std::function<bool()> unload;
+    std::function<std::optional<size_t>()> shed;
+  };
+
+  std::mutex _mutex;
+  // Most recently used first
+  std::list<Resident> _residents;
+  size_t _memoryBudget = 0;
+
+  size_t totalBytes() const;
+  void evict(const void *except);
+  void publish();
+};
+
+} // namespace margelo::nitro::cactus
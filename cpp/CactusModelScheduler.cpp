@@ -0,0 +1,84 @@
+#include "CactusModelScheduler.hpp"
+
+#include <numeric>
+
+namespace margelo::nitro::cactus {
+
+CactusModelScheduler::Guard::Guard(CactusModelScheduler &scheduler,
+                                   Priority priority)
+    : _scheduler(scheduler), _priority(priority),
+      _waitMs(scheduler.lock(priority)) {}
+
+CactusModelScheduler::Guard::~Guard() { this->_scheduler.unlock(); }
+
+bool CactusModelScheduler::Guard::yield() {
+  {
+    std::lock_guard<std::mutex> lock(this->_scheduler._mutex);
+    if (!this->_scheduler.hasHigherPriorityWaiting(
+            static_cast<size_t>(this->_priority))) {
+      return false;
+    }
+  }
+
+  this->_scheduler.unlock();
+  this->_waitMs += this->_scheduler.lock(this->_priority);
+  return true;
+}
+
+double CactusModelScheduler::lock(Priority priority) {
+  const auto start = std::chrono::steady_clock::now();
+  const size_t index = static_cast<size_t>(priority);
+
+  std::unique_lock<std::mutex> lock(this->_mutex);
+
+  const uint64_t ticket = this->_nextTicket[index]++;
+  this->_waiting[index]++;
+  this->_condition.wait(lock, [this, index, ticket]() {
+    return !this->_busy && !this->hasHigherPriorityWaiting(index) &&
+           this->_servingTicket[index] == ticket;
+  });
+  this->_waiting[index]--;
+  this->_servingTicket[index]++;
+  this->_busy = true;
+
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+bool CactusModelScheduler::try_lock() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  if (this->_busy || this->hasHigherPriorityWaiting(kPriorityCount)) {
+    return false;
+  }
+
+  this->_busy = true;
+  return true;
+}
+
+void CactusModelScheduler::unlock() {
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_busy = false;
+  }
+  this->_condition.notify_all();
+}
+
+size_t CactusModelScheduler::queueDepth() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  return std::accumulate(this->_waiting.begin(), this->_waiting.end(),
+                         size_t{0});
+}
+
+bool CactusModelScheduler::hasHigherPriorityWaiting(size_t priority) const {
+  for (size_t i = 0; i < priority; i++) {
+    if (this->_waiting[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace margelo::nitro::cactus
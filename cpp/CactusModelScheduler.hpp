@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace margelo::nitro::cactus {
+
+// Grants exclusive use of a model to one operation at a time. Waiting
+// operations are served by priority class first and in arrival order within
+// a class.
+class CactusModelScheduler {
+public:
+  enum class Priority : size_t { Interactive, Embedding, Background };
+
+  class Guard {
+  public:
+    Guard(CactusModelScheduler &scheduler, Priority priority);
+    ~Guard();
+
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+    // Lets waiting operations of a higher priority class run before
+    // continuing, returns whether any did
+    bool yield();
+
+    double waitMs() const { return this->_waitMs; }
+
+  private:
+    CactusModelScheduler &_scheduler;
+    const Priority _priority;
+    double _waitMs;
+  };
+
+  // Returns the time spent waiting in milliseconds
+  double lock(Priority priority);
+  // Only succeeds when the model is idle and nothing is waiting
+  bool try_lock();
+  void unlock();
+
+  size_t queueDepth();
+
+private:
+  static constexpr size_t kPriorityCount = 3;
+
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  bool _busy = false;
+  std::array<size_t, kPriorityCount> _waiting{};
+  std::array<uint64_t, kPriorityCount> _nextTicket{};
+  std::array<uint64_t, kPriorityCount> _servingTicket{};
+
+  bool hasHigherPriorityWaiting(size_t priority) const;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,190 @@
+#include "CactusPng.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+const std::array<uint32_t, 256> &crcTable() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+    return table;
+  }();
+  return table;
+}
+
+void appendBigEndian(std::vector<uint8_t> &out, uint32_t value) {
+  out.push_back(value >> 24);
+  out.push_back(value >> 16);
+  out.push_back(value >> 8);
+  out.push_back(value);
+}
+
+// Chunks are built in place: the length and CRC are filled in by finishChunk
+std::vector<uint8_t> beginChunk(const char *type, size_t capacity) {
+  std::vector<uint8_t> chunk(4);
+  chunk.reserve(capacity + 12);
+  chunk.insert(chunk.end(), type, type + 4);
+  return chunk;
+}
+
+void finishChunk(std::ofstream &file, std::vector<uint8_t> &chunk) {
+  const uint32_t length = static_cast<uint32_t>(chunk.size() - 8);
+  chunk[0] = length >> 24;
+  chunk[1] = length >> 16;
+  chunk[2] = length >> 8;
+  chunk[3] = length;
+
+  // Covers the type and the data
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 4; i < chunk.size(); ++i) {
+    crc = crcTable()[(crc ^ chunk[i]) & 0xFF] ^ (crc >> 8);
+  }
+  appendBigEndian(chunk, crc ^ 0xFFFFFFFFu);
+
+  file.write(reinterpret_cast<const char *>(chunk.data()),
+             static_cast<std::streamsize>(chunk.size()));
+}
+
+// Removes the least recently used images beyond maxFiles, never the one
+// that was just used. Errors are ignored, another call may be evicting the
+// same files.
+void evictContentNamedPngs(const std::filesystem::path &directory,
+                           const std::filesystem::path &keep,
+                           size_t maxFiles) {
+  std::error_code error;
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>>
+      images;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(directory, error)) {
+    if (entry.path().extension() == ".png" && entry.path() != keep) {
+      images.emplace_back(entry.last_write_time(error), entry.path());
+    }
+  }
+  // The kept image counts towards the cap
+  const size_t keepCount = maxFiles > 0 ? maxFiles - 1 : 0;
+  if (images.size() <= keepCount) {
+    return;
+  }
+  std::sort(images.begin(), images.end());
+  for (size_t i = 0; i < images.size() - keepCount; ++i) {
+    std::filesystem::remove(images[i].second, error);
+  }
+}
+
+} // namespace
+
+void writeUncompressedPng(const std::string &path, const uint8_t *rgb,
+                          uint32_t width, uint32_t height) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+
+  static constexpr uint8_t kSignature[] = {0x89, 'P',  'N',  'G',
+                                           '\r', '\n', 0x1A, '\n'};
+  file.write(reinterpret_cast<const char *>(kSignature), sizeof(kSignature));
+
+  auto header = beginChunk("IHDR", 13);
+  appendBigEndian(header, width);
+  appendBigEndian(header, height);
+  // 8 bits per channel, RGB, deflate, adaptive filtering, no interlace
+  header.insert(header.end(), {8, 2, 0, 0, 0});
+  finishChunk(file, header);
+
+  // Each row starts with the filter type, 0 for none. The rows are streamed
+  // straight into stored deflate blocks of a zlib stream inside the chunk,
+  // so the pixels are copied once.
+  constexpr size_t kMaxBlock = 65535;
+  const size_t rowBytes = static_cast<size_t>(width) * 3;
+  const size_t total = (rowBytes + 1) * height;
+  auto idat = beginChunk("IDAT", total + (total / kMaxBlock + 1) * 5 + 6);
+  idat.push_back(0x78);
+  idat.push_back(0x01);
+
+  size_t remaining = total;
+  size_t blockLeft = 0;
+  uint32_t a = 1, b = 0;
+  auto append = [&](const uint8_t *data, size_t size) {
+    while (size > 0) {
+      if (blockLeft == 0) {
+        blockLeft = std::min(kMaxBlock, remaining);
+        remaining -= blockLeft;
+        idat.push_back(remaining == 0 ? 1 : 0);
+        idat.push_back(blockLeft & 0xFF);
+        idat.push_back(blockLeft >> 8);
+        idat.push_back(~blockLeft & 0xFF);
+        idat.push_back((~blockLeft >> 8) & 0xFF);
+      }
+      const size_t length = std::min(blockLeft, size);
+      idat.insert(idat.end(), data, data + length);
+      for (size_t i = 0; i < length; ++i) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+      }
+      blockLeft -= length;
+      data += length;
+      size -= length;
+    }
+  };
+
+  static constexpr uint8_t kFilterNone = 0;
+  for (uint32_t y = 0; y < height; ++y) {
+    append(&kFilterNone, 1);
+    append(rgb + y * rowBytes, rowBytes);
+  }
+  appendBigEndian(idat, (b << 16) | a);
+  finishChunk(file, idat);
+
+  auto end = beginChunk("IEND", 0);
+  finishChunk(file, end);
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + path);
+  }
+}
+
+std::string writeContentNamedPng(const std::string &directory,
+                                 const uint8_t *rgb, uint32_t width,
+                                 uint32_t height, size_t maxFiles) {
+  const size_t bytes = static_cast<size_t>(width) * height * 3;
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < bytes; ++i) {
+    hash = (hash ^ rgb[i]) * 1099511628211ull;
+  }
+  char name[24];
+  std::snprintf(name, sizeof(name), "%016llx.png",
+                static_cast<unsigned long long>(hash));
+
+  const auto path = std::filesystem::path(directory) / name;
+  if (!std::filesystem::exists(path)) {
+    std::filesystem::create_directories(directory);
+    // Written under a temporary name so a reader never sees half a file
+    auto partialPath = path;
+    partialPath += ".part";
+    writeUncompressedPng(partialPath.string(), rgb, width, height);
+    std::filesystem::rename(partialPath, path);
+  } else {
+    std::error_code error;
+    std::filesystem::last_write_time(
+        path, std::filesystem::file_time_type::clock::now(), error);
+  }
+  evictContentNamedPngs(directory, path, maxFiles);
+  return path.string();
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Content-named images kept per directory before the least recently used
+// ones are removed. Enough for the images of a long conversation, while a
+// camera feed sending every frame stays at a fixed disk footprint.
+constexpr size_t kMaxContentNamedPngs = 64;
+
+// Writes 8-bit RGB pixels as an uncompressed PNG. Encoding and decoding it
+// costs little more than copying the pixels, unlike a JPEG round trip.
+void writeUncompressedPng(const std::string &path, const uint8_t *rgb,
+                          uint32_t width, uint32_t height);
+
+// Writes the pixels to a file in directory named after their content, unless
+// it exists already, and returns its path. The same image always maps to the
+// same path, so the serialized history stays identical between turns even
+// when the caller hands over a new buffer for it. Using an image marks it as
+// recently used, and writing one past maxFiles removes the least recently
+// used others. An evicted image is written again the next time it is sent.
+std::string writeContentNamedPng(const std::string &directory,
+                                 const uint8_t *rgb, uint32_t width,
+                                 uint32_t height,
+                                 size_t maxFiles = kMaxContentNamedPngs);
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// The buffer the engine writes a response into. Reused across calls and only
+// grown, so it is not zero-filled each time.
+class CactusResponseBuffer {
+public:
+  char *prepare(size_t size) {
+    if (_data.size() < std::max<size_t>(size, 1)) {
+      _data.resize(std::max<size_t>(size, 1));
+    }
+    _data[0] = '\0';
+    return _data.data();
+  }
+
+  // Copies out the response written since prepare(size)
+  std::string take(size_t size) const {
+    const size_t length = strnlen(_data.data(), std::min(size, _data.size()));
+
+    // The engine writes nothing when the response does not fit
+    if (length == 0) {
+      throw std::runtime_error("Cactus response exceeded responseBufferSize");
+    }
+
+    return std::string(_data.data(), length);
+  }
+
+  void release() { std::vector<char>().swap(_data); }
+
+  size_t capacity() const { return _data.size(); }
+
+private:
+  std::vector<char> _data;
+};
+
+} // namespace margelo::nitro::cactus
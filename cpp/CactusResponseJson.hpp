@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Helpers for the flat JSON objects returned by the engine
+
+inline void insertResponseFields(std::string &responseJson,
+                                 const std::string &fields) {
+  const size_t pos = responseJson.find("\"prefill_tokens\"");
+  if (pos == std::string::npos || fields.empty()) {
+    return;
+  }
+  responseJson.insert(pos, fields + ",");
+}
+
+inline std::string jsonString(const std::string &value) {
+  std::string quoted = "\"";
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+    }
+    if (static_cast<unsigned char>(c) >= 0x20) {
+      quoted += c;
+    }
+  }
+  return quoted + "\"";
+}
+
+inline double responseNumber(const std::string &responseJson,
+                             const std::string &key) {
+  const size_t pos = responseJson.find("\"" + key + "\":");
+  if (pos == std::string::npos) {
+    return 0;
+  }
+  return std::strtod(responseJson.c_str() + pos + key.size() + 3, nullptr);
+}
+
+} // namespace margelo::nitro::cactus
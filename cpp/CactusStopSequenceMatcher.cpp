@@ -0,0 +1,98 @@
+#include "CactusStopSequenceMatcher.hpp"
+#include "CactusJsonReader.hpp"
+
+#include <queue>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+constexpr uint32_t kNone = UINT32_MAX;
+
+} // namespace
+
+CactusStopSequenceMatcher::CactusStopSequenceMatcher(
+    const std::vector<std::string> &sequences) {
+  std::array<uint32_t, 256> empty;
+  empty.fill(kNone);
+  this->_next.push_back(empty);
+  this->_accepting.push_back(false);
+
+  for (const auto &sequence : sequences) {
+    if (sequence.empty()) {
+      continue;
+    }
+    uint32_t state = 0;
+    for (const char c : sequence) {
+      const uint8_t byte = static_cast<uint8_t>(c);
+      if (this->_next[state][byte] == kNone) {
+        this->_next[state][byte] = this->_next.size();
+        this->_next.push_back(empty);
+        this->_accepting.push_back(false);
+      }
+      state = this->_next[state][byte];
+    }
+    this->_accepting[state] = true;
+  }
+
+  // Breadth first, so the failure state of every node is complete before its
+  // children use it
+  std::vector<uint32_t> failure(this->_next.size(), 0);
+  std::queue<uint32_t> pending;
+  for (auto &next : this->_next[0]) {
+    if (next == kNone) {
+      next = 0;
+    } else {
+      pending.push(next);
+    }
+  }
+  while (!pending.empty()) {
+    const uint32_t state = pending.front();
+    pending.pop();
+    if (this->_accepting[failure[state]]) {
+      this->_accepting[state] = true;
+    }
+    for (size_t byte = 0; byte < 256; byte++) {
+      const uint32_t fallback = this->_next[failure[state]][byte];
+      uint32_t &next = this->_next[state][byte];
+      if (next == kNone) {
+        next = fallback;
+      } else {
+        failure[next] = fallback;
+        pending.push(next);
+      }
+    }
+  }
+}
+
+std::vector<std::string>
+CactusStopSequenceMatcher::sequencesOf(const std::string &optionsJson) {
+  std::vector<std::string> sequences;
+  CactusJsonReader reader(optionsJson);
+  reader.object([&](const std::string &key) {
+    if (key != "stop_sequences") {
+      return reader.skip();
+    }
+    return reader.array([&]() {
+      std::string sequence;
+      if (!reader.string(sequence)) {
+        return false;
+      }
+      sequences.push_back(std::move(sequence));
+      return true;
+    });
+  });
+  return sequences;
+}
+
+bool CactusStopSequenceMatcher::feed(const std::string &piece) {
+  for (const char c : piece) {
+    this->_state = this->_next[this->_state][static_cast<uint8_t>(c)];
+    if (this->_accepting[this->_state]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace margelo::nitro::cactus
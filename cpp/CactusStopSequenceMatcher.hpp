@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Watches the streamed output for any of a set of stop sequences, so
+// generation can be stopped on the token that completes one instead of
+// running on to max_tokens. The sequences are compiled into an Aho-Corasick
+// automaton with the failure links folded into the transitions, so each
+// output byte costs one table lookup however many sequences there are.
+class CactusStopSequenceMatcher {
+public:
+  explicit CactusStopSequenceMatcher(const std::vector<std::string> &sequences);
+
+  // The stop_sequences of the options passed to the engine
+  static std::vector<std::string> sequencesOf(const std::string &optionsJson);
+
+  // False without any sequences to match
+  bool enabled() const { return _next.size() > 1; }
+
+  // Returns true once the output ends with one of the sequences
+  bool feed(const std::string &piece);
+
+private:
+  std::vector<std::array<uint32_t, 256>> _next;
+  std::vector<bool> _accepting;
+  uint32_t _state = 0;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,57 @@
+#include "CactusThermalGovernor.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace margelo::nitro::cactus {
+
+void CactusThermalGovernor::begin() {
+  this->_active = this->_enabled.load(std::memory_order_relaxed);
+  if (!this->_active) {
+    return;
+  }
+
+  this->_state = currentThermalState();
+
+  // Fraction of the fastest decode rate seen on this model
+  const double fraction = thermalSpeedFraction(this->_state);
+
+  this->_capTokensPerSecond =
+      fraction < 1 ? this->_peakTokensPerSecond * fraction : 0;
+  this->_lastToken = Clock::now();
+}
+
+void CactusThermalGovernor::throttle() {
+  if (!this->_active || this->_capTokensPerSecond <= 0) {
+    return;
+  }
+
+  const auto minInterval = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1 / this->_capTokensPerSecond));
+  const auto next = this->_lastToken + minInterval;
+
+  if (Clock::now() < next) {
+    std::this_thread::sleep_until(next);
+  }
+  this->_lastToken = Clock::now();
+}
+
+void CactusThermalGovernor::end(double tokensPerSecond) {
+  if (!this->_active || this->_capTokensPerSecond > 0) {
+    return;
+  }
+  this->_peakTokensPerSecond =
+      std::max(this->_peakTokensPerSecond, tokensPerSecond);
+}
+
+std::string CactusThermalGovernor::responseFields() const {
+  if (!this->_active) {
+    return "";
+  }
+  return std::string("\"thermal_state\":\"") +
+         thermalStateName(this->_state) +
+         "\",\"decode_cap_tokens_per_second\":" +
+         std::to_string(this->_capTokensPerSecond);
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CactusThermalState.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Caps the decode rate while the device is hot, trading peak speed for
+// sustained throughput before the OS throttles or kills the app
+class CactusThermalGovernor {
+public:
+  void setEnabled(bool enabled) {
+    _enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Samples the thermal state before a generation
+  void begin();
+
+  // Called after every generated token
+  void throttle();
+
+  void end(double tokensPerSecond);
+
+  // Governor decision as JSON fields, empty while disabled
+  std::string responseFields() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic<bool> _enabled{false};
+  bool _active = false;
+  CactusThermalState _state = CactusThermalState::Nominal;
+  double _peakTokensPerSecond = 0;
+  double _capTokensPerSecond = 0;
+  Clock::time_point _lastToken;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,81 @@
+#include "CactusThermalState.hpp"
+
+#ifdef __ANDROID__
+#include <dlfcn.h>
+#endif
+
+namespace margelo::nitro::cactus {
+
+CactusThermalState thermalStateOfAndroidStatus(int status) {
+  // NONE, LIGHT and MODERATE leave the device usable as iOS does up to fair,
+  // SEVERE is where iOS reports serious, and CRITICAL and above throttle hard
+  if (status >= 4) {
+    return CactusThermalState::Critical;
+  }
+  if (status == 3) {
+    return CactusThermalState::Serious;
+  }
+  if (status >= 1) {
+    return CactusThermalState::Fair;
+  }
+  return CactusThermalState::Nominal;
+}
+
+const char *thermalStateName(CactusThermalState state) {
+  switch (state) {
+  case CactusThermalState::Nominal:
+    return "nominal";
+  case CactusThermalState::Fair:
+    return "fair";
+  case CactusThermalState::Serious:
+    return "serious";
+  case CactusThermalState::Critical:
+    return "critical";
+  }
+  return "nominal";
+}
+
+double thermalSpeedFraction(CactusThermalState state) {
+  switch (state) {
+  case CactusThermalState::Serious:
+    return 0.7;
+  case CactusThermalState::Critical:
+    return 0.4;
+  default:
+    return 1;
+  }
+}
+
+#ifndef __APPLE__
+
+CactusThermalState currentThermalState() {
+#ifdef __ANDROID__
+  // The thermal API is only available from API level 30, so it is resolved
+  // at runtime instead of raising the minimum SDK
+  using AcquireManager = void *(*)();
+  using GetCurrentStatus = int (*)(void *);
+
+  static void *const library = dlopen("libandroid.so", RTLD_NOW);
+  static const auto acquireManager =
+      library ? reinterpret_cast<AcquireManager>(
+                    dlsym(library, "AThermal_acquireManager"))
+              : nullptr;
+  static const auto getCurrentStatus =
+      library ? reinterpret_cast<GetCurrentStatus>(
+                    dlsym(library, "AThermal_getCurrentThermalStatus"))
+              : nullptr;
+  static void *const manager = acquireManager ? acquireManager() : nullptr;
+
+  if (!manager || !getCurrentStatus) {
+    return CactusThermalState::Nominal;
+  }
+
+  return thermalStateOfAndroidStatus(getCurrentStatus(manager));
+#else
+  return CactusThermalState::Nominal;
+#endif
+}
+
+#endif
+
+} // namespace margelo::nitro::cactus
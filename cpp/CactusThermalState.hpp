@@ -0,0 +1,18 @@
+#pragma once
+
+namespace margelo::nitro::cactus {
+
+enum class CactusThermalState { Nominal, Fair, Serious, Critical };
+
+// Implemented in ios/CactusThermalState.mm on Apple platforms
+CactusThermalState currentThermalState();
+
+// From an ATHERMAL_STATUS_* value of the Android thermal API
+CactusThermalState thermalStateOfAndroidStatus(int status);
+
+const char *thermalStateName(CactusThermalState state);
+
+// Fraction of the nominal decode speed sustained in a state
+double thermalSpeedFraction(CactusThermalState state);
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Single-producer single-consumer byte ring for streamed tokens. The decode
+// thread pushes tokens without ever blocking, the JS thread drains them in
+// batches.
+class CactusTokenRingBuffer {
+public:
+  explicit CactusTokenRingBuffer(size_t capacity = kDefaultCapacity)
+      : _capacity(capacity), _buffer(std::make_unique<char[]>(capacity)) {}
+
+  // Producer only. Fails without writing anything if the consumer has fallen
+  // behind.
+  bool push(const char *data, size_t length) {
+    const size_t head = _head.load(std::memory_order_relaxed);
+    const size_t tail = _tail.load(std::memory_order_acquire);
+
+    if (length > _capacity - (head - tail)) {
+      return false;
+    }
+
+    const size_t offset = head % _capacity;
+    const size_t firstLength = std::min(length, _capacity - offset);
+    std::memcpy(_buffer.get() + offset, data, firstLength);
+    std::memcpy(_buffer.get(), data + firstLength, length - firstLength);
+
+    _head.store(head + length, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only
+  std::string drain() {
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    const size_t head = _head.load(std::memory_order_acquire);
+    const size_t length = head - tail;
+
+    std::string result;
+    if (length == 0) {
+      return result;
+    }
+
+    result.resize(length);
+    const size_t offset = tail % _capacity;
+    const size_t firstLength = std::min(length, _capacity - offset);
+    std::memcpy(result.data(), _buffer.get() + offset, firstLength);
+    std::memcpy(result.data() + firstLength, _buffer.get(),
+                length - firstLength);
+
+    _tail.store(head, std::memory_order_release);
+    return result;
+  }
+
+  // Producer only. The consumer may free more at any time.
+  size_t space() const {
+    return _capacity - (_head.load(std::memory_order_relaxed) -
+                        _tail.load(std::memory_order_acquire));
+  }
+
+private:
+  static constexpr size_t kDefaultCapacity = 64 * 1024;
+
+  const size_t _capacity;
+  std::unique_ptr<char[]> _buffer;
+
+  alignas(64) std::atomic<size_t> _head{0};
+  alignas(64) std::atomic<size_t> _tail{0};
+};
+
+} // namespace margelo::nitro::cactus
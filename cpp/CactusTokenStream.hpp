@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CactusTokenRingBuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// The tokens of one request on their way to JS. Tokens that do not fit while
+// JS falls behind wait on the decode thread, which never blocks, and follow
+// once there is room or with the first drain after the request finished.
+class CactusTokenStream {
+public:
+  // Producer only
+  void push(const std::string &piece) {
+    _pending += piece;
+    size_t length = std::min(_pending.size(), _buffer.space());
+    // JS receives the bytes as a string, so characters are never split
+    while (length > 0 && length < _pending.size() &&
+           (static_cast<uint8_t>(_pending[length]) & 0xC0) == 0x80) {
+      length--;
+    }
+    if (length > 0 && _buffer.push(_pending.data(), length)) {
+      _pending.erase(0, length);
+    }
+  }
+
+  // Producer only, after its last push
+  void finish() { _finished.store(true, std::memory_order_release); }
+
+  // Consumer only
+  std::string drain() {
+    const bool finished = _finished.load(std::memory_order_acquire);
+    std::string tokens = _buffer.drain();
+    if (finished) {
+      tokens += _pending;
+      _pending.clear();
+    }
+    return tokens;
+  }
+
+private:
+  CactusTokenRingBuffer _buffer;
+  // Owned by the producer until it finishes
+  std::string _pending;
+  std::atomic<bool> _finished{false};
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,134 @@
+#include "CactusToolCallValidator.hpp"
+#include "CactusJsonReader.hpp"
+
+#include <algorithm>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+bool contains(const std::vector<std::string> &names, const std::string &name) {
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+// The engine passes the arguments of JSON calls through as the model wrote
+// them, which may be an object or an object encoded as a string
+bool readArgumentNames(CactusJsonReader &reader,
+                       std::vector<std::string> &names) {
+  const auto readNames = [&names](CactusJsonReader &reader) {
+    return reader.object([&](const std::string &name) {
+      names.push_back(name);
+      return reader.skip();
+    });
+  };
+  if (reader.peek() == '{') {
+    return readNames(reader);
+  }
+  std::string encoded;
+  if (reader.peek() == '"' && reader.string(encoded)) {
+    CactusJsonReader encodedReader(encoded);
+    readNames(encodedReader);
+    return true;
+  }
+  return reader.skip();
+}
+
+} // namespace
+
+CactusToolCallValidator::CactusToolCallValidator(const std::string &toolsJson) {
+  CactusJsonReader reader(toolsJson);
+  const bool parsed = reader.array([&]() {
+    Tool tool;
+    const bool ok = reader.object([&](const std::string &key) {
+      if (key != "function") {
+        return reader.skip();
+      }
+      return reader.object([&](const std::string &key) {
+        if (key == "name") {
+          return reader.string(tool.name);
+        }
+        if (key != "parameters") {
+          return reader.skip();
+        }
+        return reader.object([&](const std::string &key) {
+          if (key == "properties") {
+            return reader.object([&](const std::string &argument) {
+              tool.arguments.push_back(argument);
+              return reader.skip();
+            });
+          }
+          if (key == "required") {
+            return reader.array([&]() {
+              tool.required.emplace_back();
+              return reader.string(tool.required.back());
+            });
+          }
+          return reader.skip();
+        });
+      });
+    });
+    if (ok && !tool.name.empty()) {
+      this->_tools.push_back(std::move(tool));
+    }
+    return ok;
+  });
+
+  // Never rejects calls against tools it could not read
+  if (!parsed) {
+    this->_tools.clear();
+  }
+}
+
+std::string
+CactusToolCallValidator::check(const std::string &responseJson) const {
+  std::string error;
+  CactusJsonReader reader(responseJson);
+  reader.object([&](const std::string &key) {
+    if (key != "function_calls") {
+      return reader.skip();
+    }
+    return reader.array([&]() {
+      std::string name;
+      std::vector<std::string> arguments;
+      const bool ok = reader.object([&](const std::string &key) {
+        if (key == "name") {
+          return reader.string(name);
+        }
+        if (key == "arguments") {
+          return readArgumentNames(reader, arguments);
+        }
+        return reader.skip();
+      });
+      if (ok && error.empty()) {
+        error = this->check(name, arguments);
+      }
+      return ok;
+    });
+  });
+  return error;
+}
+
+std::string CactusToolCallValidator::check(
+    const std::string &name, const std::vector<std::string> &arguments) const {
+  const auto tool =
+      std::find_if(this->_tools.begin(), this->_tools.end(),
+                   [&name](const Tool &tool) { return tool.name == name; });
+  if (tool == this->_tools.end()) {
+    return "Unknown tool " + name;
+  }
+  if (!tool->arguments.empty()) {
+    for (const auto &argument : arguments) {
+      if (!contains(tool->arguments, argument)) {
+        return "Unknown argument " + argument + " of tool " + name;
+      }
+    }
+  }
+  for (const auto &argument : tool->required) {
+    if (!contains(arguments, argument)) {
+      return "Missing argument " + argument + " of tool " + name;
+    }
+  }
+  return "";
+}
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Checks the tool calls the engine parsed out of a completion against the
+// tools of the completion. The engine accepts every call it can parse, in the
+// [name(arg=value, ...)] form between <|tool_call_start|> and
+// <|tool_call_end|> or as a JSON "function_call" object, and returns it
+// whether or not the tool exists. Reading its function_calls instead of the
+// decoded text keeps the check in step with its grammar, and generation is
+// never stopped for a call it would have returned.
+class CactusToolCallValidator {
+public:
+  // Tools are given in the OpenAI format passed to cactus_complete
+  explicit CactusToolCallValidator(const std::string &toolsJson);
+
+  // False without any tools to check against
+  bool enabled() const { return !_tools.empty(); }
+
+  // Describes the first call of the response that names an unknown tool,
+  // passes an unknown argument or leaves out a required one, or returns an
+  // empty string
+  std::string check(const std::string &responseJson) const;
+
+private:
+  struct Tool {
+    std::string name;
+    // Empty when the tool declares no properties, in which case any
+    // argument is accepted
+    std::vector<std::string> arguments;
+    std::vector<std::string> required;
+  };
+
+  std::vector<Tool> _tools;
+
+  std::string check(const std::string &name,
+                    const std::vector<std::string> &arguments) const;
+};
+
+} // namespace margelo::nitro::cactus
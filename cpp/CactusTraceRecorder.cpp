@@ -0,0 +1,64 @@
+#include "CactusTraceRecorder.hpp"
+
+#include <functional>
+#include <thread>
+
+namespace margelo::nitro::cactus {
+
+void CactusTraceRecorder::setEnabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  if (enabled && !this->enabled()) {
+    this->_events.clear();
+    this->_epoch = Clock::now();
+  }
+  this->_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void CactusTraceRecorder::add(const char *name, const char *category,
+                              Clock::time_point start, Clock::time_point end,
+                              std::string argsJson) {
+  if (!this->enabled()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  if (this->_events.size() >= kMaxEvents) {
+    return;
+  }
+
+  this->_events.push_back(
+      {name, category, start, end,
+       std::hash<std::thread::id>{}(std::this_thread::get_id()) % 100000,
+       std::move(argsJson)});
+}
+
+std::string CactusTraceRecorder::take() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  auto micros = [this](Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time -
+                                                                 this->_epoch)
+        .count();
+  };
+
+  std::string json = "{\"traceEvents\":[";
+  for (size_t i = 0; i < this->_events.size(); i++) {
+    const Event &event = this->_events[i];
+    json += i ? "," : "";
+    const auto start = micros(event.start);
+    json += "{\"name\":\"" + std::string(event.name) + "\",\"cat\":\"" +
+            event.category + "\",\"ph\":\"X\",\"ts\":" +
+            std::to_string(start) +
+            ",\"dur\":" + std::to_string(micros(event.end) - start) +
+            ",\"pid\":1,\"tid\":" + std::to_string(event.threadId) +
+            ",\"args\":{" + event.argsJson + "}}";
+  }
+  json += "],\"displayTimeUnit\":\"ms\"}";
+
+  this->_events.clear();
+  return json;
+}
+
+} // namespace margelo::nitro::cactus
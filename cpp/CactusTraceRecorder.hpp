@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Collects timed spans and serializes them in the Chrome trace event format,
+// which chrome://tracing and Perfetto can load directly
+class CactusTraceRecorder {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void setEnabled(bool enabled);
+  bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+  // argsJson is the body of a JSON object without braces
+  void add(const char *name, const char *category, Clock::time_point start,
+           Clock::time_point end, std::string argsJson = "");
+
+  // Returns the recorded spans and clears them
+  std::string take();
+
+private:
+  static constexpr size_t kMaxEvents = 100000;
+
+  struct Event {
+    const char *name;
+    const char *category;
+    Clock::time_point start;
+    Clock::time_point end;
+    size_t threadId;
+    std::string argsJson;
+  };
+
+  std::atomic<bool> _enabled{false};
+  std::mutex _mutex;
+  std::vector<Event> _events;
+  Clock::time_point _epoch = Clock::now();
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace margelo::nitro::cactus {
+
+// Joins streamed token pieces into complete UTF-8 code points. Byte-level
+// tokens may end in the middle of a multi-byte character, whose remaining
+// bytes arrive with the next token.
+class CactusUtf8Decoder {
+public:
+  CactusUtf8Decoder() { _output.reserve(kInitialCapacity); }
+
+  // Returns the complete code points so far, valid until the next call
+  const std::string &feed(const char *data) {
+    _output.assign(_pending, _pendingLength);
+    _output.append(data, std::strlen(data));
+    _pendingLength = 0;
+
+    const size_t length = _output.size();
+    size_t lead = length;
+    while (lead > 0 && length - lead < 4 &&
+           (static_cast<unsigned char>(_output[lead - 1]) & 0xC0) == 0x80) {
+      --lead;
+    }
+    if (lead == 0) {
+      return _output;
+    }
+    --lead;
+
+    if (lead + sequenceLength(_output[lead]) > length) {
+      _pendingLength = length - lead;
+      std::memcpy(_pending, _output.data() + lead, _pendingLength);
+      _output.resize(lead);
+    }
+    return _output;
+  }
+
+  // Called once the last token was fed. The bytes of a character that was
+  // never finished come back as U+FFFD, as a streaming decoder ends them.
+  const std::string &flush() {
+    _output.clear();
+    if (_pendingLength > 0) {
+      _output = "\xEF\xBF\xBD";
+      _pendingLength = 0;
+    }
+    return _output;
+  }
+
+private:
+  static constexpr size_t kInitialCapacity = 64;
+
+  static size_t sequenceLength(char lead) {
+    const auto byte = static_cast<unsigned char>(lead);
+    if (byte >= 0xF0 && byte <= 0xF7) {
+      return 4;
+    }
+    if (byte >= 0xE0) {
+      return byte <= 0xEF ? 3 : 1;
+    }
+    return byte >= 0xC0 ? 2 : 1;
+  }
+
+  std::string _output;
+  char _pending[4];
+  size_t _pendingLength = 0;
+};
+
+} // namespace margelo::nitro::cactus
@@ -0,0 +1,589 @@
+#include "CactusVectorIndex.hpp"
+#include "CactusCpuFeatures.hpp"
+#include "CactusDotprod.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+constexpr char kMagic[4] = {'C', 'I', 'D', 'X'};
+constexpr uint32_t kVersion = 1;
+
+// Magic, version, dimension, list count, trained count, reserved. The
+// centroids follow as floats, then the records.
+constexpr size_t kHeaderSize = 32;
+
+// Each record is the id, its list and the scale of its codes followed by the
+// codes. Deleted records keep their place until the index is retrained.
+constexpr size_t kRecordHeaderSize = 16;
+constexpr uint32_t kDeleted = UINT32_MAX;
+
+constexpr size_t kMinTrainSize = 1024;
+constexpr size_t kMaxLists = 1024;
+constexpr size_t kTrainSamplesPerList = 32;
+constexpr int kTrainIterations = 8;
+
+constexpr size_t kMinMapSize = 1 << 20;
+
+template <typename T> T readAt(const uint8_t *data, size_t offset) {
+  T value;
+  std::memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+template <typename T> void writeAt(uint8_t *data, size_t offset, T value) {
+  std::memcpy(data + offset, &value, sizeof(T));
+}
+
+bool writeAll(int fd, const uint8_t *data, size_t size, off_t offset) {
+  while (size > 0) {
+    const ssize_t written = pwrite(fd, data, size, offset);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+// Normalizes x and quantizes it symmetrically, returning the scale of the
+// codes. A zero vector has a scale of 0 and never matches.
+float quantize(const float *x, size_t dimension, int8_t *codes) {
+  float norm = 0;
+  for (size_t i = 0; i < dimension; ++i) {
+    norm += x[i] * x[i];
+  }
+  norm = std::sqrt(norm);
+
+  float maxAbs = 0;
+  for (size_t i = 0; i < dimension; ++i) {
+    maxAbs = std::max(maxAbs, std::fabs(x[i]));
+  }
+  if (norm == 0 || maxAbs == 0) {
+    std::fill(codes, codes + dimension, 0);
+    return 0;
+  }
+
+  const float scale = maxAbs / norm / 127;
+  const float inverse = 1 / (scale * norm);
+  for (size_t i = 0; i < dimension; ++i) {
+    codes[i] = static_cast<int8_t>(std::lround(x[i] * inverse));
+  }
+  return scale;
+}
+
+int32_t dotInt8(const int8_t *a, const int8_t *b, size_t n) {
+#if !defined(__ARM_FEATURE_DOTPROD) && defined(CACTUS_DOTPROD_DISPATCH)
+  static const bool dotprod = CactusCpuFeatures::current().dotprod;
+  if (dotprod) {
+    return dotInt8Dotprod(a, b, n);
+  }
+#endif
+  size_t i = 0;
+  int32_t sum = 0;
+#if defined(__ARM_FEATURE_DOTPROD)
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 16 <= n; i += 16) {
+    acc = vdotq_s32(acc, vld1q_s8(a + i), vld1q_s8(b + i));
+  }
+  sum = vaddvq_s32(acc);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  // Codes stay within [-127, 127], so a product fits in 16 bits
+  int32x4_t acc = vdupq_n_s32(0);
+  for (; i + 16 <= n; i += 16) {
+    const int8x16_t va = vld1q_s8(a + i);
+    const int8x16_t vb = vld1q_s8(b + i);
+    acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+    acc = vpadalq_s16(acc, vmull_high_s8(va, vb));
+  }
+  sum = vaddvq_s32(acc);
+#endif
+  for (; i < n; ++i) {
+    sum += static_cast<int32_t>(a[i]) * b[i];
+  }
+  return sum;
+}
+
+} // namespace
+
+CactusVectorIndex::CactusVectorIndex(const std::string &path,
+                                     size_t dimension)
+    : _path(path), _dimension(dimension),
+      _recordSize(kRecordHeaderSize + dimension) {
+  if (dimension == 0) {
+    throw std::runtime_error("Vector index dimension must be positive");
+  }
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path());
+
+  try {
+    this->open();
+    this->load();
+  } catch (...) {
+    this->close();
+    throw;
+  }
+}
+
+CactusVectorIndex::~CactusVectorIndex() { this->close(); }
+
+void CactusVectorIndex::open() {
+  this->_fd = ::open(this->_path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (this->_fd < 0) {
+    throw std::runtime_error("Failed to open vector index " + this->_path);
+  }
+
+  struct stat info;
+  fstat(this->_fd, &info);
+  this->_fileSize = info.st_size;
+
+  uint8_t header[kHeaderSize] = {};
+  if (this->_fileSize == 0) {
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    writeAt<uint32_t>(header, 4, kVersion);
+    writeAt<uint32_t>(header, 8, this->_dimension);
+    if (!writeAll(this->_fd, header, kHeaderSize, 0)) {
+      this->close();
+      throw std::runtime_error("Failed to create vector index " + this->_path);
+    }
+    this->_fileSize = kHeaderSize;
+  } else if (this->_fileSize < kHeaderSize ||
+             pread(this->_fd, header, kHeaderSize, 0) !=
+                 static_cast<ssize_t>(kHeaderSize) ||
+             std::memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+             readAt<uint32_t>(header, 4) != kVersion) {
+    this->close();
+    throw std::runtime_error("Not a vector index: " + this->_path);
+  }
+
+  const uint32_t dimension = readAt<uint32_t>(header, 8);
+  if (dimension != this->_dimension) {
+    this->close();
+    throw std::runtime_error("Vector index has dimension " +
+                             std::to_string(dimension) + ", not " +
+                             std::to_string(this->_dimension));
+  }
+
+  const uint32_t lists = readAt<uint32_t>(header, 12);
+  this->_trainedCount = readAt<uint64_t>(header, 16);
+  this->_dataOffset = kHeaderSize + lists * this->_dimension * sizeof(float);
+
+  std::vector<float> centroids(lists * this->_dimension);
+  const ssize_t centroidBytes = centroids.size() * sizeof(float);
+  if (this->_fileSize < this->_dataOffset ||
+      pread(this->_fd, centroids.data(), centroidBytes, kHeaderSize) !=
+          centroidBytes) {
+    this->close();
+    throw std::runtime_error("Vector index is truncated: " + this->_path);
+  }
+
+  this->_centroidCodes.resize(centroids.size());
+  this->_centroidScales.resize(lists);
+  for (uint32_t list = 0; list < lists; ++list) {
+    this->_centroidScales[list] =
+        quantize(centroids.data() + list * this->_dimension, this->_dimension,
+                 this->_centroidCodes.data() + list * this->_dimension);
+  }
+
+  this->remap();
+}
+
+void CactusVectorIndex::close() {
+  if (this->_map) {
+    munmap(this->_map, this->_mapSize);
+    this->_map = nullptr;
+    this->_mapSize = 0;
+  }
+  if (this->_fd >= 0) {
+    ::close(this->_fd);
+    this->_fd = -1;
+  }
+}
+
+void CactusVectorIndex::remap() {
+  // Mapped with room to grow, so appends rarely need a new mapping. Only the
+  // part backed by the file is ever read.
+  if (this->_map && this->_fileSize <= this->_mapSize) {
+    return;
+  }
+  if (this->_map) {
+    munmap(this->_map, this->_mapSize);
+    this->_map = nullptr;
+  }
+
+  const size_t mapSize = std::max(this->_fileSize * 2, kMinMapSize);
+  void *map = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, this->_fd, 0);
+  if (map == MAP_FAILED) {
+    throw std::runtime_error("Failed to map vector index");
+  }
+  this->_map = static_cast<uint8_t *>(map);
+  this->_mapSize = mapSize;
+}
+
+void CactusVectorIndex::load() {
+  this->_lists.assign(std::max<size_t>(1, this->listCount()), {});
+  this->_records.clear();
+  this->_deletedCount = 0;
+
+  // A record cut short by the app being killed mid-append is dropped
+  const size_t count =
+      (this->_fileSize - this->_dataOffset) / this->_recordSize;
+  const size_t end = this->_dataOffset + count * this->_recordSize;
+  if (end != this->_fileSize && ftruncate(this->_fd, end) == 0) {
+    this->_fileSize = end;
+  }
+
+  for (uint32_t number = 0; number < count; ++number) {
+    const uint8_t *record = this->record(number);
+    const uint32_t list = readAt<uint32_t>(record, 8);
+    if (list >= this->_lists.size()) {
+      this->_deletedCount++;
+      continue;
+    }
+    const int64_t id = readAt<int64_t>(record, 0);
+    const auto existing = this->_records.find(id);
+    if (existing != this->_records.end()) {
+      this->markDeleted(existing->second);
+    }
+    this->_records[id] = number;
+    this->_lists[list].push_back(number);
+  }
+}
+
+const uint8_t *CactusVectorIndex::record(uint32_t number) const {
+  return this->_map + this->_dataOffset +
+         static_cast<size_t>(number) * this->_recordSize;
+}
+
+uint32_t CactusVectorIndex::nearestList(const int8_t *codes) const {
+  uint32_t nearest = 0;
+  float best = -INFINITY;
+  for (uint32_t list = 0; list < this->listCount(); ++list) {
+    const float score =
+        dotInt8(codes,
+                this->_centroidCodes.data() + list * this->_dimension,
+                this->_dimension) *
+        this->_centroidScales[list];
+    if (score > best) {
+      best = score;
+      nearest = list;
+    }
+  }
+  return nearest;
+}
+
+void CactusVectorIndex::markDeleted(uint32_t number) {
+  const size_t offset =
+      this->_dataOffset + static_cast<size_t>(number) * this->_recordSize;
+  const uint32_t list = readAt<uint32_t>(this->_map, offset + 8);
+  if (list < this->_lists.size()) {
+    auto &members = this->_lists[list];
+    const auto it = std::find(members.begin(), members.end(), number);
+    if (it != members.end()) {
+      *it = members.back();
+      members.pop_back();
+    }
+  }
+
+  uint8_t deleted[sizeof(kDeleted)];
+  writeAt<uint32_t>(deleted, 0, kDeleted);
+  if (!writeAll(this->_fd, deleted, sizeof(deleted), offset + 8)) {
+    throw std::runtime_error("Failed to write vector index");
+  }
+  this->_deletedCount++;
+}
+
+void CactusVectorIndex::add(const int64_t *ids, const float *embeddings,
+                            size_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  std::vector<uint8_t> records(count * this->_recordSize);
+  std::vector<uint32_t> lists(count);
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t *record = records.data() + i * this->_recordSize;
+    int8_t *codes = reinterpret_cast<int8_t *>(record + kRecordHeaderSize);
+    const float scale =
+        quantize(embeddings + i * this->_dimension, this->_dimension, codes);
+    lists[i] = this->nearestList(codes);
+    writeAt<int64_t>(record, 0, ids[i]);
+    writeAt<uint32_t>(record, 8, lists[i]);
+    writeAt<float>(record, 12, scale);
+  }
+
+  const size_t offset = this->_fileSize;
+  if (!writeAll(this->_fd, records.data(), records.size(), offset)) {
+    // Leaves no partial record behind for the next append to follow
+    ftruncate(this->_fd, offset);
+    throw std::runtime_error("Failed to write vector index");
+  }
+  this->_fileSize += records.size();
+  this->remap();
+
+  const uint32_t first = (offset - this->_dataOffset) / this->_recordSize;
+  for (size_t i = 0; i < count; ++i) {
+    const auto existing = this->_records.find(ids[i]);
+    if (existing != this->_records.end()) {
+      this->markDeleted(existing->second);
+    }
+    this->_records[ids[i]] = first + i;
+    this->_lists[lists[i]].push_back(first + i);
+  }
+
+  if (this->size() >= std::max(kMinTrainSize, 2 * this->_trainedCount) ||
+      (this->_deletedCount >= kMinTrainSize &&
+       this->_deletedCount > this->size())) {
+    this->retrain();
+  }
+}
+
+void CactusVectorIndex::remove(const int64_t *ids, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const auto existing = this->_records.find(ids[i]);
+    if (existing == this->_records.end()) {
+      continue;
+    }
+    this->markDeleted(existing->second);
+    this->_records.erase(existing);
+  }
+
+  // Rewriting the file drops the deleted records
+  if (this->_deletedCount >= kMinTrainSize &&
+      this->_deletedCount > this->size()) {
+    this->retrain();
+  }
+}
+
+void CactusVectorIndex::retrain() {
+  const size_t dimension = this->_dimension;
+
+  std::vector<uint32_t> live;
+  live.reserve(this->_records.size());
+  for (const auto &[id, number] : this->_records) {
+    live.push_back(number);
+  }
+  std::sort(live.begin(), live.end());
+
+  auto codesOf = [this](uint32_t number) {
+    return reinterpret_cast<const int8_t *>(this->record(number) +
+                                            kRecordHeaderSize);
+  };
+  auto scaleOf = [this](uint32_t number) {
+    return readAt<float>(this->record(number), 12);
+  };
+
+  // Spherical k-means over an evenly spaced sample of the records, with
+  // about sqrt(n) lists. Smaller indexes stay a single exact list.
+  size_t lists = 0;
+  if (live.size() >= kMinTrainSize) {
+    lists = std::clamp<size_t>(std::lround(std::sqrt(live.size())), 1,
+                               kMaxLists);
+  }
+  std::vector<float> centroids(lists * dimension);
+  if (lists > 0) {
+    const size_t samples =
+        std::min(live.size(), lists * kTrainSamplesPerList);
+    std::vector<uint32_t> sample(samples);
+    for (size_t i = 0; i < samples; ++i) {
+      sample[i] = live[i * live.size() / samples];
+    }
+
+    for (size_t list = 0; list < lists; ++list) {
+      const uint32_t number = sample[list * samples / lists];
+      const int8_t *codes = codesOf(number);
+      const float scale = scaleOf(number);
+      for (size_t d = 0; d < dimension; ++d) {
+        centroids[list * dimension + d] = codes[d] * scale;
+      }
+    }
+
+    this->_centroidCodes.resize(lists * dimension);
+    this->_centroidScales.resize(lists);
+    std::vector<float> sums(lists * dimension);
+    std::vector<size_t> members(lists);
+    for (int iteration = 0; iteration < kTrainIterations; ++iteration) {
+      for (size_t list = 0; list < lists; ++list) {
+        this->_centroidScales[list] =
+            quantize(centroids.data() + list * dimension, dimension,
+                     this->_centroidCodes.data() + list * dimension);
+      }
+
+      std::fill(sums.begin(), sums.end(), 0.0f);
+      std::fill(members.begin(), members.end(), 0);
+      for (const uint32_t number : sample) {
+        const int8_t *codes = codesOf(number);
+        const float scale = scaleOf(number);
+        const uint32_t list = this->nearestList(codes);
+        for (size_t d = 0; d < dimension; ++d) {
+          sums[list * dimension + d] += codes[d] * scale;
+        }
+        members[list]++;
+      }
+
+      // A list that lost all its members keeps its centroid
+      for (size_t list = 0; list < lists; ++list) {
+        if (members[list] > 0) {
+          std::copy(sums.begin() + list * dimension,
+                    sums.begin() + (list + 1) * dimension,
+                    centroids.begin() + list * dimension);
+        }
+      }
+    }
+  }
+
+  this->_centroidCodes.resize(lists * dimension);
+  this->_centroidScales.resize(lists);
+  for (size_t list = 0; list < lists; ++list) {
+    this->_centroidScales[list] =
+        quantize(centroids.data() + list * dimension, dimension,
+                 this->_centroidCodes.data() + list * dimension);
+    // Stored normalized, like the records
+    const float scale = this->_centroidScales[list];
+    for (size_t d = 0; d < dimension; ++d) {
+      centroids[list * dimension + d] =
+          this->_centroidCodes[list * dimension + d] * scale;
+    }
+  }
+
+  // Records are rewritten grouped by list, so a query reads each list it
+  // probes sequentially
+  std::vector<std::pair<uint32_t, uint32_t>> assigned;
+  assigned.reserve(live.size());
+  for (const uint32_t number : live) {
+    assigned.emplace_back(this->nearestList(codesOf(number)), number);
+  }
+  std::stable_sort(
+      assigned.begin(), assigned.end(),
+      [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  const std::string partialPath = this->_path + ".part";
+  const int fd =
+      ::open(partialPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open " + partialPath);
+  }
+
+  std::vector<uint8_t> buffer(kHeaderSize);
+  std::memcpy(buffer.data(), kMagic, sizeof(kMagic));
+  writeAt<uint32_t>(buffer.data(), 4, kVersion);
+  writeAt<uint32_t>(buffer.data(), 8, dimension);
+  writeAt<uint32_t>(buffer.data(), 12, lists);
+  writeAt<uint64_t>(buffer.data(), 16, lists > 0 ? live.size() : 0);
+  const auto *centroidBytes =
+      reinterpret_cast<const uint8_t *>(centroids.data());
+  buffer.insert(buffer.end(), centroidBytes,
+                centroidBytes + centroids.size() * sizeof(float));
+
+  size_t written = 0;
+  bool ok = true;
+  auto flush = [&]() {
+    ok = ok && writeAll(fd, buffer.data(), buffer.size(), written);
+    written += buffer.size();
+    buffer.clear();
+  };
+  for (const auto &[list, number] : assigned) {
+    const uint8_t *record = this->record(number);
+    const size_t start = buffer.size();
+    buffer.insert(buffer.end(), record, record + this->_recordSize);
+    writeAt<uint32_t>(buffer.data() + start, 8, list);
+    if (buffer.size() >= kMinMapSize) {
+      flush();
+    }
+  }
+  flush();
+  ::close(fd);
+
+  if (!ok) {
+    std::filesystem::remove(partialPath);
+    throw std::runtime_error("Failed to write vector index");
+  }
+
+  this->close();
+  std::filesystem::rename(partialPath, this->_path);
+  this->open();
+  this->load();
+}
+
+std::vector<CactusVectorIndex::Result>
+CactusVectorIndex::query(const float *embedding, size_t k,
+                         size_t probes) const {
+  std::vector<int8_t> codes(this->_dimension);
+  const float queryScale = quantize(embedding, this->_dimension, codes.data());
+  if (k == 0 || queryScale == 0 || this->_records.empty()) {
+    return {};
+  }
+
+  // The probes lists whose centroids are most similar to the query
+  std::vector<uint32_t> scanned;
+  if (this->listCount() == 0) {
+    scanned.push_back(0);
+  } else {
+    std::vector<std::pair<float, uint32_t>> centroids(this->listCount());
+    for (uint32_t list = 0; list < this->listCount(); ++list) {
+      centroids[list] = {
+          dotInt8(codes.data(),
+                  this->_centroidCodes.data() + list * this->_dimension,
+                  this->_dimension) *
+              this->_centroidScales[list],
+          list};
+    }
+    const size_t count = std::clamp<size_t>(probes, 1, centroids.size());
+    std::partial_sort(centroids.begin(), centroids.begin() + count,
+                      centroids.end(), std::greater<>());
+    for (size_t i = 0; i < count; ++i) {
+      scanned.push_back(centroids[i].second);
+    }
+  }
+
+  // Smallest of the best k on top
+  auto worse = [](const Result &a, const Result &b) {
+    return a.score > b.score;
+  };
+  std::priority_queue<Result, std::vector<Result>, decltype(worse)> best(
+      worse);
+  for (const uint32_t list : scanned) {
+    for (const uint32_t number : this->_lists[list]) {
+      const uint8_t *record = this->record(number);
+      const float score =
+          dotInt8(codes.data(),
+                  reinterpret_cast<const int8_t *>(record + kRecordHeaderSize),
+                  this->_dimension) *
+          readAt<float>(record, 12) * queryScale;
+      if (best.size() < k) {
+        best.push({readAt<int64_t>(record, 0), score});
+      } else if (score > best.top().score) {
+        best.pop();
+        best.push({readAt<int64_t>(record, 0), score});
+      }
+    }
+  }
+
+  std::vector<Result> results(best.size());
+  for (size_t i = results.size(); i > 0; --i) {
+    results[i - 1] = best.top();
+    best.pop();
+  }
+  return results;
+}
+
+} // namespace margelo::nitro::cactus
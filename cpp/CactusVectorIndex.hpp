@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Approximate nearest neighbour search over embeddings, persisted in a
+// memory-mapped file. Vectors are normalized and stored as int8 codes grouped
+// into inverted lists around k-means centroids, so a query only scans the
+// lists closest to it. Small indexes are scanned exactly until they are large
+// enough to train the lists on.
+//
+// Not thread safe; callers serialize access.
+class CactusVectorIndex {
+public:
+  struct Result {
+    int64_t id;
+    // Cosine similarity
+    float score;
+  };
+
+  // Opens the index at path, creating it if it does not exist
+  CactusVectorIndex(const std::string &path, size_t dimension);
+  ~CactusVectorIndex();
+
+  CactusVectorIndex(const CactusVectorIndex &) = delete;
+  CactusVectorIndex &operator=(const CactusVectorIndex &) = delete;
+
+  size_t dimension() const { return _dimension; }
+  size_t size() const { return _records.size(); }
+
+  // Replaces the vectors of ids that are already indexed. Retrains the lists
+  // once the index has doubled in size since they were last trained.
+  void add(const int64_t *ids, const float *embeddings, size_t count);
+
+  void remove(const int64_t *ids, size_t count);
+
+  // Scans the probes lists closest to the query
+  std::vector<Result> query(const float *embedding, size_t k,
+                            size_t probes) const;
+
+private:
+  std::string _path;
+  size_t _dimension;
+  size_t _recordSize;
+
+  int _fd = -1;
+  uint8_t *_map = nullptr;
+  size_t _mapSize = 0;
+  size_t _fileSize = 0;
+  size_t _dataOffset = 0;
+
+  // Quantized like the records, one per list. Empty while untrained.
+  std::vector<int8_t> _centroidCodes;
+  std::vector<float> _centroidScales;
+  size_t _trainedCount = 0;
+
+  // Record numbers per list, and of every live id
+  std::vector<std::vector<uint32_t>> _lists;
+  std::unordered_map<int64_t, uint32_t> _records;
+  size_t _deletedCount = 0;
+
+  void open();
+  void close();
+  void remap();
+  void load();
+  void retrain();
+
+  size_t listCount() const { return _centroidScales.size(); }
+  uint32_t nearestList(const int8_t *codes) const;
+  const uint8_t *record(uint32_t number) const;
+  void markDeleted(uint32_t number);
+};
+
+} // namespace margelo::nitro::cactus
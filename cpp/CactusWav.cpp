@@ -0,0 +1,143 @@
+#include "CactusWav.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+void writeLittleEndian(std::ofstream &file, uint32_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    file.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+uint32_t readLittleEndian(const char *data, size_t bytes) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < bytes; ++i) {
+    value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+} // namespace
+
+CactusWavAudio readWav(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+
+  char header[12];
+  if (!file.read(header, sizeof(header)) ||
+      std::string(header, 4) != "RIFF" ||
+      std::string(header + 8, 4) != "WAVE") {
+    throw std::runtime_error("Not a WAV file: " + path);
+  }
+
+  uint32_t format = 0;
+  uint32_t channels = 0;
+  uint32_t bitsPerSample = 0;
+  CactusWavAudio audio;
+
+  char chunkHeader[8];
+  while (file.read(chunkHeader, sizeof(chunkHeader))) {
+    const std::string chunkId(chunkHeader, 4);
+    const uint32_t chunkSize = readLittleEndian(chunkHeader + 4, 4);
+    // Chunks are padded to an even size
+    const uint32_t paddedSize = chunkSize + (chunkSize & 1);
+
+    if (chunkId == "fmt " && chunkSize >= 16) {
+      std::vector<char> fmt(paddedSize);
+      file.read(fmt.data(), paddedSize);
+      format = readLittleEndian(fmt.data(), 2);
+      channels = readLittleEndian(fmt.data() + 2, 2);
+      audio.sampleRate = readLittleEndian(fmt.data() + 4, 4);
+      bitsPerSample = readLittleEndian(fmt.data() + 14, 2);
+      // WAVE_FORMAT_EXTENSIBLE stores the format in the sub-format GUID
+      if (format == 0xFFFE && chunkSize >= 26) {
+        format = readLittleEndian(fmt.data() + 24, 2);
+      }
+    } else if (chunkId == "data") {
+      const bool pcm16 = format == 1 && bitsPerSample == 16;
+      const bool float32 = format == 3 && bitsPerSample == 32;
+      if (!channels || (!pcm16 && !float32)) {
+        throw std::runtime_error("Unsupported WAV format: " + path);
+      }
+
+      std::vector<char> data(chunkSize);
+      file.read(data.data(), chunkSize);
+      const size_t bytesPerFrame = channels * (bitsPerSample / 8);
+      const size_t frames = static_cast<size_t>(file.gcount()) / bytesPerFrame;
+
+      audio.samples.resize(frames);
+      for (size_t frame = 0; frame < frames; ++frame) {
+        const char *sample = data.data() + frame * bytesPerFrame;
+        float sum = 0;
+        for (uint32_t channel = 0; channel < channels; ++channel) {
+          if (pcm16) {
+            int16_t value;
+            std::memcpy(&value, sample + 2 * channel, sizeof(value));
+            sum += value / 32768.0f;
+          } else {
+            float value;
+            std::memcpy(&value, sample + 4 * channel, sizeof(value));
+            sum += value;
+          }
+        }
+        audio.samples[frame] = sum / static_cast<float>(channels);
+      }
+      return audio;
+    } else {
+      file.seekg(paddedSize, std::ios::cur);
+    }
+  }
+
+  throw std::runtime_error("WAV file has no audio data: " + path);
+}
+
+void writeWav(const std::string &path, const float *samples, size_t count,
+              uint32_t sampleRate) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+
+  constexpr uint32_t bytesPerSample = 2;
+  const auto dataBytes = static_cast<uint32_t>(count * bytesPerSample);
+
+  file.write("RIFF", 4);
+  writeLittleEndian(file, 36 + dataBytes, 4);
+  file.write("WAVE", 4);
+
+  file.write("fmt ", 4);
+  writeLittleEndian(file, 16, 4);
+  writeLittleEndian(file, 1, 2); // PCM
+  writeLittleEndian(file, 1, 2); // Mono
+  writeLittleEndian(file, sampleRate, 4);
+  writeLittleEndian(file, sampleRate * bytesPerSample, 4);
+  writeLittleEndian(file, bytesPerSample, 2);
+  writeLittleEndian(file, 8 * bytesPerSample, 2);
+
+  file.write("data", 4);
+  writeLittleEndian(file, dataBytes, 4);
+
+  std::vector<int16_t> pcm(count);
+  std::transform(samples, samples + count, pcm.begin(), [](float sample) {
+    return static_cast<int16_t>(std::clamp(sample, -1.0f, 1.0f) * 32767.0f);
+  });
+  // Little-endian on every supported platform
+  file.write(reinterpret_cast<const char *>(pcm.data()),
+             static_cast<std::streamsize>(pcm.size() * bytesPerSample));
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + path);
+  }
+}
+
+} // namespace margelo::nitro::cactus
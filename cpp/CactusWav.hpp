@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::cactus {
+
+// Whisper models expect 16 kHz mono audio
+constexpr uint32_t kWhisperSampleRate = 16000;
+
+struct CactusWavAudio {
+  std::vector<float> samples;
+  uint32_t sampleRate = 0;
+};
+
+// Reads a 16-bit PCM or 32-bit float WAV file, mixing channels down to mono
+CactusWavAudio readWav(const std::string &path);
+
+// Writes samples in [-1, 1] as a 16-bit PCM mono WAV file
+void writeWav(const std::string &path, const float *samples, size_t count,
+              uint32_t sampleRate = kWhisperSampleRate);
+
+} // namespace margelo::nitro::cactus
@@ -1,29 +1,448 @@
 #include "HybridCactus.hpp"
+#include "CactusBenchmark.hpp"
+#include "CactusCancellation.hpp"
+#include "CactusDeviceMemory.hpp"
+#include "CactusEmbeddingCache.hpp"
+#include "CactusMetrics.hpp"
+#include "CactusModelConfig.hpp"
+#include "CactusModelFiles.hpp"
+#include "CactusModelRegistry.hpp"
+#include "CactusResponseJson.hpp"
+#include "CactusStopSequenceMatcher.hpp"
+#include "CactusToolCallValidator.hpp"
+#include "CactusUtf8Decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sys/resource.h>
 
 namespace margelo::nitro::cactus {
+
+namespace {
+
+// Memory allocated since privateBytes was measured, which is an estimate
+// while other models run on other threads
+size_t privateMemoryGrowth(size_t privateBytes) {
+  const size_t now = privateMemoryBytes();
+  return now > privateBytes ? now - privateBytes : 0;
+}
+
+// Picks the longest context whose cache fits next to the weights in the
+// memory currently available
+size_t autoContextSize(const std::optional<CactusModelConfig> &config,
+                       size_t weightBytes) {
+  constexpr size_t minContextSize = 512;
+  constexpr size_t fallbackContextSize = 2048;
+
+  const size_t available = availableMemoryBytes();
+  if (!config || !available) {
+    return fallbackContextSize;
+  }
+
+  // Leave half of what remains for activations and the rest of the app
+  const size_t budget =
+      available > weightBytes ? (available - weightBytes) / 2 : 0;
+  return std::max(config->contextSizeFitting(budget), minContextSize);
+}
+
+// Sets an environment variable for the lifetime of the object. Only used
+// while cactusInitMutex is held.
+class ScopedEnvironment {
+public:
+  ScopedEnvironment(const char *name, std::optional<size_t> value)
+      : _name(name) {
+    if (!value) {
+      return;
+    }
+    if (const char *previous = getenv(name)) {
+      _previous = previous;
+    }
+    _set = true;
+    setenv(name, std::to_string(*value).c_str(), 1);
+  }
+
+  ~ScopedEnvironment() {
+    if (!_set) {
+      return;
+    }
+    if (_previous) {
+      setenv(_name, _previous->c_str(), 1);
+    } else {
+      unsetenv(_name);
+    }
+  }
+
+private:
+  const char *_name;
+  std::optional<std::string> _previous;
+  bool _set = false;
+};
+
+// Traces a model operation and records its latency, queue wait, page faults
+// and the number of cores it kept busy
+class OperationSpan {
+public:
+  using Clock = CactusTraceRecorder::Clock;
+
+  OperationSpan(CactusTraceRecorder &trace, const char *name,
+                double queueWaitMs)
+      : _trace(trace), _name(name), _start(Clock::now()) {
+    const auto queueWait = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(queueWaitMs));
+    trace.add("queue_wait", "scheduler", _start - queueWait, _start);
+    CactusMetrics::shared().histogram("queue_wait_ms").record(queueWaitMs);
+    getrusage(RUSAGE_SELF, &_usage);
+  }
+
+  ~OperationSpan() {
+    const auto end = Clock::now();
+    _trace.add(_name, "model", _start, end);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const double ms =
+        std::chrono::duration<double, std::milli>(end - _start).count();
+    auto &metrics = CactusMetrics::shared();
+    metrics.histogram(std::string(_name) + "_ms").record(ms);
+    metrics.counter("major_page_faults")
+        .add(usage.ru_majflt - _usage.ru_majflt);
+    metrics.counter("minor_page_faults")
+        .add(usage.ru_minflt - _usage.ru_minflt);
+    if (ms > 0) {
+      const double cpuMs = cpuTimeMs(usage) - cpuTimeMs(_usage);
+      metrics.histogram("cpu_cores").record(cpuMs / ms);
+    }
+  }
+
+private:
+  CactusTraceRecorder &_trace;
+  const char *_name;
+  const Clock::time_point _start;
+  struct rusage _usage;
+
+  static double cpuTimeMs(const struct rusage &usage) {
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+  }
+};
+
+// Per token latencies of a completion or transcription
+void recordGeneration(const std::string &responseJson) {
+  auto &metrics = CactusMetrics::shared();
+  const double timeToFirstTokenMs =
+      responseNumber(responseJson, "time_to_first_token_ms");
+  const double prefillTokens = responseNumber(responseJson, "prefill_tokens");
+  const double tokensPerSecond =
+      responseNumber(responseJson, "tokens_per_second");
+
+  metrics.histogram("time_to_first_token_ms").record(timeToFirstTokenMs);
+  if (prefillTokens > 0) {
+    metrics.histogram("prefill_ms_per_token")
+        .record(timeToFirstTokenMs / prefillTokens);
+  }
+  if (tokensPerSecond > 0) {
+    metrics.histogram("decode_ms_per_token").record(1000 / tokensPerSecond);
+  }
+  metrics.counter("decode_tokens")
+      .add(responseNumber(responseJson, "decode_tokens"));
+}
+
+// Per token work of a completion or transcription, passed to the engine as
+// its token callback. Decodes the pieces into whole characters, hands them to
+// the token stream and the callback, stops the engine on a stop sequence,
+// stop or timeout, records the trace and applies the thermal governor.
+class GenerationTokens {
+public:
+  using Callback = std::function<void(const std::string & /* token */,
+                                      double /* tokenId */)>;
+
+  GenerationTokens(const std::optional<Callback> &callback,
+                   CactusTokenStream *tokenStream, CactusTraceRecorder &trace,
+                   CactusThermalGovernor &governor,
+                   CactusStopSequenceMatcher &stops,
+                   CactusCancellation &cancellation,
+                   const CactusCancellation::Request &request,
+                   cactus_model_t model)
+      : _callback(callback && *callback ? &*callback : nullptr),
+        _tokenStream(tokenStream), _trace(trace), _governor(governor),
+        _stops(stops.enabled() ? &stops : nullptr),
+        _cancellation(cancellation), _request(request), _model(model),
+        _lastToken(CactusTraceRecorder::Clock::now()) {}
+
+  static void onToken(const char *token, uint32_t tokenId, void *userData) {
+    if (userData) {
+      static_cast<GenerationTokens *>(userData)->add(token, tokenId);
+    }
+  }
+
+  // Passes on what the decoder still holds once the engine returns, then
+  // ends the stream
+  void finish() {
+    const std::string &rest = _utf8.flush();
+    if (!rest.empty()) {
+      if (_tokenStream) {
+        _tokenStream->push(rest);
+      }
+      if (_callback) {
+        (*_callback)(rest, _lastTokenId);
+      }
+    }
+    if (_tokenStream) {
+      _tokenStream->finish();
+    }
+  }
+
+  bool timedOut() const { return _timedOut; }
+
+private:
+  const Callback *_callback;
+  CactusTokenStream *_tokenStream;
+  CactusTraceRecorder &_trace;
+  CactusThermalGovernor &_governor;
+  CactusStopSequenceMatcher *_stops;
+  CactusCancellation &_cancellation;
+  const CactusCancellation::Request &_request;
+  cactus_model_t _model;
+  CactusUtf8Decoder _utf8;
+  CactusTraceRecorder::Clock::time_point _lastToken;
+  bool _decoding = false;
+  bool _stopping = false;
+  bool _timedOut = false;
+  uint32_t _lastTokenId = 0;
+
+  void add(const char *token, uint32_t tokenId) {
+    const std::string &piece = _utf8.feed(token);
+    _lastTokenId = tokenId;
+    if (_tokenStream && !piece.empty()) {
+      _tokenStream->push(piece);
+    }
+    if (_stops && _stops->feed(piece)) {
+      _stops = nullptr;
+      cactus_stop(_model);
+    }
+    // Checked on every token, as the engine may miss a stop that arrives
+    // before it starts decoding
+    if (!_stopping) {
+      _timedOut = _cancellation.expired(_request);
+      if (_timedOut || _cancellation.stopped(_request)) {
+        _stopping = true;
+        cactus_stop(_model);
+      }
+    }
+    if (_trace.enabled()) {
+      const auto now = CactusTraceRecorder::Clock::now();
+      _trace.add(_decoding ? "decode" : "prefill", "token", _lastToken, now);
+      _lastToken = now;
+      _decoding = true;
+    }
+    _governor.throttle();
+    // A token that only starts a character is passed on with the next one
+    if (!piece.empty() && _callback) {
+      (*_callback)(piece, tokenId);
+    }
+  }
+};
+
+std::shared_ptr<ArrayBuffer> wrapFloats(std::vector<float> &&floats) {
+  auto *owned = new std::vector<float>(std::move(floats));
+  return ArrayBuffer::wrap(reinterpret_cast<uint8_t *>(owned->data()),
+                           owned->size() * sizeof(float),
+                           [owned]() { delete owned; });
+}
+
+} // namespace
+
 HybridCactus::HybridCactus() : HybridObject(TAG) {}
 
-std::shared_ptr<Promise<void>>
+HybridCactus::~HybridCactus() { CactusModelRegistry::shared().release(this); }
+
+bool HybridCactus::extendsCachedMessages(
+    const std::string &messagesJson) const {
+  // The engine keeps the tokens of the previous turn in its KV cache and only
+  // prefills the new suffix, which only holds while the history is appended to
+  if (this->_cachedMessagesJson.empty() ||
+      this->_cachedMessagesJson.back() != ']') {
+    return false;
+  }
+  const size_t prefixLength = this->_cachedMessagesJson.size() - 1;
+  return messagesJson.size() > prefixLength &&
+         messagesJson.compare(0, prefixLength, this->_cachedMessagesJson, 0,
+                              prefixLength) == 0 &&
+         (messagesJson[prefixLength] == ',' ||
+          messagesJson[prefixLength] == ']');
+}
+
+void HybridCactus::resetPrefixCache() {
+  this->_cachedMessagesJson.clear();
+  this->_predictedPrefixCacheHits = 0;
+  this->_predictedPrefixCacheMisses = 0;
+}
+
+void HybridCactus::evictParkedSessions() {
+  const size_t maxParkedSessions =
+      this->_sessionBytes
+          ? std::min(this->_maxSessions - 1,
+                     this->_sessionMemoryBudget / this->_sessionBytes)
+          : this->_maxSessions - 1;
+
+  while (this->_parkedSessions.size() > maxParkedSessions) {
+    cactus_destroy(this->_parkedSessions.back().model);
+    this->_parkedSessions.pop_back();
+  }
+}
+
+// The weights are mapped from the model files and shared by every handle on
+// them, so only the sessions are charged here
+size_t HybridCactus::residentBytes() const {
+  return this->_sessionBytes * (1 + this->_parkedSessions.size());
+}
+
+void HybridCactus::updateResidency() {
+  CactusModelRegistry::shared().acquire(
+      this, this->_modelPath, this->_weightBytes, this->residentBytes(),
+      [this]() { return this->tryUnload(); },
+      [this]() { return this->shedMemory(); });
+}
+
+std::optional<size_t> HybridCactus::shedMemory() {
+  std::unique_lock<CactusModelScheduler> lock(this->_scheduler,
+                                            std::try_to_lock);
+
+  if (!lock.owns_lock()) {
+    return std::nullopt;
+  }
+
+  // Parked sessions are prefilled again when they are switched back to
+  for (const auto &session : this->_parkedSessions) {
+    cactus_destroy(session.model);
+  }
+  this->_parkedSessions.clear();
+  this->_responseBuffer.release();
+
+  return this->residentBytes();
+}
+
+cactus_model_t HybridCactus::openModel() const {
+  // The engine reads the cache window from the environment while a model is
+  // initialized and takes it nowhere else. Every model of the process is
+  // opened here, so no other initialization reads the variables while they
+  // change.
+  static std::mutex cactusInitMutex;
+  std::lock_guard<std::mutex> lock(cactusInitMutex);
+
+  ScopedEnvironment windowSize("CACTUS_KV_WINDOW_SIZE",
+                               this->_cacheWindow.windowSize);
+  ScopedEnvironment sinkSize("CACTUS_KV_SINK_SIZE",
+                             this->_cacheWindow.sinkSize);
+
+  return cactus_init(this->_modelPath.c_str(), this->_contextSize,
+                     this->_corpusDir ? this->_corpusDir->c_str() : nullptr);
+}
+
+void HybridCactus::ensureModelLoaded() {
+  if (!this->_model && this->_unloaded) {
+    this->_model = this->openModel();
+
+    if (!this->_model) {
+      throw std::runtime_error("Failed to reload Cactus model");
+    }
+
+    this->_unloaded = false;
+  }
+
+  if (!this->_model) {
+    throw std::runtime_error("Cactus model is not initialized");
+  }
+
+  this->updateResidency();
+}
+
+void HybridCactus::unloadModel() {
+  cactus_destroy(this->_model);
+  this->_model = nullptr;
+  this->resetPrefixCache();
+
+  for (const auto &session : this->_parkedSessions) {
+    cactus_destroy(session.model);
+  }
+  this->_parkedSessions.clear();
+}
+
+bool HybridCactus::tryUnload() {
+  std::unique_lock<CactusModelScheduler> lock(this->_scheduler,
+                                            std::try_to_lock);
+
+  if (!lock.owns_lock() || !this->_model) {
+    return false;
+  }
+
+  this->unloadModel();
+  this->_unloaded = true;
+  return true;
+}
+
+std::shared_ptr<Promise<double>>
 HybridCactus::init(const std::string &modelPath, double contextSize,
-                   const std::optional<std::string> &corpusDir) {
-  return Promise<void>::async(
-      [this, modelPath, contextSize, corpusDir]() -> void {
-        std::lock_guard<std::mutex> lock(this->_modelMutex);
+                   const std::optional<std::string> &corpusDir,
+                   std::optional<double> kvWindowSize,
+                   std::optional<double> kvSinkSize) {
+  return Promise<double>::async(
+      [this, modelPath, contextSize, corpusDir, kvWindowSize,
+       kvSinkSize]() -> double {
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Interactive);
 
-        if (this->_model) {
+        if (this->_model || this->_unloaded) {
           throw std::runtime_error("Cactus model is already initialized");
         }
 
-        const cactus_model_t model =
-            cactus_init(modelPath.c_str(), contextSize,
-                        corpusDir ? corpusDir->c_str() : nullptr);
+        const auto cacheWindow =
+            CactusCacheWindow::from(kvWindowSize, kvSinkSize);
+
+        const auto config = CactusModelConfig::fromModelPath(modelPath);
+        const size_t weightBytes = modelFileBytes(modelPath);
+
+        this->_contextSize =
+            contextSize > 0 ? static_cast<size_t>(contextSize)
+                            : autoContextSize(config, weightBytes);
+        this->_modelPath = modelPath;
+        this->_corpusDir = corpusDir;
+        this->_cacheWindow = cacheWindow;
+
+        // Ends the load progress on every way out of init, so a failed
+        // load reports 0 and a successful one never drops before 1
+        struct LoadEnd {
+          CactusLoadProgress &progress;
+          bool loaded = false;
+          ~LoadEnd() { progress.end(loaded); }
+        } loadEnd{this->_loadProgress};
+        this->_loadProgress.begin(modelPath);
+        prefetchModelFiles(modelPath);
+
+        const size_t privateBytes = privateMemoryBytes();
+        const cactus_model_t model = this->openModel();
 
         if (!model) {
           throw std::runtime_error("Failed to initialize Cactus model");
         }
 
         this->_model = model;
-        this->_contextSize = contextSize;
+        loadEnd.loaded = true;
+
+        // Every handle is a full engine instance with its own graph, buffer
+        // pool and tokenizer next to the KV cache it fills as it generates
+        this->_kvCacheBytes =
+            config ? config->kvCacheBytes(this->_contextSize) : 0;
+        this->_sessionBytes =
+            this->_kvCacheBytes + privateMemoryGrowth(privateBytes);
+        this->_weightBytes = weightBytes;
+
+        this->updateResidency();
+
+        return static_cast<double>(this->_contextSize);
       });
 }
 
@@ -32,44 +451,103 @@ std::shared_ptr<Promise<std::string>> HybridCactus::complete(
     const std::optional<std::string> &optionsJson,
     const std::optional<std::string> &toolsJson,
     const std::optional<std::function<void(const std::string & /* token */,
-                                           double /* tokenId */)>> &callback) {
-  return Promise<std::string>::async([this, messagesJson, optionsJson,
-                                      toolsJson, callback,
+                                           double /* tokenId */)>> &callback,
+    std::optional<double> tokenStreamId) {
+  const auto request = this->_cancellation.issue(optionsJson);
+  auto tokenStream = this->tokenStream(tokenStreamId);
+  return Promise<std::string>::async([this, request, messagesJson, optionsJson,
+                                      toolsJson, callback, tokenStream,
                                       responseBufferSize]() -> std::string {
-    std::lock_guard<std::mutex> lock(this->_modelMutex);
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
+    OperationSpan span(this->_trace, "complete", lock.waitMs());
 
-    if (!this->_model) {
-      throw std::runtime_error("Cactus model is not initialized");
+    if (this->_cancellation.stopped(request)) {
+      throw std::runtime_error("Cactus completion was stopped");
+    }
+    if (this->_cancellation.expired(request)) {
+      throw std::runtime_error("Cactus completion timed out");
     }
 
-    struct CallbackCtx {
-      const std::function<void(const std::string & /* token */,
-                               double /* tokenId */)> *callback;
-    } callbackCtx{callback.has_value() ? &callback.value() : nullptr};
+    this->ensureModelLoaded();
+
+    // Tools are usually the same on every turn, so they are only parsed
+    // again when they change
+    if (toolsJson.value_or("") != this->_toolsJson) {
+      this->_toolsJson = toolsJson.value_or("");
+      this->_tools = CactusToolCallValidator(this->_toolsJson);
+    }
+
+    CactusStopSequenceMatcher stops(
+        CactusStopSequenceMatcher::sequencesOf(optionsJson.value_or("")));
+
+    GenerationTokens tokens(callback, tokenStream.get(), this->_trace,
+                            this->_governor, stops, this->_cancellation,
+                            request, this->_model);
+
+    // Predicted from the messages, the engine does not report whether it
+    // reused its KV cache
+    const bool predictedPrefixCacheHit =
+        this->extendsCachedMessages(messagesJson);
+
+    char *const responseScratch =
+        this->_responseBuffer.prepare(responseBufferSize);
 
-    auto cactusTokenCallback = [](const char *token, uint32_t tokenId,
-                                  void *userData) {
-      auto *callbackCtx = static_cast<CallbackCtx *>(userData);
-      if (!callbackCtx || !callbackCtx->callback || !(*callbackCtx->callback))
-        return;
-      (*callbackCtx->callback)(token, tokenId);
-    };
+    this->_governor.begin();
 
-    std::string responseBuffer;
-    responseBuffer.resize(responseBufferSize);
+    // Only known again once the completion succeeds
+    this->_cachedMessagesJson.clear();
 
+    this->_cancellation.begin(request, this->_model);
     int result = cactus_complete(this->_model, messagesJson.c_str(),
-                                 responseBuffer.data(), responseBufferSize,
+                                 responseScratch, responseBufferSize,
                                  optionsJson ? optionsJson->c_str() : nullptr,
                                  toolsJson ? toolsJson->c_str() : nullptr,
-                                 cactusTokenCallback, &callbackCtx);
+                                 GenerationTokens::onToken, &tokens);
+    this->_cancellation.end();
+    tokens.finish();
 
     if (result < 0) {
       throw std::runtime_error("Cactus completion failed");
     }
 
-    // Remove null terminator
-    responseBuffer.resize(strlen(responseBuffer.c_str()));
+    std::string responseBuffer = this->_responseBuffer.take(responseBufferSize);
+
+    this->_governor.end(responseNumber(responseBuffer, "tokens_per_second"));
+    insertResponseFields(responseBuffer, this->_governor.responseFields());
+    recordGeneration(responseBuffer);
+    this->_latency.observe(responseBuffer);
+    const std::string toolCallError =
+        this->_tools.enabled() ? this->_tools.check(responseBuffer) : "";
+    if (!toolCallError.empty()) {
+      insertResponseFields(responseBuffer, "\"tool_call_error\":" +
+                                               jsonString(toolCallError));
+      CactusMetrics::shared().counter("tool_call_errors").add();
+    }
+    if (tokens.timedOut()) {
+      insertResponseFields(responseBuffer, "\"timed_out\":true");
+      CactusMetrics::shared().counter("timeouts").add();
+    }
+
+    this->_cachedMessagesJson = messagesJson;
+    if (predictedPrefixCacheHit) {
+      this->_predictedPrefixCacheHits++;
+    } else {
+      this->_predictedPrefixCacheMisses++;
+    }
+    CactusMetrics::shared()
+        .counter(predictedPrefixCacheHit ? "predicted_prefix_cache_hits"
+                                         : "predicted_prefix_cache_misses")
+        .add();
+    insertResponseFields(
+        responseBuffer,
+        "\"queue_wait_ms\":" + std::to_string(lock.waitMs()) +
+            ",\"predicted_prefix_cache_hit\":" +
+            (predictedPrefixCacheHit ? "true" : "false") +
+            ",\"predicted_prefix_cache_hits\":" +
+            std::to_string(this->_predictedPrefixCacheHits) +
+            ",\"predicted_prefix_cache_misses\":" +
+            std::to_string(this->_predictedPrefixCacheMisses));
 
     return responseBuffer;
   });
@@ -79,60 +557,104 @@ std::shared_ptr<Promise<std::string>> HybridCactus::transcribe(
     const std::string &audioFilePath, const std::string &prompt,
     double responseBufferSize, const std::optional<std::string> &optionsJson,
     const std::optional<std::function<void(const std::string & /* token */,
-                                           double /* tokenId */)>> &callback) {
-  return Promise<std::string>::async([this, audioFilePath, prompt, optionsJson,
-                                      callback,
+                                           double /* tokenId */)>> &callback,
+    std::optional<double> tokenStreamId) {
+  const auto request = this->_cancellation.issue(optionsJson);
+  auto tokenStream = this->tokenStream(tokenStreamId);
+  return Promise<std::string>::async([this, request, audioFilePath, prompt,
+                                      optionsJson, callback, tokenStream,
                                       responseBufferSize]() -> std::string {
-    std::lock_guard<std::mutex> lock(this->_modelMutex);
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
+    OperationSpan span(this->_trace, "transcribe", lock.waitMs());
 
-    if (!this->_model) {
-      throw std::runtime_error("Cactus model is not initialized");
+    if (this->_cancellation.stopped(request)) {
+      throw std::runtime_error("Cactus transcription was stopped");
     }
+    if (this->_cancellation.expired(request)) {
+      throw std::runtime_error("Cactus transcription timed out");
+    }
+
+    this->ensureModelLoaded();
 
-    struct CallbackCtx {
-      const std::function<void(const std::string & /* token */,
-                               double /* tokenId */)> *callback;
-    } callbackCtx{callback.has_value() ? &callback.value() : nullptr};
+    CactusStopSequenceMatcher stops(
+        CactusStopSequenceMatcher::sequencesOf(optionsJson.value_or("")));
 
-    auto cactusTokenCallback = [](const char *token, uint32_t tokenId,
-                                  void *userData) {
-      auto *callbackCtx = static_cast<CallbackCtx *>(userData);
-      if (!callbackCtx || !callbackCtx->callback || !(*callbackCtx->callback))
-        return;
-      (*callbackCtx->callback)(token, tokenId);
-    };
+    GenerationTokens tokens(callback, tokenStream.get(), this->_trace,
+                            this->_governor, stops, this->_cancellation,
+                            request, this->_model);
 
-    std::string responseBuffer;
-    responseBuffer.resize(responseBufferSize);
+    // Transcription runs on the same KV cache, so the next completion cannot
+    // reuse the previous conversation
+    this->_cachedMessagesJson.clear();
 
+    char *const responseScratch =
+        this->_responseBuffer.prepare(responseBufferSize);
+
+    this->_governor.begin();
+
+    this->_cancellation.begin(request, this->_model);
     int result =
         cactus_transcribe(this->_model, audioFilePath.c_str(), prompt.c_str(),
-                          responseBuffer.data(), responseBufferSize,
+                          responseScratch, responseBufferSize,
                           optionsJson ? optionsJson->c_str() : nullptr,
-                          cactusTokenCallback, &callbackCtx);
+                          GenerationTokens::onToken, &tokens);
+    this->_cancellation.end();
+    tokens.finish();
 
     if (result < 0) {
       throw std::runtime_error("Cactus transcription failed");
     }
 
-    // Remove null terminator
-    responseBuffer.resize(strlen(responseBuffer.c_str()));
+    std::string responseBuffer = this->_responseBuffer.take(responseBufferSize);
+
+    this->_governor.end(responseNumber(responseBuffer, "tokens_per_second"));
+    insertResponseFields(responseBuffer, this->_governor.responseFields());
+    recordGeneration(responseBuffer);
+    if (tokens.timedOut()) {
+      insertResponseFields(responseBuffer, "\"timed_out\":true");
+      CactusMetrics::shared().counter("timeouts").add();
+    }
+    insertResponseFields(responseBuffer, "\"queue_wait_ms\":" +
+                                             std::to_string(lock.waitMs()));
 
     return responseBuffer;
   });
 }
 
+void HybridCactus::transcribeStreamPush(
+    const std::shared_ptr<ArrayBuffer> &pcm) {
+  this->_audioStream.push(reinterpret_cast<const float *>(pcm->data()),
+                          pcm->size() / sizeof(float));
+}
+
+std::shared_ptr<Promise<double>>
+HybridCactus::transcribeStreamWrite(const std::string &wavPath, bool commit) {
+  return Promise<double>::async([this, wavPath, commit]() -> double {
+    return static_cast<double>(this->_audioStream.write(wavPath, commit));
+  });
+}
+
+void HybridCactus::transcribeStreamClear() { this->_audioStream.clear(); }
+
 std::shared_ptr<Promise<std::vector<double>>>
 HybridCactus::embed(const std::string &text, double embeddingBufferSize) {
   return Promise<std::vector<double>>::async(
       [this, text, embeddingBufferSize]() -> std::vector<double> {
-        std::lock_guard<std::mutex> lock(this->_modelMutex);
-
-        if (!this->_model) {
-          throw std::runtime_error("Cactus model is not initialized");
+        const auto cache = this->embeddingCache();
+        std::vector<float> embeddingBuffer;
+        if (cache && cache->find(text, embeddingBuffer)) {
+          return std::vector<double>(embeddingBuffer.begin(),
+                                     embeddingBuffer.end());
         }
 
-        std::vector<float> embeddingBuffer(embeddingBufferSize);
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Embedding);
+        OperationSpan span(this->_trace, "embed", lock.waitMs());
+
+        this->ensureModelLoaded();
+
+        embeddingBuffer.resize(embeddingBufferSize);
         size_t embeddingDim;
 
         int result =
@@ -144,22 +666,107 @@ HybridCactus::embed(const std::string &text, double embeddingBufferSize) {
         }
 
         embeddingBuffer.resize(embeddingDim);
+        if (cache) {
+          cache->insert(text, embeddingBuffer.data(), embeddingDim);
+        }
 
         return std::vector<double>(embeddingBuffer.begin(),
                                    embeddingBuffer.end());
       });
 }
 
+std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+HybridCactus::embedBatch(const std::vector<std::string> &texts,
+                         double embeddingBufferSize) {
+  return Promise<std::shared_ptr<ArrayBuffer>>::async(
+      [this, texts,
+       embeddingBufferSize]() -> std::shared_ptr<ArrayBuffer> {
+        const size_t bufferSize = embeddingBufferSize;
+
+        // Every embedding is written straight into its slot of one contiguous
+        // buffer, which is sized from the dimension of the first embedding
+        std::vector<float> embeddings;
+        size_t embeddingDim = 0;
+
+        // Cached texts are filled in first, without waiting for the model
+        const auto cache = this->embeddingCache();
+        std::vector<size_t> misses;
+        std::vector<float> cached;
+        for (size_t i = 0; i < texts.size(); i++) {
+          if (!cache || !cache->find(texts[i], cached)) {
+            misses.push_back(i);
+            continue;
+          }
+          if (embeddingDim == 0) {
+            embeddingDim = cached.size();
+            embeddings.resize(texts.size() * embeddingDim);
+          } else if (cached.size() != embeddingDim) {
+            throw std::runtime_error(
+                "Cactus embeddings have inconsistent dimensions");
+          }
+          std::copy(cached.begin(), cached.end(),
+                    embeddings.begin() + i * embeddingDim);
+        }
+        if (misses.empty()) {
+          return wrapFloats(std::move(embeddings));
+        }
+
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Background);
+        OperationSpan span(this->_trace, "embedBatch", lock.waitMs());
+
+        this->ensureModelLoaded();
+
+        if (embeddingDim == 0) {
+          embeddings.resize(bufferSize);
+        }
+
+        for (const size_t i : misses) {
+          // Interactive requests are served between texts of a batch
+          if (i != misses.front() && lock.yield()) {
+            this->ensureModelLoaded();
+          }
+
+          const bool first = embeddingDim == 0;
+          const size_t slotSize = first ? bufferSize : embeddingDim;
+          size_t dim;
+
+          int result = cactus_embed(
+              this->_model, texts[i].c_str(),
+              embeddings.data() + i * embeddingDim, slotSize * sizeof(float),
+              &dim);
+
+          if (result < 0) {
+            throw std::runtime_error("Cactus embedding failed");
+          }
+
+          if (first) {
+            embeddingDim = dim;
+            embeddings.resize(texts.size() * embeddingDim);
+          } else if (dim != embeddingDim) {
+            throw std::runtime_error(
+                "Cactus embeddings have inconsistent dimensions");
+          }
+
+          if (cache) {
+            cache->insert(texts[i], embeddings.data() + i * embeddingDim, dim);
+          }
+        }
+
+        return wrapFloats(std::move(embeddings));
+      });
+}
+
 std::shared_ptr<Promise<std::vector<double>>>
 HybridCactus::imageEmbed(const std::string &imagePath,
                          double embeddingBufferSize) {
   return Promise<std::vector<double>>::async(
       [this, imagePath, embeddingBufferSize]() -> std::vector<double> {
-        std::lock_guard<std::mutex> lock(this->_modelMutex);
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Embedding);
+        OperationSpan span(this->_trace, "imageEmbed", lock.waitMs());
 
-        if (!this->_model) {
-          throw std::runtime_error("Cactus model is not initialized");
-        }
+        this->ensureModelLoaded();
 
         std::vector<float> embeddingBuffer(embeddingBufferSize);
         size_t embeddingDim;
@@ -184,11 +791,11 @@ HybridCactus::audioEmbed(const std::string &audioPath,
                          double embeddingBufferSize) {
   return Promise<std::vector<double>>::async(
       [this, audioPath, embeddingBufferSize]() -> std::vector<double> {
-        std::lock_guard<std::mutex> lock(this->_modelMutex);
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Embedding);
+        OperationSpan span(this->_trace, "audioEmbed", lock.waitMs());
 
-        if (!this->_model) {
-          throw std::runtime_error("Cactus model is not initialized");
-        }
+        this->ensureModelLoaded();
 
         std::vector<float> embeddingBuffer(embeddingBufferSize);
         size_t embeddingDim;
@@ -208,32 +815,366 @@ HybridCactus::audioEmbed(const std::string &audioPath,
       });
 }
 
+std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+HybridCactus::embedFloat32(const std::string &text,
+                           double embeddingBufferSize) {
+  return Promise<std::shared_ptr<ArrayBuffer>>::async(
+      [this, text, embeddingBufferSize]() -> std::shared_ptr<ArrayBuffer> {
+        const auto cache = this->embeddingCache();
+        std::vector<float> embeddingBuffer;
+        if (cache && cache->find(text, embeddingBuffer)) {
+          return wrapFloats(std::move(embeddingBuffer));
+        }
+
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Embedding);
+        OperationSpan span(this->_trace, "embedFloat32", lock.waitMs());
+
+        this->ensureModelLoaded();
+
+        embeddingBuffer.resize(embeddingBufferSize);
+        size_t embeddingDim;
+
+        int result = cactus_embed(
+            this->_model, text.c_str(), embeddingBuffer.data(),
+            embeddingBufferSize * sizeof(float), &embeddingDim);
+
+        if (result < 0) {
+          throw std::runtime_error("Cactus embedding failed");
+        }
+
+        embeddingBuffer.resize(embeddingDim);
+        if (cache) {
+          cache->insert(text, embeddingBuffer.data(), embeddingDim);
+        }
+
+        return wrapFloats(std::move(embeddingBuffer));
+      });
+}
+
+std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+HybridCactus::imageEmbedFloat32(const std::string &imagePath,
+                                double embeddingBufferSize) {
+  return Promise<std::shared_ptr<ArrayBuffer>>::async(
+      [this, imagePath, embeddingBufferSize]() -> std::shared_ptr<ArrayBuffer> {
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Embedding);
+        OperationSpan span(this->_trace, "imageEmbedFloat32", lock.waitMs());
+
+        this->ensureModelLoaded();
+
+        std::vector<float> embeddingBuffer(embeddingBufferSize);
+        size_t embeddingDim;
+
+        int result = cactus_image_embed(
+            this->_model, imagePath.c_str(), embeddingBuffer.data(),
+            embeddingBufferSize * sizeof(float), &embeddingDim);
+
+        if (result < 0) {
+          throw std::runtime_error("Cactus image embedding failed");
+        }
+
+        embeddingBuffer.resize(embeddingDim);
+
+        return wrapFloats(std::move(embeddingBuffer));
+      });
+}
+
+std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+HybridCactus::audioEmbedFloat32(const std::string &audioPath,
+                                double embeddingBufferSize) {
+  return Promise<std::shared_ptr<ArrayBuffer>>::async(
+      [this, audioPath, embeddingBufferSize]() -> std::shared_ptr<ArrayBuffer> {
+        CactusModelScheduler::Guard lock(
+            this->_scheduler, CactusModelScheduler::Priority::Embedding);
+        OperationSpan span(this->_trace, "audioEmbedFloat32", lock.waitMs());
+
+        this->ensureModelLoaded();
+
+        std::vector<float> embeddingBuffer(embeddingBufferSize);
+        size_t embeddingDim;
+
+        int result = cactus_audio_embed(
+            this->_model, audioPath.c_str(), embeddingBuffer.data(),
+            embeddingBufferSize * sizeof(float), &embeddingDim);
+
+        if (result < 0) {
+          throw std::runtime_error("Cactus audio embedding failed");
+        }
+
+        embeddingBuffer.resize(embeddingDim);
+
+        return wrapFloats(std::move(embeddingBuffer));
+      });
+}
+
+std::shared_ptr<Promise<std::string>> HybridCactus::benchmark(
+    const std::vector<double> &prefillLengths,
+    const std::vector<double> &decodeLengths,
+    const std::vector<double> &embeddingBatchSizes, double iterations,
+    const std::optional<std::string> &imagePath,
+    const std::optional<std::string> &audioPath) {
+  const auto options =
+      CactusBenchmarkOptions::from(prefillLengths, decodeLengths,
+                                   embeddingBatchSizes, iterations, imagePath,
+                                   audioPath);
+  return Promise<std::string>::async([this, options]() -> std::string {
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Background);
+
+    this->ensureModelLoaded();
+
+    // The benchmark resets the KV cache between runs
+    this->resetPrefixCache();
+
+    const std::string report =
+        CactusBenchmark(this->_model, this->_contextSize).run(options);
+    this->_latency.calibrate(report);
+    return report;
+  });
+}
+
 std::shared_ptr<Promise<void>> HybridCactus::reset() {
   return Promise<void>::async([this]() -> void {
-    std::lock_guard<std::mutex> lock(this->_modelMutex);
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
 
-    if (!this->_model) {
-      throw std::runtime_error("Cactus model is not initialized");
+    // An unloaded model is reopened with a fresh state anyway
+    if (this->_unloaded) {
+      return;
     }
 
+    this->ensureModelLoaded();
+
     cactus_reset(this->_model);
+    this->resetPrefixCache();
   });
 }
 
 std::shared_ptr<Promise<void>> HybridCactus::stop() {
-  return Promise<void>::async([this]() -> void { cactus_stop(this->_model); });
+  const uint64_t ticket = this->_cancellation.lastTicket();
+  return Promise<void>::async(
+      [this, ticket]() -> void { this->_cancellation.stop(ticket); });
 }
 
+std::shared_ptr<Promise<void>> HybridCactus::prefetchWeights() {
+  return Promise<void>::async([this]() -> void {
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
+
+    if (this->_model) {
+      prefetchModelFiles(this->_modelPath);
+    }
+  });
+}
+
+double HybridCactus::openTokenStream() {
+  std::lock_guard<std::mutex> lock(this->_tokenStreamsMutex);
+  const uint64_t id = ++this->_lastTokenStream;
+  this->_tokenStreams[id] = std::make_shared<CactusTokenStream>();
+  return static_cast<double>(id);
+}
+
+std::string HybridCactus::drainTokens(double tokenStream) {
+  const auto stream = this->tokenStream(tokenStream);
+  return stream ? stream->drain() : "";
+}
+
+void HybridCactus::closeTokenStream(double tokenStream) {
+  std::lock_guard<std::mutex> lock(this->_tokenStreamsMutex);
+  this->_tokenStreams.erase(static_cast<uint64_t>(tokenStream));
+}
+
+std::shared_ptr<CactusTokenStream>
+HybridCactus::tokenStream(std::optional<double> tokenStream) {
+  if (!tokenStream) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(this->_tokenStreamsMutex);
+  const auto it = this->_tokenStreams.find(static_cast<uint64_t>(*tokenStream));
+  return it == this->_tokenStreams.end() ? nullptr : it->second;
+}
+
+double HybridCactus::getLoadProgress() {
+  return this->_loadProgress.progress();
+}
+
+void HybridCactus::setTracingEnabled(bool enabled) {
+  this->_trace.setEnabled(enabled);
+}
+
+std::string HybridCactus::takeTrace() { return this->_trace.take(); }
+
+void HybridCactus::setThermalGovernorEnabled(bool enabled) {
+  this->_governor.setEnabled(enabled);
+}
+
+std::string HybridCactus::predictLatency(const std::string &messagesJson,
+                                         double maxTokens) {
+  return this->_latency.predict(messagesJson, maxTokens);
+}
+
+double HybridCactus::getQueueDepth() { return this->_scheduler.queueDepth(); }
+
 std::shared_ptr<Promise<void>> HybridCactus::destroy() {
   return Promise<void>::async([this]() -> void {
-    std::lock_guard<std::mutex> lock(this->_modelMutex);
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
 
-    if (!this->_model) {
+    if (!this->_model && !this->_unloaded) {
       throw std::runtime_error("Cactus model is not initialized");
     }
 
-    cactus_destroy(this->_model);
-    this->_model = nullptr;
+    if (this->_model) {
+      this->unloadModel();
+    }
+    this->_unloaded = false;
+    this->_sessionId = "default";
+    this->_loadProgress.end(false);
+
+    CactusModelRegistry::shared().release(this);
+  });
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactus::setSession(const std::string &sessionId) {
+  return Promise<void>::async([this, sessionId]() -> void {
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
+
+    this->ensureModelLoaded();
+
+    if (sessionId == this->_sessionId) {
+      return;
+    }
+    if (this->_maxSessions < 2) {
+      throw std::runtime_error(
+          "Cactus sessions are disabled, set maxSessions to enable them");
+    }
+
+    // Every session keeps its own model handle, so switching back to a parked
+    // session reuses its KV cache instead of prefilling the history again.
+    // Weights are mmapped and shared between handles through the page cache.
+    Session next{sessionId, nullptr, ""};
+    const auto parked = std::find_if(
+        this->_parkedSessions.begin(), this->_parkedSessions.end(),
+        [&sessionId](const Session &session) {
+          return session.id == sessionId;
+        });
+
+    if (parked != this->_parkedSessions.end()) {
+      next = std::move(*parked);
+      this->_parkedSessions.erase(parked);
+    } else {
+      const size_t privateBytes = privateMemoryBytes();
+      next.model = this->openModel();
+
+      if (!next.model) {
+        throw std::runtime_error("Failed to initialize Cactus session");
+      }
+      // Measured again next to a loaded handle, which leaves out what the
+      // first handle allocated for the weights
+      this->_sessionBytes =
+          this->_kvCacheBytes + privateMemoryGrowth(privateBytes);
+    }
+
+    this->_parkedSessions.push_front(
+        {this->_sessionId, this->_model, std::move(this->_cachedMessagesJson)});
+
+    this->_sessionId = next.id;
+    this->_model = next.model;
+    this->_cachedMessagesJson = std::move(next.cachedMessagesJson);
+
+    this->evictParkedSessions();
+    this->updateResidency();
+  });
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactus::deleteSession(const std::string &sessionId) {
+  return Promise<void>::async([this, sessionId]() -> void {
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
+
+    if (sessionId == this->_sessionId) {
+      throw std::runtime_error("Cannot delete the active Cactus session");
+    }
+
+    const auto parked = std::find_if(
+        this->_parkedSessions.begin(), this->_parkedSessions.end(),
+        [&sessionId](const Session &session) {
+          return session.id == sessionId;
+        });
+
+    if (parked == this->_parkedSessions.end()) {
+      return;
+    }
+
+    cactus_destroy(parked->model);
+    this->_parkedSessions.erase(parked);
+    this->updateResidency();
+  });
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactus::setEmbeddingCache(const std::optional<std::string> &directory) {
+  return Promise<void>::async([this, directory]() -> void {
+    // The model path changes with init, so it is read under the scheduler.
+    // Opening the cache reads its file and does not need the model.
+    std::string modelPath;
+    {
+      CactusModelScheduler::Guard lock(
+          this->_scheduler, CactusModelScheduler::Priority::Interactive);
+      modelPath = this->_modelPath;
+    }
+
+    auto cache =
+        directory ? CactusEmbeddingCache::open(*directory, modelPath) : nullptr;
+    std::lock_guard<std::mutex> lock(this->_embeddingCacheMutex);
+    this->_embeddingCache = std::move(cache);
+  });
+}
+
+std::shared_ptr<CactusEmbeddingCache> HybridCactus::embeddingCache() {
+  std::lock_guard<std::mutex> lock(this->_embeddingCacheMutex);
+  return this->_embeddingCache;
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactus::setSessionMemoryBudget(double bytes) {
+  return Promise<void>::async([this, bytes]() -> void {
+    if (!(bytes >= 0 && bytes <= kMaxSessionMemoryBudget) ||
+        std::floor(bytes) != bytes) {
+      throw std::runtime_error(
+          "sessionMemoryBudget must be a whole number of bytes");
+    }
+
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
+
+    this->_sessionMemoryBudget = static_cast<size_t>(bytes);
+    this->evictParkedSessions();
+    if (this->_model) {
+      this->updateResidency();
+    }
+  });
+}
+
+std::shared_ptr<Promise<void>> HybridCactus::setMaxSessions(double count) {
+  return Promise<void>::async([this, count]() -> void {
+    if (!(count >= 1 && count <= kMaxSessions) || std::floor(count) != count) {
+      throw std::runtime_error("maxSessions must be a whole number from 1 to " +
+                               std::to_string(kMaxSessions));
+    }
+
+    CactusModelScheduler::Guard lock(
+        this->_scheduler, CactusModelScheduler::Priority::Interactive);
+
+    this->_maxSessions = static_cast<size_t>(count);
+    this->evictParkedSessions();
+    if (this->_model) {
+      this->updateResidency();
+    }
   });
 }
 
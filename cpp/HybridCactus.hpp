@@ -1,55 +1,205 @@
 #pragma once
 #include "HybridCactusSpec.hpp"
 
+#include "CactusAudioStream.hpp"
+#include "CactusCacheWindow.hpp"
+#include "CactusCancellation.hpp"
+#include "CactusEmbeddingCache.hpp"
+#include "CactusLatencyModel.hpp"
+#include "CactusLoadProgress.hpp"
+#include "CactusModelScheduler.hpp"
+#include "CactusResponseBuffer.hpp"
+#include "CactusThermalGovernor.hpp"
+#include "CactusTokenStream.hpp"
+#include "CactusToolCallValidator.hpp"
+#include "CactusTraceRecorder.hpp"
+
 #include "cactus_ffi.h"
 
+#include <atomic>
+#include <list>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace margelo::nitro::cactus {
 
 class HybridCactus : public HybridCactusSpec {
 public:
   HybridCactus();
+  ~HybridCactus() override;
 
-  std::shared_ptr<Promise<void>>
+  std::shared_ptr<Promise<double>>
   init(const std::string &modelPath, double contextSize,
-       const std::optional<std::string> &corpusDir) override;
+       const std::optional<std::string> &corpusDir,
+       std::optional<double> kvWindowSize,
+       std::optional<double> kvSinkSize) override;
 
   std::shared_ptr<Promise<std::string>> complete(
       const std::string &messagesJson, double responseBufferSize,
       const std::optional<std::string> &optionsJson,
       const std::optional<std::string> &toolsJson,
       const std::optional<std::function<void(const std::string & /* token */,
-                                             double /* tokenId */)>> &callback)
-      override;
+                                             double /* tokenId */)>> &callback,
+      std::optional<double> tokenStream) override;
 
   std::shared_ptr<Promise<std::string>> transcribe(
       const std::string &audioFilePath, const std::string &prompt,
       double responseBufferSize, const std::optional<std::string> &optionsJson,
       const std::optional<std::function<void(const std::string & /* token */,
-                                             double /* tokenId */)>> &callback)
-      override;
+                                             double /* tokenId */)>> &callback,
+      std::optional<double> tokenStream) override;
+
+  void transcribeStreamPush(const std::shared_ptr<ArrayBuffer> &pcm) override;
+
+  std::shared_ptr<Promise<double>>
+  transcribeStreamWrite(const std::string &wavPath, bool commit) override;
+
+  void transcribeStreamClear() override;
 
   std::shared_ptr<Promise<std::vector<double>>>
   embed(const std::string &text, double embeddingBufferSize) override;
 
+  std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+  embedBatch(const std::vector<std::string> &texts,
+             double embeddingBufferSize) override;
+
   std::shared_ptr<Promise<std::vector<double>>>
   imageEmbed(const std::string &imagePath, double embeddingBufferSize) override;
 
   std::shared_ptr<Promise<std::vector<double>>>
   audioEmbed(const std::string &audioPath, double embeddingBufferSize) override;
 
+  std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+  embedFloat32(const std::string &text, double embeddingBufferSize) override;
+
+  std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+  imageEmbedFloat32(const std::string &imagePath,
+                    double embeddingBufferSize) override;
+
+  std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>>
+  audioEmbedFloat32(const std::string &audioPath,
+                    double embeddingBufferSize) override;
+
+  std::shared_ptr<Promise<std::string>>
+  benchmark(const std::vector<double> &prefillLengths,
+            const std::vector<double> &decodeLengths,
+            const std::vector<double> &embeddingBatchSizes, double iterations,
+            const std::optional<std::string> &imagePath,
+            const std::optional<std::string> &audioPath) override;
+
   std::shared_ptr<Promise<void>> reset() override;
 
   std::shared_ptr<Promise<void>> stop() override;
 
+  std::shared_ptr<Promise<void>> prefetchWeights() override;
+
+  double openTokenStream() override;
+  std::string drainTokens(double tokenStream) override;
+  void closeTokenStream(double tokenStream) override;
+
+  double getLoadProgress() override;
+
+  std::string predictLatency(const std::string &messagesJson,
+                             double maxTokens) override;
+
+  double getQueueDepth() override;
+
+  void setTracingEnabled(bool enabled) override;
+
+  std::string takeTrace() override;
+
+  void setThermalGovernorEnabled(bool enabled) override;
+
   std::shared_ptr<Promise<void>> destroy() override;
 
+  std::shared_ptr<Promise<void>>
+  setSession(const std::string &sessionId) override;
+
+  std::shared_ptr<Promise<void>>
+  deleteSession(const std::string &sessionId) override;
+
+  std::shared_ptr<Promise<void>>
+  setSessionMemoryBudget(double bytes) override;
+
+  std::shared_ptr<Promise<void>> setMaxSessions(double count) override;
+
+  std::shared_ptr<Promise<void>>
+  setEmbeddingCache(const std::optional<std::string> &directory) override;
+
 private:
+  struct Session {
+    std::string id;
+    cactus_model_t model;
+    std::string cachedMessagesJson;
+  };
+
+  static constexpr size_t kDefaultSessionMemoryBudget = 512 * 1024 * 1024;
+  // The largest integer a JS number holds exactly
+  static constexpr double kMaxSessionMemoryBudget = 9007199254740991;
+  static constexpr size_t kMaxSessions = 8;
+
   cactus_model_t _model = nullptr;
   size_t _contextSize;
-
-  std::mutex _modelMutex;
+  std::string _modelPath;
+  std::optional<std::string> _corpusDir;
+  CactusCacheWindow _cacheWindow;
+
+  std::string _sessionId = "default";
+  // Most recently used first
+  std::list<Session> _parkedSessions;
+  size_t _kvCacheBytes = 0;
+  // Estimated memory of one model handle, its KV cache included
+  size_t _sessionBytes = 0;
+  size_t _weightBytes = 0;
+  // Unloaded by the model registry, reopened on next use
+  bool _unloaded = false;
+
+  // Read without the scheduler while init runs
+  CactusLoadProgress _loadProgress;
+  size_t _sessionMemoryBudget = kDefaultSessionMemoryBudget;
+  // Every session is a model handle of its own, so only the active one is
+  // allowed until the app opts in
+  size_t _maxSessions = 1;
+
+  std::string _cachedMessagesJson;
+  std::string _toolsJson;
+  CactusToolCallValidator _tools{""};
+  size_t _predictedPrefixCacheHits = 0;
+  size_t _predictedPrefixCacheMisses = 0;
+
+  // Each streamed request has its own, so tokens never reach another call
+  std::mutex _tokenStreamsMutex;
+  uint64_t _lastTokenStream = 0;
+  std::unordered_map<uint64_t, std::shared_ptr<CactusTokenStream>>
+      _tokenStreams;
+  CactusAudioStream _audioStream;
+  CactusResponseBuffer _responseBuffer;
+  CactusTraceRecorder _trace;
+  CactusThermalGovernor _governor;
+  CactusLatencyModel _latency;
+
+  CactusModelScheduler _scheduler;
+  CactusCancellation _cancellation;
+
+  // Read without the scheduler, so cache hits never wait for the model
+  std::mutex _embeddingCacheMutex;
+  std::shared_ptr<CactusEmbeddingCache> _embeddingCache;
+
+  bool extendsCachedMessages(const std::string &messagesJson) const;
+  void resetPrefixCache();
+  void evictParkedSessions();
+  size_t residentBytes() const;
+  void updateResidency();
+  std::optional<size_t> shedMemory();
+  std::shared_ptr<CactusEmbeddingCache> embeddingCache();
+  std::shared_ptr<CactusTokenStream>
+  tokenStream(std::optional<double> tokenStream);
+  cactus_model_t openModel() const;
+  void ensureModelLoaded();
+  void unloadModel();
+  bool tryUnload();
 };
 
 } // namespace margelo::nitro::cactus
@@ -0,0 +1,134 @@
+#include "HybridCactusIndex.hpp"
+
+#include <cmath>
+
+namespace margelo::nitro::cactus {
+
+namespace {
+
+std::vector<float> copyFloats(const std::shared_ptr<ArrayBuffer> &buffer) {
+  const auto *data = reinterpret_cast<const float *>(buffer->data());
+  return std::vector<float>(data, data + buffer->size() / sizeof(float));
+}
+
+// The largest integer a JS number holds exactly
+constexpr double kMaxSafeInteger = 9007199254740991;
+constexpr double kMaxDimension = 65536;
+
+int64_t toInteger(double value, const char *name, double min, double max) {
+  if (!std::isfinite(value) || value != std::floor(value) || value < min ||
+      value > max) {
+    throw std::runtime_error("Cactus index " + std::string(name) +
+                             " must be a whole number from " +
+                             std::to_string(static_cast<int64_t>(min)) +
+                             " to " +
+                             std::to_string(static_cast<int64_t>(max)));
+  }
+  return static_cast<int64_t>(value);
+}
+
+std::vector<int64_t> toIds(const std::vector<double> &ids) {
+  std::vector<int64_t> result;
+  result.reserve(ids.size());
+  for (const double id : ids) {
+    result.push_back(toInteger(id, "id", -kMaxSafeInteger, kMaxSafeInteger));
+  }
+  return result;
+}
+
+} // namespace
+
+HybridCactusIndex::HybridCactusIndex() : HybridObject(TAG) {}
+
+CactusVectorIndex &HybridCactusIndex::index() {
+  if (!this->_index) {
+    throw std::runtime_error("Cactus index is not open");
+  }
+  return *this->_index;
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactusIndex::open(const std::string &indexPath, double embeddingDim) {
+  return Promise<void>::async([this, indexPath, embeddingDim]() -> void {
+    const size_t dimension =
+        toInteger(embeddingDim, "embeddingDim", 1, kMaxDimension);
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_index.reset();
+    this->_index = std::make_unique<CactusVectorIndex>(indexPath, dimension);
+  });
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactusIndex::add(const std::vector<double> &ids,
+                       const std::shared_ptr<ArrayBuffer> &embeddings) {
+  // The JS buffer is only valid during this call
+  auto floats = copyFloats(embeddings);
+  return Promise<void>::async(
+      [this, ids, floats = std::move(floats)]() -> void {
+        const auto indexIds = toIds(ids);
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        auto &index = this->index();
+        if (floats.size() != indexIds.size() * index.dimension()) {
+          throw std::runtime_error(
+              "Cactus index embeddings do not match the number of ids");
+        }
+        index.add(indexIds.data(), floats.data(), indexIds.size());
+      });
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactusIndex::remove(const std::vector<double> &ids) {
+  return Promise<void>::async([this, ids]() -> void {
+    const auto indexIds = toIds(ids);
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->index().remove(indexIds.data(), indexIds.size());
+  });
+}
+
+std::shared_ptr<Promise<std::string>>
+HybridCactusIndex::query(const std::shared_ptr<ArrayBuffer> &embedding,
+                         double k, double probes) {
+  auto floats = copyFloats(embedding);
+  return Promise<std::string>::async(
+      [this, floats = std::move(floats), k, probes]() -> std::string {
+        const size_t count = toInteger(k, "k", 0, kMaxSafeInteger);
+        const size_t probeCount =
+            toInteger(probes, "probes", 1, kMaxSafeInteger);
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        auto &index = this->index();
+        if (floats.size() != index.dimension()) {
+          throw std::runtime_error(
+              "Cactus index query does not match the index dimension");
+        }
+
+        const auto results = index.query(floats.data(), count, probeCount);
+
+        std::string ids = "[";
+        std::string scores = "[";
+        for (size_t i = 0; i < results.size(); ++i) {
+          if (i > 0) {
+            ids += ',';
+            scores += ',';
+          }
+          ids += std::to_string(results[i].id);
+          scores += std::to_string(results[i].score);
+        }
+        return "{\"ids\":" + ids + "],\"scores\":" + scores + "]}";
+      });
+}
+
+std::shared_ptr<Promise<double>> HybridCactusIndex::getSize() {
+  return Promise<double>::async([this]() -> double {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->index().size();
+  });
+}
+
+std::shared_ptr<Promise<void>> HybridCactusIndex::close() {
+  return Promise<void>::async([this]() -> void {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_index.reset();
+  });
+}
+
+} // namespace margelo::nitro::cactus
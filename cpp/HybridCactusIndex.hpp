@@ -0,0 +1,40 @@
+#pragma once
+#include "HybridCactusIndexSpec.hpp"
+
+#include "CactusVectorIndex.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace margelo::nitro::cactus {
+
+class HybridCactusIndex : public HybridCactusIndexSpec {
+public:
+  HybridCactusIndex();
+
+  std::shared_ptr<Promise<void>> open(const std::string &indexPath,
+                                      double embeddingDim) override;
+
+  std::shared_ptr<Promise<void>>
+  add(const std::vector<double> &ids,
+      const std::shared_ptr<ArrayBuffer> &embeddings) override;
+
+  std::shared_ptr<Promise<void>>
+  remove(const std::vector<double> &ids) override;
+
+  std::shared_ptr<Promise<std::string>>
+  query(const std::shared_ptr<ArrayBuffer> &embedding, double k,
+        double probes) override;
+
+  std::shared_ptr<Promise<double>> getSize() override;
+
+  std::shared_ptr<Promise<void>> close() override;
+
+private:
+  std::mutex _mutex;
+  std::unique_ptr<CactusVectorIndex> _index;
+
+  CactusVectorIndex &index();
+};
+
+} // namespace margelo::nitro::cactus
@@ -1,7 +1,64 @@
 #include "HybridCactusUtil.hpp"
+#include "CactusAudioAnalysis.hpp"
+#include "CactusKernelBenchmark.hpp"
+#include "CactusMetrics.hpp"
+#include "CactusModelRegistry.hpp"
+#include "CactusPng.hpp"
+#include "CactusWav.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
 
 namespace margelo::nitro::cactus {
 
+namespace {
+
+constexpr double kMaxImageSize = 4096;
+// The largest integer a JS number holds exactly
+constexpr double kMaxSafeInteger = 9007199254740991;
+
+// Averages the source pixels covered by each output pixel into RGB
+std::vector<uint8_t> resizeToRgb(const std::vector<uint8_t> &pixels,
+                                 size_t width, size_t height, size_t channels,
+                                 bool bgr, size_t outputSize) {
+  std::vector<uint8_t> rgb(outputSize * outputSize * 3);
+
+  // Source column spans are the same for every output row
+  std::vector<size_t> columns(outputSize + 1);
+  for (size_t x = 0; x <= outputSize; ++x) {
+    columns[x] = x * width / outputSize;
+  }
+
+  uint8_t *out = rgb.data();
+  for (size_t y = 0; y < outputSize; ++y) {
+    const size_t y0 = y * height / outputSize;
+    const size_t y1 = std::max(y0 + 1, (y + 1) * height / outputSize);
+    for (size_t x = 0; x < outputSize; ++x, out += 3) {
+      const size_t x0 = columns[x];
+      const size_t x1 = std::max(x0 + 1, columns[x + 1]);
+
+      uint32_t sum[3] = {0, 0, 0};
+      for (size_t sy = y0; sy < y1; ++sy) {
+        const uint8_t *pixel = pixels.data() + (sy * width + x0) * channels;
+        for (size_t sx = x0; sx < x1; ++sx, pixel += channels) {
+          sum[0] += pixel[0];
+          sum[1] += pixel[1];
+          sum[2] += pixel[2];
+        }
+      }
+
+      const uint32_t count = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+      out[bgr ? 2 : 0] = static_cast<uint8_t>(sum[0] / count);
+      out[1] = static_cast<uint8_t>(sum[1] / count);
+      out[bgr ? 0 : 2] = static_cast<uint8_t>(sum[2] / count);
+    }
+  }
+  return rgb;
+}
+
+} // namespace
+
 HybridCactusUtil::HybridCactusUtil() : HybridObject(TAG) {}
 
 std::shared_ptr<Promise<std::string>>
@@ -44,4 +101,132 @@ HybridCactusUtil::setAndroidDataDirectory(const std::string &dataDir) {
   });
 }
 
+std::shared_ptr<Promise<void>>
+HybridCactusUtil::setModelMemoryBudget(double bytes) {
+  return Promise<void>::async([bytes]() -> void {
+    if (!(bytes >= 0 && bytes <= kMaxSafeInteger) ||
+        std::floor(bytes) != bytes) {
+      throw std::runtime_error(
+          "Model memory budget must be a whole number of bytes");
+    }
+
+    CactusModelRegistry::shared().setMemoryBudget(static_cast<size_t>(bytes));
+  });
+}
+
+std::shared_ptr<Promise<void>>
+HybridCactusUtil::trimMemory(const std::string &level) {
+  return Promise<void>::async([level]() -> void {
+    if (level != "moderate" && level != "critical") {
+      throw std::runtime_error("Unknown memory pressure level " + level);
+    }
+    CactusModelRegistry::shared().trim(level == "critical"
+                                           ? CactusMemoryPressure::Critical
+                                           : CactusMemoryPressure::Moderate);
+  });
+}
+
+std::shared_ptr<Promise<std::vector<std::string>>>
+HybridCactusUtil::splitAudio(const std::string &audioPath,
+                             const std::string &outputDir,
+                             double maxWindowSeconds) {
+  return Promise<std::vector<std::string>>::async(
+      [audioPath, outputDir,
+       maxWindowSeconds]() -> std::vector<std::string> {
+        const CactusWavAudio audio = readWav(audioPath);
+        const auto boundaries =
+            CactusAudioAnalysis(audio.samples, audio.sampleRate)
+                .windowBoundaries(maxWindowSeconds);
+
+        std::filesystem::create_directories(outputDir);
+
+        std::vector<std::string> windowPaths;
+        for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+          const std::string windowPath =
+              outputDir + "/window_" + std::to_string(i) + ".wav";
+          writeWav(windowPath, audio.samples.data() + boundaries[i],
+                   boundaries[i + 1] - boundaries[i], audio.sampleRate);
+          windowPaths.push_back(windowPath);
+        }
+        return windowPaths;
+      });
+}
+
+std::shared_ptr<Promise<double>>
+HybridCactusUtil::removeSilence(const std::string &audioPath,
+                                const std::string &outputPath) {
+  return Promise<double>::async([audioPath, outputPath]() -> double {
+    const CactusWavAudio audio = readWav(audioPath);
+    const CactusAudioAnalysis analysis(audio.samples, audio.sampleRate);
+    const std::vector<bool> speech = analysis.speechFrames();
+
+    std::vector<float> speechSamples;
+    speechSamples.reserve(audio.samples.size());
+    for (size_t frame = 0; frame < speech.size(); ++frame) {
+      if (!speech[frame]) {
+        continue;
+      }
+      const size_t begin = frame * analysis.frameSamples();
+      const size_t end =
+          std::min(begin + analysis.frameSamples(), audio.samples.size());
+      speechSamples.insert(speechSamples.end(), audio.samples.begin() + begin,
+                           audio.samples.begin() + end);
+    }
+
+    writeWav(outputPath, speechSamples.data(), speechSamples.size(),
+             audio.sampleRate);
+
+    return audio.samples.empty()
+               ? 0.0
+               : static_cast<double>(speechSamples.size()) /
+                     static_cast<double>(audio.samples.size());
+  });
+}
+
+std::shared_ptr<Promise<std::string>> HybridCactusUtil::writeImagePixels(
+    const std::shared_ptr<ArrayBuffer> &pixels, double width, double height,
+    const std::string &format, const std::string &outputDir,
+    double outputSize) {
+  const size_t channels = format == "rgb" ? 3 : 4;
+  if (format != "rgb" && format != "rgba" && format != "bgra") {
+    throw std::runtime_error("Unsupported pixel format: " + format);
+  }
+
+  // Checked as doubles, so that NaN, negative and huge dimensions are
+  // rejected before they are converted or multiplied
+  if (!(width >= 1) || !(height >= 1) || !(outputSize >= 1) ||
+      outputSize > kMaxImageSize ||
+      width * height * channels > static_cast<double>(pixels->size())) {
+    throw std::runtime_error("Pixel buffer does not match its dimensions");
+  }
+  const size_t bytes =
+      static_cast<size_t>(width) * static_cast<size_t>(height) * channels;
+
+  // The JS buffer is only valid during this call
+  std::vector<uint8_t> copy(pixels->data(), pixels->data() + bytes);
+
+  return Promise<std::string>::async([copy = std::move(copy), width, height,
+                                      format, outputDir, outputSize,
+                                      channels]() -> std::string {
+    const auto rgb = resizeToRgb(copy, width, height, channels,
+                                 format == "bgra", outputSize);
+
+    return writeContentNamedPng(outputDir, rgb.data(), outputSize,
+                                outputSize);
+  });
+}
+
+std::shared_ptr<Promise<std::string>>
+HybridCactusUtil::benchmarkKernels(double iterations) {
+  return Promise<std::string>::async([iterations]() -> std::string {
+    return CactusKernelBenchmark(iterations).run();
+  });
+}
+
+std::string HybridCactusUtil::getMetrics() {
+  return CactusMetrics::shared().snapshot();
+}
+
+void HybridCactusUtil::resetMetrics() { CactusMetrics::shared().reset(); }
+
 } // namespace margelo::nitro::cactus
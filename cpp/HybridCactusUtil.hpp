@@ -19,6 +19,31 @@ public:
   std::shared_ptr<Promise<void>>
   setAndroidDataDirectory(const std::string &dataDir) override;
 
+  std::shared_ptr<Promise<void>> setModelMemoryBudget(double bytes) override;
+
+  std::shared_ptr<Promise<void>>
+  trimMemory(const std::string &level) override;
+
+  std::shared_ptr<Promise<std::vector<std::string>>>
+  splitAudio(const std::string &audioPath, const std::string &outputDir,
+             double maxWindowSeconds) override;
+
+  std::shared_ptr<Promise<double>>
+  removeSilence(const std::string &audioPath,
+                const std::string &outputPath) override;
+
+  std::shared_ptr<Promise<std::string>>
+  writeImagePixels(const std::shared_ptr<ArrayBuffer> &pixels, double width,
+                   double height, const std::string &format,
+                   const std::string &outputDir, double outputSize) override;
+
+  std::shared_ptr<Promise<std::string>>
+  benchmarkKernels(double iterations) override;
+
+  std::string getMetrics() override;
+
+  void resetMetrics() override;
+
 private:
   std::mutex _mutex;
 };
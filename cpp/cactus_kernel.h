@@ -0,0 +1,28 @@
+#ifndef CACTUS_KERNEL_H
+#define CACTUS_KERNEL_H
+
+// The kernels of kernel.h measured by CactusKernelBenchmark. They are only
+// linkable from the static library of the Android build; the iOS framework
+// keeps them private.
+
+#include <stddef.h>
+#include <stdint.h>
+
+void cactus_matmul_int8_to_int32(const int8_t* a, const int8_t* b_transposed, int32_t* c,
+                                 size_t M, size_t K, size_t N);
+
+void cactus_matmul_f16(const __fp16* a, const __fp16* b_transposed, __fp16* c,
+                       size_t M, size_t K, size_t N);
+
+void cactus_rms_norm_f16(const __fp16* input, const __fp16* weight, __fp16* output,
+                          size_t batch_size, size_t dims, float eps);
+
+void cactus_softmax_f32(const float* input, float* output, size_t batch_size,
+                         size_t seq_len, size_t vocab_size);
+
+void cactus_attention_f16(const __fp16* queries, const __fp16* keys, const __fp16* values, __fp16* output,
+                          size_t batch_size, size_t seq_len, size_t kv_seq_len, size_t num_q_heads, size_t num_kv_heads,
+                          size_t head_dim, float scale, const __fp16* mask, size_t position_offset = 0, size_t window_size = 0,
+                          bool is_causal = true);
+
+#endif
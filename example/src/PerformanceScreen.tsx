@@ -10,8 +10,10 @@ import {
 } from 'react-native';
 import {
   CactusLM,
+  CactusKernelBenchmark,
   type Message,
   type CactusLMCompleteResult,
+  type CactusKernelBenchmarkRun,
 } from 'cactus-react-native';
 
 const cactusLM = new CactusLM({ model: 'lfm2-350m' });
@@ -22,6 +24,10 @@ const PerformanceScreen = () => {
   const [isDownloading, setIsDownloading] = useState(false);
   const [downloadProgress, setDownloadProgress] = useState(0);
   const [isGenerating, setIsGenerating] = useState(false);
+  const [kernelRuns, setKernelRuns] = useState<
+    CactusKernelBenchmarkRun[] | null
+  >(null);
+  const [isBenchmarking, setIsBenchmarking] = useState(false);
   const [error, setError] = useState<string | null>(null);
 
   useEffect(() => {
@@ -103,6 +109,18 @@ const PerformanceScreen = () => {
     }
   };
 
+  const handleBenchmarkKernels = async () => {
+    try {
+      setError(null);
+      setIsBenchmarking(true);
+      setKernelRuns(await CactusKernelBenchmark.run());
+    } catch (err) {
+      setError(err instanceof Error ? err.message : 'Benchmark failed');
+    } finally {
+      setIsBenchmarking(false);
+    }
+  };
+
   if (isDownloading) {
     return (
       <View style={styles.centerContainer}>
@@ -150,8 +168,37 @@ const PerformanceScreen = () => {
         <TouchableOpacity style={styles.button} onPress={handleDestroy}>
           <Text style={styles.buttonText}>Destroy</Text>
         </TouchableOpacity>
+
+        <TouchableOpacity
+          style={styles.button}
+          onPress={handleBenchmarkKernels}
+          disabled={isBenchmarking}
+        >
+          <Text style={styles.buttonText}>
+            {isBenchmarking ? 'Benchmarking...' : 'Kernels'}
+          </Text>
+        </TouchableOpacity>
       </View>
 
+      {kernelRuns && (
+        <View style={styles.resultContainer}>
+          <Text style={styles.resultLabel}>CactusKernelBenchmarkRun[]:</Text>
+          <View style={styles.resultBox}>
+            {kernelRuns.map((run) => (
+              <Text
+                key={`${run.kernel} ${run.family} ${run.shape}`}
+                style={styles.resultFieldValue}
+              >
+                {`${run.kernel} ${run.family} ${run.shape}: ` +
+                  `${run.ms.toFixed(3)} ms, ${run.gflops.toFixed(1)} GFLOPS, ` +
+                  `${run.gbPerSecond.toFixed(1)} GB/s, ` +
+                  `error ${run.maxError.toExponential(1)}`}
+              </Text>
+            ))}
+          </View>
+        </View>
+      )}
+
       {result && (
         <View style={styles.resultContainer}>
           <Text style={styles.resultLabel}>CactusLMCompleteResult:</Text>
@@ -0,0 +1,28 @@
+#import <Foundation/Foundation.h>
+
+#include "CactusThermalState.hpp"
+
+namespace margelo::nitro::cactus {
+
+CactusThermalState currentThermalState() {
+  // Low Power Mode asks apps to reduce work, treat it like a hot device
+  if (NSProcessInfo.processInfo.lowPowerModeEnabled &&
+      NSProcessInfo.processInfo.thermalState <
+          NSProcessInfoThermalStateSerious) {
+    return CactusThermalState::Serious;
+  }
+
+  switch (NSProcessInfo.processInfo.thermalState) {
+  case NSProcessInfoThermalStateNominal:
+    return CactusThermalState::Nominal;
+  case NSProcessInfoThermalStateFair:
+    return CactusThermalState::Fair;
+  case NSProcessInfoThermalStateSerious:
+    return CactusThermalState::Serious;
+  case NSProcessInfoThermalStateCritical:
+    return CactusThermalState::Critical;
+  }
+  return CactusThermalState::Nominal;
+}
+
+} // namespace margelo::nitro::cactus
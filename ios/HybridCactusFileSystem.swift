@@ -3,6 +3,8 @@ import NitroModules
 import ZIPFoundation
 
 class HybridCactusFileSystem: HybridCactusFileSystemSpec {
+  private let maxDownloadAttempts = 3
+
   func getCactusDirectory() throws -> Promise<String> {
     return Promise.async { try self.cactusURL().path }
   }
@@ -93,11 +95,15 @@ class HybridCactusFileSystem: HybridCactusFileSystemSpec {
       }
 
       let session = URLSession(configuration: .default, delegate: delegate, delegateQueue: nil)
-      let task = session.downloadTask(with: url)
+      defer { session.finishTasksAndInvalidate() }
+
+      // Kept across calls so an interrupted download resumes where it stopped
+      let resumeDataURL = try self.resumeDataURL(model: model)
 
       callback?(0.0)
 
-      let (fileURL, response) = try await delegate.awaitCompletion(for: task)
+      let (fileURL, response) = try await self.download(
+        from: url, session: session, delegate: delegate, resumeDataURL: resumeDataURL)
 
       guard let httpResponse = response as? HTTPURLResponse,
             (200...299).contains(httpResponse.statusCode)
@@ -154,6 +160,51 @@ class HybridCactusFileSystem: HybridCactusFileSystemSpec {
     return cactusURL
   }
   
+  private func download(
+    from url: URL,
+    session: URLSession,
+    delegate: DownloadProgressDelegate,
+    resumeDataURL: URL
+  ) async throws -> (URL, URLResponse) {
+    var attempt = 0
+    while true {
+      let task: URLSessionDownloadTask
+      if let resumeData = try? Data(contentsOf: resumeDataURL) {
+        try? FileManager.default.removeItem(at: resumeDataURL)
+        task = session.downloadTask(withResumeData: resumeData)
+      } else {
+        task = session.downloadTask(with: url)
+      }
+
+      do {
+        return try await delegate.awaitCompletion(for: task)
+      } catch {
+        if let resumeData = (error as? URLError)?.downloadTaskResumeData {
+          try? resumeData.write(to: resumeDataURL)
+        }
+
+        attempt += 1
+        if attempt >= maxDownloadAttempts {
+          throw RuntimeError.error(withMessage: "Failed to download model: \(error)")
+        }
+      }
+    }
+  }
+
+  private func resumeDataURL(model: String) throws -> URL {
+    let caches = try FileManager.default.url(
+      for: .cachesDirectory,
+      in: .userDomainMask,
+      appropriateFor: nil,
+      create: false)
+
+    let resumeDir = caches.appendingPathComponent("cactus/resume", isDirectory: true)
+    try FileManager.default.createDirectory(at: resumeDir, withIntermediateDirectories: true)
+
+    let name = model.replacingOccurrences(of: "/", with: "_")
+    return resumeDir.appendingPathComponent(name).appendingPathExtension("resume")
+  }
+
   private func modelURL(model: String) throws -> URL {
     let cactusURL = try self.cactusURL()
     return cactusURL.appendingPathComponent("models/\(model)")
@@ -175,6 +226,8 @@ private class DownloadProgressDelegate: NSObject, URLSessionDownloadDelegate, UR
     return try await withCheckedThrowingContinuation {
       (cont: CheckedContinuation<(URL, URLResponse), Error>) in
       self.continuation = cont
+      self.fileURL = nil
+      self.response = nil
       task.resume()
     }
   }
@@ -39,6 +39,7 @@ target_sources(
   ../nitrogen/generated/shared/c++/HybridCactusFileSystemSpec.cpp
   ../nitrogen/generated/shared/c++/HybridCactusImageSpec.cpp
   ../nitrogen/generated/shared/c++/HybridCactusUtilSpec.cpp
+  ../nitrogen/generated/shared/c++/HybridCactusIndexSpec.cpp
   # Android-specific Nitrogen C++ sources
   ../nitrogen/generated/android/c++/JHybridCactusCryptoSpec.cpp
   ../nitrogen/generated/android/c++/JHybridCactusDeviceInfoSpec.cpp
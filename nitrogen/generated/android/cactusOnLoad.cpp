@@ -22,6 +22,7 @@
 #include "JHybridCactusImageSpec.hpp"
 #include "HybridCactus.hpp"
 #include "HybridCactusUtil.hpp"
+#include "HybridCactusIndex.hpp"
 #include <NitroModules/DefaultConstructableObject.hpp>
 
 namespace margelo::nitro::cactus {
@@ -58,6 +59,15 @@ int initialize(JavaVM* vm) {
         return std::make_shared<HybridCactusUtil>();
       }
     );
+    HybridObjectRegistry::registerHybridObjectConstructor(
+      "CactusIndex",
+      []() -> std::shared_ptr<HybridObject> {
+        static_assert(std::is_default_constructible_v<HybridCactusIndex>,
+                      "The HybridObject \"HybridCactusIndex\" is not default-constructible! "
+                      "Create a public constructor that takes zero arguments to be able to autolink this HybridObject.");
+        return std::make_shared<HybridCactusIndex>();
+      }
+    );
     HybridObjectRegistry::registerHybridObjectConstructor(
       "CactusFileSystem",
       []() -> std::shared_ptr<HybridObject> {
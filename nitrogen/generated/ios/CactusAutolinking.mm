@@ -12,6 +12,7 @@
 
 #include "HybridCactus.hpp"
 #include "HybridCactusUtil.hpp"
+#include "HybridCactusIndex.hpp"
 #include "HybridCactusFileSystemSpecSwift.hpp"
 #include "HybridCactusCryptoSpecSwift.hpp"
 #include "HybridCactusDeviceInfoSpecSwift.hpp"
@@ -44,6 +45,15 @@
       return std::make_shared<HybridCactusUtil>();
     }
   );
+  HybridObjectRegistry::registerHybridObjectConstructor(
+    "CactusIndex",
+    []() -> std::shared_ptr<HybridObject> {
+      static_assert(std::is_default_constructible_v<HybridCactusIndex>,
+                    "The HybridObject \"HybridCactusIndex\" is not default-constructible! "
+                    "Create a public constructor that takes zero arguments to be able to autolink this HybridObject.");
+      return std::make_shared<HybridCactusIndex>();
+    }
+  );
   HybridObjectRegistry::registerHybridObjectConstructor(
     "CactusFileSystem",
     []() -> std::shared_ptr<HybridObject> {
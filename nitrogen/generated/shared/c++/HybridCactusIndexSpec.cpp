@@ -0,0 +1,26 @@
+///
+/// HybridCactusIndexSpec.cpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#include "HybridCactusIndexSpec.hpp"
+
+namespace margelo::nitro::cactus {
+
+  void HybridCactusIndexSpec::loadHybridMethods() {
+    // load base methods/properties
+    HybridObject::loadHybridMethods();
+    // load custom methods/properties
+    registerHybrids(this, [](Prototype& prototype) {
+      prototype.registerHybridMethod("open", &HybridCactusIndexSpec::open);
+      prototype.registerHybridMethod("add", &HybridCactusIndexSpec::add);
+      prototype.registerHybridMethod("remove", &HybridCactusIndexSpec::remove);
+      prototype.registerHybridMethod("query", &HybridCactusIndexSpec::query);
+      prototype.registerHybridMethod("getSize", &HybridCactusIndexSpec::getSize);
+      prototype.registerHybridMethod("close", &HybridCactusIndexSpec::close);
+    });
+  }
+
+} // namespace margelo::nitro::cactus
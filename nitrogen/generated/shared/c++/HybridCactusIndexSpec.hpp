@@ -0,0 +1,70 @@
+///
+/// HybridCactusIndexSpec.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/HybridObject.hpp>)
+#include <NitroModules/HybridObject.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+
+
+#include <NitroModules/Promise.hpp>
+#include <string>
+#include <vector>
+#include <NitroModules/ArrayBuffer.hpp>
+
+namespace margelo::nitro::cactus {
+
+  using namespace margelo::nitro;
+
+  /**
+   * An abstract base class for `CactusIndex`
+   * Inherit this class to create instances of `HybridCactusIndexSpec` in C++.
+   * You must explicitly call `HybridObject`'s constructor yourself, because it is virtual.
+   * @example
+   * ```cpp
+   * class HybridCactusIndex: public HybridCactusIndexSpec {
+   * public:
+   *   HybridCactusIndex(...): HybridObject(TAG) { ... }
+   *   // ...
+   * };
+   * ```
+   */
+  class HybridCactusIndexSpec: public virtual HybridObject {
+    public:
+      // Constructor
+      explicit HybridCactusIndexSpec(): HybridObject(TAG) { }
+
+      // Destructor
+      ~HybridCactusIndexSpec() override = default;
+
+    public:
+      // Properties
+      
+
+    public:
+      // Methods
+      virtual std::shared_ptr<Promise<void>> open(const std::string& indexPath, double embeddingDim) = 0;
+      virtual std::shared_ptr<Promise<void>> add(const std::vector<double>& ids, const std::shared_ptr<ArrayBuffer>& embeddings) = 0;
+      virtual std::shared_ptr<Promise<void>> remove(const std::vector<double>& ids) = 0;
+      virtual std::shared_ptr<Promise<std::string>> query(const std::shared_ptr<ArrayBuffer>& embedding, double k, double probes) = 0;
+      virtual std::shared_ptr<Promise<double>> getSize() = 0;
+      virtual std::shared_ptr<Promise<void>> close() = 0;
+
+    protected:
+      // Hybrid Setup
+      void loadHybridMethods() override;
+
+    protected:
+      // Tag for logging
+      static constexpr auto TAG = "CactusIndex";
+  };
+
+} // namespace margelo::nitro::cactus
@@ -17,12 +17,35 @@ namespace margelo::nitro::cactus {
       prototype.registerHybridMethod("init", &HybridCactusSpec::init);
       prototype.registerHybridMethod("complete", &HybridCactusSpec::complete);
       prototype.registerHybridMethod("transcribe", &HybridCactusSpec::transcribe);
+      prototype.registerHybridMethod("transcribeStreamPush", &HybridCactusSpec::transcribeStreamPush);
+      prototype.registerHybridMethod("transcribeStreamWrite", &HybridCactusSpec::transcribeStreamWrite);
+      prototype.registerHybridMethod("transcribeStreamClear", &HybridCactusSpec::transcribeStreamClear);
       prototype.registerHybridMethod("embed", &HybridCactusSpec::embed);
+      prototype.registerHybridMethod("embedBatch", &HybridCactusSpec::embedBatch);
       prototype.registerHybridMethod("imageEmbed", &HybridCactusSpec::imageEmbed);
       prototype.registerHybridMethod("audioEmbed", &HybridCactusSpec::audioEmbed);
+      prototype.registerHybridMethod("embedFloat32", &HybridCactusSpec::embedFloat32);
+      prototype.registerHybridMethod("imageEmbedFloat32", &HybridCactusSpec::imageEmbedFloat32);
+      prototype.registerHybridMethod("audioEmbedFloat32", &HybridCactusSpec::audioEmbedFloat32);
+      prototype.registerHybridMethod("benchmark", &HybridCactusSpec::benchmark);
       prototype.registerHybridMethod("reset", &HybridCactusSpec::reset);
       prototype.registerHybridMethod("stop", &HybridCactusSpec::stop);
+      prototype.registerHybridMethod("prefetchWeights", &HybridCactusSpec::prefetchWeights);
+      prototype.registerHybridMethod("openTokenStream", &HybridCactusSpec::openTokenStream);
+      prototype.registerHybridMethod("drainTokens", &HybridCactusSpec::drainTokens);
+      prototype.registerHybridMethod("closeTokenStream", &HybridCactusSpec::closeTokenStream);
+      prototype.registerHybridMethod("getLoadProgress", &HybridCactusSpec::getLoadProgress);
+      prototype.registerHybridMethod("predictLatency", &HybridCactusSpec::predictLatency);
+      prototype.registerHybridMethod("getQueueDepth", &HybridCactusSpec::getQueueDepth);
+      prototype.registerHybridMethod("setTracingEnabled", &HybridCactusSpec::setTracingEnabled);
+      prototype.registerHybridMethod("takeTrace", &HybridCactusSpec::takeTrace);
+      prototype.registerHybridMethod("setThermalGovernorEnabled", &HybridCactusSpec::setThermalGovernorEnabled);
       prototype.registerHybridMethod("destroy", &HybridCactusSpec::destroy);
+      prototype.registerHybridMethod("setSession", &HybridCactusSpec::setSession);
+      prototype.registerHybridMethod("deleteSession", &HybridCactusSpec::deleteSession);
+      prototype.registerHybridMethod("setSessionMemoryBudget", &HybridCactusSpec::setSessionMemoryBudget);
+      prototype.registerHybridMethod("setMaxSessions", &HybridCactusSpec::setMaxSessions);
+      prototype.registerHybridMethod("setEmbeddingCache", &HybridCactusSpec::setEmbeddingCache);
     });
   }
 
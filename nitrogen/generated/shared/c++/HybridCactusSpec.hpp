@@ -16,6 +16,7 @@
 
 
 #include <NitroModules/Promise.hpp>
+#include <NitroModules/ArrayBuffer.hpp>
 #include <string>
 #include <optional>
 #include <functional>
@@ -52,15 +53,38 @@ namespace margelo::nitro::cactus {
 
     public:
       // Methods
-      virtual std::shared_ptr<Promise<void>> init(const std::string& modelPath, double contextSize, const std::optional<std::string>& corpusDir) = 0;
-      virtual std::shared_ptr<Promise<std::string>> complete(const std::string& messagesJson, double responseBufferSize, const std::optional<std::string>& optionsJson, const std::optional<std::string>& toolsJson, const std::optional<std::function<void(const std::string& /* token */, double /* tokenId */)>>& callback) = 0;
-      virtual std::shared_ptr<Promise<std::string>> transcribe(const std::string& audioFilePath, const std::string& prompt, double responseBufferSize, const std::optional<std::string>& optionsJson, const std::optional<std::function<void(const std::string& /* token */, double /* tokenId */)>>& callback) = 0;
+      virtual std::shared_ptr<Promise<double>> init(const std::string& modelPath, double contextSize, const std::optional<std::string>& corpusDir, std::optional<double> kvWindowSize, std::optional<double> kvSinkSize) = 0;
+      virtual std::shared_ptr<Promise<std::string>> complete(const std::string& messagesJson, double responseBufferSize, const std::optional<std::string>& optionsJson, const std::optional<std::string>& toolsJson, const std::optional<std::function<void(const std::string& /* token */, double /* tokenId */)>>& callback, std::optional<double> tokenStream) = 0;
+      virtual std::shared_ptr<Promise<std::string>> transcribe(const std::string& audioFilePath, const std::string& prompt, double responseBufferSize, const std::optional<std::string>& optionsJson, const std::optional<std::function<void(const std::string& /* token */, double /* tokenId */)>>& callback, std::optional<double> tokenStream) = 0;
+      virtual void transcribeStreamPush(const std::shared_ptr<ArrayBuffer>& pcm) = 0;
+      virtual std::shared_ptr<Promise<double>> transcribeStreamWrite(const std::string& wavPath, bool commit) = 0;
+      virtual void transcribeStreamClear() = 0;
       virtual std::shared_ptr<Promise<std::vector<double>>> embed(const std::string& text, double embeddingBufferSize) = 0;
+      virtual std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>> embedBatch(const std::vector<std::string>& texts, double embeddingBufferSize) = 0;
       virtual std::shared_ptr<Promise<std::vector<double>>> imageEmbed(const std::string& imagePath, double embeddingBufferSize) = 0;
       virtual std::shared_ptr<Promise<std::vector<double>>> audioEmbed(const std::string& audioPath, double embeddingBufferSize) = 0;
+      virtual std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>> embedFloat32(const std::string& text, double embeddingBufferSize) = 0;
+      virtual std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>> imageEmbedFloat32(const std::string& imagePath, double embeddingBufferSize) = 0;
+      virtual std::shared_ptr<Promise<std::shared_ptr<ArrayBuffer>>> audioEmbedFloat32(const std::string& audioPath, double embeddingBufferSize) = 0;
+      virtual std::shared_ptr<Promise<std::string>> benchmark(const std::vector<double>& prefillLengths, const std::vector<double>& decodeLengths, const std::vector<double>& embeddingBatchSizes, double iterations, const std::optional<std::string>& imagePath, const std::optional<std::string>& audioPath) = 0;
       virtual std::shared_ptr<Promise<void>> reset() = 0;
       virtual std::shared_ptr<Promise<void>> stop() = 0;
+      virtual std::shared_ptr<Promise<void>> prefetchWeights() = 0;
+      virtual double openTokenStream() = 0;
+      virtual std::string drainTokens(double tokenStream) = 0;
+      virtual void closeTokenStream(double tokenStream) = 0;
+      virtual double getLoadProgress() = 0;
+      virtual std::string predictLatency(const std::string& messagesJson, double maxTokens) = 0;
+      virtual double getQueueDepth() = 0;
+      virtual void setTracingEnabled(bool enabled) = 0;
+      virtual std::string takeTrace() = 0;
+      virtual void setThermalGovernorEnabled(bool enabled) = 0;
       virtual std::shared_ptr<Promise<void>> destroy() = 0;
+      virtual std::shared_ptr<Promise<void>> setSession(const std::string& sessionId) = 0;
+      virtual std::shared_ptr<Promise<void>> deleteSession(const std::string& sessionId) = 0;
+      virtual std::shared_ptr<Promise<void>> setSessionMemoryBudget(double bytes) = 0;
+      virtual std::shared_ptr<Promise<void>> setMaxSessions(double count) = 0;
+      virtual std::shared_ptr<Promise<void>> setEmbeddingCache(const std::optional<std::string>& directory) = 0;
 
     protected:
       // Hybrid Setup
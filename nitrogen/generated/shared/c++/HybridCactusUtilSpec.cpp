@@ -17,6 +17,14 @@ namespace margelo::nitro::cactus {
       prototype.registerHybridMethod("registerApp", &HybridCactusUtilSpec::registerApp);
       prototype.registerHybridMethod("getDeviceId", &HybridCactusUtilSpec::getDeviceId);
       prototype.registerHybridMethod("setAndroidDataDirectory", &HybridCactusUtilSpec::setAndroidDataDirectory);
+      prototype.registerHybridMethod("setModelMemoryBudget", &HybridCactusUtilSpec::setModelMemoryBudget);
+      prototype.registerHybridMethod("trimMemory", &HybridCactusUtilSpec::trimMemory);
+      prototype.registerHybridMethod("splitAudio", &HybridCactusUtilSpec::splitAudio);
+      prototype.registerHybridMethod("removeSilence", &HybridCactusUtilSpec::removeSilence);
+      prototype.registerHybridMethod("writeImagePixels", &HybridCactusUtilSpec::writeImagePixels);
+      prototype.registerHybridMethod("benchmarkKernels", &HybridCactusUtilSpec::benchmarkKernels);
+      prototype.registerHybridMethod("getMetrics", &HybridCactusUtilSpec::getMetrics);
+      prototype.registerHybridMethod("resetMetrics", &HybridCactusUtilSpec::resetMetrics);
     });
   }
 
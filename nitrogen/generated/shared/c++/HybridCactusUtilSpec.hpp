@@ -17,7 +17,9 @@
 
 #include <string>
 #include <NitroModules/Promise.hpp>
+#include <NitroModules/ArrayBuffer.hpp>
 #include <optional>
+#include <vector>
 
 namespace margelo::nitro::cactus {
 
@@ -53,6 +55,14 @@ namespace margelo::nitro::cactus {
       virtual std::shared_ptr<Promise<std::string>> registerApp(const std::string& encryptedData) = 0;
       virtual std::shared_ptr<Promise<std::optional<std::string>>> getDeviceId() = 0;
       virtual std::shared_ptr<Promise<void>> setAndroidDataDirectory(const std::string& dataDir) = 0;
+      virtual std::shared_ptr<Promise<void>> setModelMemoryBudget(double bytes) = 0;
+      virtual std::shared_ptr<Promise<void>> trimMemory(const std::string& level) = 0;
+      virtual std::shared_ptr<Promise<std::vector<std::string>>> splitAudio(const std::string& audioPath, const std::string& outputDir, double maxWindowSeconds) = 0;
+      virtual std::shared_ptr<Promise<double>> removeSilence(const std::string& audioPath, const std::string& outputPath) = 0;
+      virtual std::shared_ptr<Promise<std::string>> writeImagePixels(const std::shared_ptr<ArrayBuffer>& pixels, double width, double height, const std::string& format, const std::string& outputDir, double outputSize) = 0;
+      virtual std::shared_ptr<Promise<std::string>> benchmarkKernels(double iterations) = 0;
+      virtual std::string getMetrics() = 0;
+      virtual void resetMetrics() = 0;
 
     protected:
       // Hybrid Setup
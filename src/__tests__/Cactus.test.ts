@@ -0,0 +1,356 @@
+import { NitroModules } from 'react-native-nitro-modules';
+import { Cactus } from '../native/Cactus';
+import { CactusImage } from '../native/CactusImage';
+import { CactusUtil } from '../native/CactusUtil';
+
+jest.mock('react-native-nitro-modules', () => ({
+  NitroModules: {
+    createHybridObject: jest.fn(() => ({
+      openTokenStream: jest.fn().mockReturnValue(7),
+      drainTokens: jest.fn(),
+      closeTokenStream: jest.fn(),
+      complete: jest.fn(),
+      embedBatch: jest.fn(),
+      embedFloat32: jest.fn(),
+      audioEmbedFloat32: jest.fn(),
+      getLoadProgress: jest.fn(),
+    })),
+  },
+}));
+jest.mock('../native/CactusFileSystem', () => ({
+  CactusFileSystem: {
+    getCactusDirectory: jest.fn().mockResolvedValue('/cactus'),
+    deleteFile: jest.fn().mockResolvedValue(undefined),
+  },
+}));
+jest.mock('../native/CactusImage', () => ({
+  CactusImage: {
+    resize: jest.fn(async (path: string) => `${path}.resized.jpg`),
+  },
+}));
+jest.mock('../native/CactusUtil', () => ({
+  CactusUtil: {
+    writeImagePixels: jest.fn(
+      async (_pixels: unknown, directory: string) => `${directory}/pixels.png`
+    ),
+  },
+}));
+
+const response = JSON.stringify({ success: true, response: 'Hi' });
+const messages = [{ role: 'user' as const, content: 'Hello' }];
+const batched = { batchTokens: true };
+
+function hybridCactus() {
+  const { results } = jest.mocked(NitroModules.createHybridObject).mock;
+  const result = results.at(-1);
+  if (!result) {
+    throw new Error('Cactus was not constructed');
+  }
+  return result.value;
+}
+
+describe('Cactus.complete', () => {
+  beforeEach(() => {
+    jest.useFakeTimers();
+    jest.clearAllMocks();
+  });
+
+  afterEach(() => {
+    jest.useRealTimers();
+  });
+
+  it('drains the stream of its call while it runs', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    let finish: (value: string) => void = () => {};
+    native.complete.mockReturnValue(
+      new Promise<string>((resolve) => (finish = resolve))
+    );
+    native.drainTokens
+      .mockReturnValueOnce('Hel')
+      .mockReturnValueOnce('')
+      .mockReturnValueOnce('lo')
+      .mockReturnValue('');
+    const tokens: string[] = [];
+
+    const result = cactus.complete(messages, 1024, batched, undefined, (t) =>
+      tokens.push(t)
+    );
+    await Promise.resolve();
+    jest.advanceTimersByTime(48);
+    expect(tokens).toEqual(['Hel', 'lo']);
+
+    finish(response);
+    await result;
+    expect(native.complete.mock.calls[0][5]).toBe(7);
+    expect(native.drainTokens).toHaveBeenCalledWith(7);
+  });
+
+  it('passes on the last tokens and closes the stream', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockResolvedValue(response);
+    native.drainTokens.mockReturnValueOnce('Hi').mockReturnValue('');
+    const tokens: string[] = [];
+
+    await cactus.complete(messages, 1024, batched, undefined, (t) =>
+      tokens.push(t)
+    );
+    expect(tokens).toEqual(['Hi']);
+    expect(native.closeTokenStream).toHaveBeenCalledWith(7);
+  });
+
+  it('closes the stream when the call fails', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockRejectedValue(new Error('failed'));
+    native.drainTokens.mockReturnValue('');
+
+    await expect(
+      cactus.complete(messages, 1024, batched, undefined, () => {})
+    ).rejects.toThrow('failed');
+    expect(native.closeTokenStream).toHaveBeenCalledWith(7);
+  });
+
+  it('passes tokens one at a time unless batched', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockImplementation(
+      async (
+        _messages: string,
+        _size: number,
+        _options: string,
+        _tools: string,
+        onToken: (token: string, tokenId: number) => void
+      ) => {
+        onToken('Hel', 1);
+        onToken('lo', 2);
+        return response;
+      }
+    );
+    const tokens: string[] = [];
+
+    await cactus.complete(messages, 1024, undefined, undefined, (t) =>
+      tokens.push(t)
+    );
+    expect(tokens).toEqual(['Hel', 'lo']);
+    expect(native.openTokenStream).not.toHaveBeenCalled();
+    expect(native.complete.mock.calls[0][5]).toBeUndefined();
+  });
+
+  it('opens no stream without a callback', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockResolvedValue(response);
+
+    await cactus.complete(messages, 1024);
+    expect(native.openTokenStream).not.toHaveBeenCalled();
+    expect(native.complete.mock.calls[0][5]).toBeUndefined();
+  });
+});
+
+describe('Cactus message serialization', () => {
+  beforeEach(() => {
+    jest.clearAllMocks();
+  });
+
+  it('serializes a message once across turns', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockResolvedValue(response);
+    const history = [{ role: 'user' as const, content: 'Hello' }];
+    const stringify = jest.spyOn(JSON, 'stringify');
+
+    await cactus.complete(history, 1024);
+    history.push({ role: 'user', content: 'And then?' });
+    await cactus.complete(history, 1024);
+
+    const serialized = stringify.mock.calls.filter(
+      ([value]) => value === history[0]
+    );
+    expect(serialized).toHaveLength(1);
+    expect(native.complete.mock.calls[1][0]).toBe(
+      '[{"role":"user","content":"Hello"},' +
+        '{"role":"user","content":"And then?"}]'
+    );
+    stringify.mockRestore();
+  });
+
+  it('serializes a message again after it changed in place', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockResolvedValue(response);
+    const message = { role: 'user' as const, content: 'Hello' };
+
+    await cactus.complete([message], 1024);
+    message.content = 'Goodbye';
+    await cactus.complete([message], 1024);
+
+    expect(native.complete.mock.calls[1][0]).toBe(
+      '[{"role":"user","content":"Goodbye"}]'
+    );
+  });
+});
+
+describe('Cactus.embedBatch', () => {
+  it('splits the native buffer into one embedding per text', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.embedBatch.mockResolvedValue(
+      new Float32Array([1, 2, 3, 4, 5, 6]).buffer
+    );
+
+    const embeddings = await cactus.embedBatch(['a', 'b', 'c'], 2048);
+    expect(native.embedBatch).toHaveBeenCalledWith(['a', 'b', 'c'], 2048);
+    expect(embeddings.map((embedding) => Array.from(embedding))).toEqual([
+      [1, 2],
+      [3, 4],
+      [5, 6],
+    ]);
+  });
+
+  it('returns nothing for no texts', async () => {
+    const cactus = new Cactus();
+    hybridCactus().embedBatch.mockResolvedValue(new ArrayBuffer(0));
+    await expect(cactus.embedBatch([], 2048)).resolves.toEqual([]);
+  });
+});
+
+describe('Cactus Float32 embeddings', () => {
+  it('views the native buffer without copying it', async () => {
+    const cactus = new Cactus();
+    const buffer = new Float32Array([0.5, -0.25]).buffer;
+    hybridCactus().embedFloat32.mockResolvedValue(buffer);
+
+    const embedding = await cactus.embedFloat32('Hello', 2048);
+    expect(embedding).toBeInstanceOf(Float32Array);
+    expect(embedding.buffer).toBe(buffer);
+    expect(Array.from(embedding)).toEqual([0.5, -0.25]);
+  });
+
+  it('passes audio paths without their scheme', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.audioEmbedFloat32.mockResolvedValue(new ArrayBuffer(8));
+
+    const embedding = await cactus.audioEmbedFloat32('file:///a.wav', 2048);
+    expect(native.audioEmbedFloat32).toHaveBeenCalledWith('/a.wav', 2048);
+    expect(embedding).toHaveLength(2);
+  });
+});
+
+describe('Cactus pixel images', () => {
+  beforeEach(() => {
+    jest.clearAllMocks();
+  });
+
+  it('writes a reused buffer again on every call', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockResolvedValue(response);
+    const pixels = {
+      data: new ArrayBuffer(2 * 2 * 4),
+      width: 2,
+      height: 2,
+      format: 'rgba' as const,
+    };
+    const message = { role: 'user' as const, content: 'What is this?' };
+
+    await cactus.complete([{ ...message, images: [pixels] }], 1024);
+    // A camera pipeline refills the same buffer with the next frame
+    new Uint8Array(pixels.data).fill(255);
+    await cactus.complete([{ ...message, images: [pixels] }], 1024);
+
+    expect(CactusUtil.writeImagePixels).toHaveBeenCalledTimes(2);
+    expect(CactusUtil.writeImagePixels).toHaveBeenCalledWith(
+      pixels,
+      expect.stringMatching(/^\/cactus\/images\/\d+$/),
+      128
+    );
+    const messages = JSON.parse(native.complete.mock.calls[1][0]);
+    expect(messages[0].images[0]).toMatch(/\/pixels\.png$/);
+  });
+});
+
+describe('Cactus resized images', () => {
+  beforeEach(() => {
+    jest.clearAllMocks();
+  });
+
+  it('resizes a path once across completions', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.complete.mockResolvedValue(response);
+    const message = {
+      role: 'user' as const,
+      content: 'What is this?',
+      images: ['file:///photos/cat.jpg'],
+    };
+
+    await cactus.complete([message], 1024);
+    await cactus.complete([message], 1024);
+
+    expect(CactusImage.resize).toHaveBeenCalledTimes(1);
+    expect(CactusImage.resize).toHaveBeenCalledWith(
+      '/photos/cat.jpg',
+      128,
+      128,
+      1
+    );
+    const messages = JSON.parse(native.complete.mock.calls[1][0]);
+    expect(messages[0].images).toEqual(['/photos/cat.jpg.resized.jpg']);
+  });
+
+  it('resizes again once a path falls out of the cache', async () => {
+    const cactus = new Cactus();
+    hybridCactus().complete.mockResolvedValue(response);
+    const image = (i: number) => ({
+      role: 'user' as const,
+      content: 'What is this?',
+      images: [`/photos/${i}.jpg`],
+    });
+
+    for (let i = 0; i <= 64; i++) {
+      await cactus.complete([image(i)], 1024);
+    }
+    await cactus.complete([image(64)], 1024);
+    expect(CactusImage.resize).toHaveBeenCalledTimes(65);
+
+    await cactus.complete([image(0)], 1024);
+    expect(CactusImage.resize).toHaveBeenCalledTimes(66);
+  });
+});
+
+describe('Cactus.watchLoadProgress', () => {
+  beforeEach(() => {
+    jest.useFakeTimers();
+    jest.clearAllMocks();
+  });
+
+  afterEach(() => {
+    jest.useRealTimers();
+  });
+
+  it('polls while the load runs and reports when it settles', async () => {
+    const cactus = new Cactus();
+    const native = hybridCactus();
+    native.getLoadProgress.mockReturnValue(0);
+    let finish: (value: number) => void = () => {};
+    const load = new Promise<number>((resolve) => (finish = resolve));
+    const progress: number[] = [];
+
+    const result = cactus.watchLoadProgress(load, (p) => progress.push(p));
+    jest.advanceTimersByTime(1000);
+    expect(progress.length).toBeGreaterThan(0);
+    expect(progress.every((p) => p === 0)).toBe(true);
+
+    native.getLoadProgress.mockReturnValue(1);
+    finish(2048);
+    await expect(result).resolves.toBe(2048);
+    expect(progress.at(-1)).toBe(1);
+
+    const reports = progress.length;
+    jest.advanceTimersByTime(1000);
+    expect(progress).toHaveLength(reports);
+  });
+});
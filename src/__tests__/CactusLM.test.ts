@@ -0,0 +1,143 @@
+import { CactusLM } from '../classes/CactusLM';
+import { Cactus } from '../native';
+import { RemoteLM } from '../api/RemoteLM';
+import { CactusConfig } from '../config/CactusConfig';
+import type {
+  CactusLMCompleteResult,
+  CactusLMLatencyPrediction,
+} from '../types/CactusLM';
+
+jest.mock('../native', () => ({
+  Cactus: jest.fn().mockImplementation(() => ({
+    setThermalGovernorEnabled: jest.fn(),
+    init: jest.fn().mockResolvedValue(2048),
+    complete: jest.fn(),
+    predictLatency: jest.fn(),
+    setMaxSessions: jest.fn().mockResolvedValue(undefined),
+  })),
+  CactusFileSystem: {
+    modelExists: jest.fn().mockResolvedValue(true),
+    getModelPath: jest.fn().mockResolvedValue('/models/qwen3-0.6'),
+  },
+}));
+jest.mock('../api/RemoteLM', () => ({ RemoteLM: { complete: jest.fn() } }));
+jest.mock('../api/Database', () => ({ Database: {} }));
+jest.mock('../telemetry/Telemetry', () => ({
+  Telemetry: { init: jest.fn(), logInit: jest.fn(), logCompletion: jest.fn() },
+}));
+
+const messages = [{ role: 'user' as const, content: 'Hello' }];
+const remoteResult: CactusLMCompleteResult = {
+  success: true,
+  response: 'Hi from remote',
+  timeToFirstTokenMs: 0,
+  totalTimeMs: 0,
+  tokensPerSecond: 0,
+  prefillTokens: 0,
+  decodeTokens: 0,
+  totalTokens: 0,
+};
+
+function prediction(
+  calibrated: boolean,
+  totalMs: number
+): CactusLMLatencyPrediction {
+  return {
+    promptTokens: 0,
+    prefillMs: 0,
+    decodeMs: totalMs,
+    totalMs,
+    thermalState: 'nominal',
+    calibrated,
+  };
+}
+
+function nativeCactus(): jest.Mocked<Cactus> {
+  const result = jest.mocked(Cactus).mock.results.at(-1);
+  if (!result) {
+    throw new Error('Cactus was not constructed');
+  }
+  return result.value;
+}
+
+function deferred<T>() {
+  let resolve: (value: T) => void = () => {};
+  let reject: (error: Error) => void = () => {};
+  const promise = new Promise<T>((res, rej) => {
+    resolve = res;
+    reject = rej;
+  });
+  return { promise, resolve, reject };
+}
+
+const settle = () => new Promise((resolve) => setImmediate(resolve));
+
+describe('CactusLM.complete', () => {
+  beforeEach(() => {
+    jest.clearAllMocks();
+    CactusConfig.cactusToken = 'token';
+  });
+
+  it('rejects a second call while remote-first routing runs', async () => {
+    const lm = new CactusLM();
+    nativeCactus().predictLatency.mockReturnValue(prediction(true, 60000));
+    const remote = deferred<CactusLMCompleteResult>();
+    jest.mocked(RemoteLM.complete).mockReturnValue(remote.promise);
+
+    const first = lm.complete({ messages, mode: 'hybrid' });
+    await expect(lm.complete({ messages, mode: 'hybrid' })).rejects.toThrow(
+      'CactusLM is already generating'
+    );
+
+    remote.resolve(remoteResult);
+    await expect(first).resolves.toBe(remoteResult);
+  });
+
+  it('calls remote once when remote-first and local fail', async () => {
+    const lm = new CactusLM();
+    nativeCactus().predictLatency.mockReturnValue(prediction(true, 60000));
+    nativeCactus().complete.mockRejectedValue(new Error('local failed'));
+    jest.mocked(RemoteLM.complete).mockRejectedValue(new Error('offline'));
+
+    await expect(lm.complete({ messages, mode: 'hybrid' })).rejects.toThrow(
+      'local failed'
+    );
+    expect(RemoteLM.complete).toHaveBeenCalledTimes(1);
+  });
+
+  it('stays generating until the remote fallback settles', async () => {
+    const lm = new CactusLM();
+    nativeCactus().predictLatency.mockReturnValue(prediction(false, 0));
+    nativeCactus().complete.mockRejectedValue(new Error('local failed'));
+    const remote = deferred<CactusLMCompleteResult>();
+    jest.mocked(RemoteLM.complete).mockReturnValue(remote.promise);
+
+    const first = lm.complete({ messages, mode: 'hybrid' });
+    await settle();
+    expect(RemoteLM.complete).toHaveBeenCalledTimes(1);
+    await expect(lm.complete({ messages, mode: 'hybrid' })).rejects.toThrow(
+      'CactusLM is already generating'
+    );
+
+    remote.reject(new Error('offline'));
+    await expect(first).rejects.toThrow('Remote completion error: offline');
+  });
+});
+
+describe('CactusLM sessions', () => {
+  beforeEach(() => {
+    jest.clearAllMocks();
+  });
+
+  it('leaves sessions disabled unless maxSessions is set', async () => {
+    const lm = new CactusLM();
+    await lm.init();
+    expect(nativeCactus().setMaxSessions).not.toHaveBeenCalled();
+  });
+
+  it('passes maxSessions on init', async () => {
+    const lm = new CactusLM({ maxSessions: 3 });
+    await lm.init();
+    expect(nativeCactus().setMaxSessions).toHaveBeenCalledWith(3);
+  });
+});
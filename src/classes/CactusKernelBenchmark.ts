@@ -0,0 +1,29 @@
+import { CactusUtil } from '../native';
+import type {
+  CactusKernelBenchmarkParams,
+  CactusKernelBenchmarkRun,
+} from '../types/CactusKernelBenchmark';
+
+export class CactusKernelBenchmark {
+  private static readonly defaultIterations = 5;
+
+  public static async run({
+    iterations = CactusKernelBenchmark.defaultIterations,
+  }: CactusKernelBenchmarkParams = {}): Promise<CactusKernelBenchmarkRun[]> {
+    const response = await CactusUtil.benchmarkKernels(iterations);
+
+    try {
+      return JSON.parse(response).map((run: any) => ({
+        kernel: run.kernel,
+        family: run.family,
+        shape: run.shape,
+        ms: run.ms,
+        gflops: run.gflops,
+        gbPerSecond: run.gb_per_second,
+        maxError: run.max_error,
+      }));
+    } catch {
+      throw new Error('Unable to parse kernel benchmark response');
+    }
+  }
+}
@@ -1,13 +1,24 @@
 import { Cactus, CactusFileSystem } from '../native';
 import type {
   CactusLMDownloadParams,
+  CactusLMInitParams,
   CactusLMCompleteParams,
   CactusLMCompleteResult,
+  CactusLMPredictLatencyParams,
+  CactusLMLatencyPrediction,
+  CactusLMBenchmarkParams,
+  CactusLMBenchmarkResult,
   CactusLMEmbedParams,
   CactusLMEmbedResult,
+  CactusLMEmbedFloat32Result,
+  CactusLMEmbedBatchParams,
+  CactusLMEmbedBatchResult,
   CactusLMImageEmbedParams,
   CactusLMImageEmbedResult,
+  CactusLMImageEmbedFloat32Result,
   CactusLMParams,
+  Message,
+  CompleteOptions,
 } from '../types/CactusLM';
 import type { CactusModel } from '../types/CactusModel';
 import { Telemetry } from '../telemetry/Telemetry';
@@ -20,12 +31,19 @@ export class CactusLM {
   private readonly cactus = new Cactus();
 
   private readonly model: string;
-  private readonly contextSize: number;
+  private readonly contextSize: number | 'auto';
   private readonly corpusDir?: string;
+  private readonly maxSessions?: number;
+  private readonly sessionMemoryBudget?: number;
+  private readonly slidingWindowSize?: number;
+  private readonly attentionSinkSize?: number;
+  private readonly embeddingCache: boolean;
 
   private isDownloading = false;
   private isInitialized = false;
   private isGenerating = false;
+  private initPromise?: Promise<void>;
+  private initializedContextSize = 0;
 
   private static readonly defaultModel = 'qwen3-0.6';
   private static readonly defaultContextSize = 2048;
@@ -33,16 +51,33 @@ export class CactusLM {
     maxTokens: 512,
   };
   private static readonly defaultCompleteMode = 'local';
+  private static readonly defaultMaxLocalLatencyMs = 10000;
   private static readonly defaultEmbedBufferSize = 2048;
 
   private static cactusModelsCache: CactusModel[] | null = null;
 
-  constructor({ model, contextSize, corpusDir }: CactusLMParams = {}) {
+  constructor({
+    model,
+    contextSize,
+    corpusDir,
+    maxSessions,
+    sessionMemoryBudget,
+    thermalGovernor,
+    slidingWindowSize,
+    attentionSinkSize,
+    embeddingCache,
+  }: CactusLMParams = {}) {
     Telemetry.init(CactusConfig.telemetryToken);
 
     this.model = model ?? CactusLM.defaultModel;
     this.contextSize = contextSize ?? CactusLM.defaultContextSize;
     this.corpusDir = corpusDir;
+    this.maxSessions = maxSessions;
+    this.sessionMemoryBudget = sessionMemoryBudget;
+    this.slidingWindowSize = slidingWindowSize;
+    this.attentionSinkSize = attentionSinkSize;
+    this.embeddingCache = embeddingCache ?? false;
+    this.cactus.setThermalGovernorEnabled(thermalGovernor ?? false);
   }
 
   public async download({
@@ -70,11 +105,31 @@ export class CactusLM {
     }
   }
 
-  public async init(): Promise<void> {
+  public async init({ onProgress }: CactusLMInitParams = {}): Promise<void> {
     if (this.isInitialized) {
+      onProgress?.(1.0);
       return;
     }
 
+    // Embeddings may run alongside a completion, so concurrent calls share a
+    // single initialization
+    if (!this.initPromise) {
+      this.initPromise = this.initModel().finally(() => {
+        this.initPromise = undefined;
+      });
+    }
+    if (!onProgress) {
+      return this.initPromise;
+    }
+    return this.cactus.watchLoadProgress(this.initPromise, onProgress);
+  }
+
+  public async getContextSize(): Promise<number> {
+    await this.init();
+    return this.initializedContextSize;
+  }
+
+  private async initModel(): Promise<void> {
     if (!(await CactusFileSystem.modelExists(this.model))) {
       throw new Error(`Model "${this.model}" is not downloaded`);
     }
@@ -82,7 +137,25 @@ export class CactusLM {
     const modelPath = await CactusFileSystem.getModelPath(this.model);
 
     try {
-      await this.cactus.init(modelPath, this.contextSize, this.corpusDir);
+      this.initializedContextSize = await this.cactus.init(
+        modelPath,
+        this.contextSize === 'auto' ? 0 : this.contextSize,
+        this.corpusDir,
+        this.slidingWindowSize,
+        this.attentionSinkSize
+      );
+      if (this.maxSessions !== undefined) {
+        await this.cactus.setMaxSessions(this.maxSessions);
+      }
+      if (this.sessionMemoryBudget !== undefined) {
+        await this.cactus.setSessionMemoryBudget(this.sessionMemoryBudget);
+      }
+      if (this.embeddingCache) {
+        const cactusDirectory = await CactusFileSystem.getCactusDirectory();
+        await this.cactus.setEmbeddingCache(
+          `${cactusDirectory}/embeddings/${this.model}`
+        );
+      }
       Telemetry.logInit(this.model, true);
       this.isInitialized = true;
     } catch (error) {
@@ -97,6 +170,7 @@ export class CactusLM {
     tools,
     onToken,
     mode,
+    maxLocalLatencyMs,
   }: CactusLMCompleteParams): Promise<CactusLMCompleteResult> {
     if (this.isGenerating) {
       throw new Error('CactusLM is already generating');
@@ -113,42 +187,79 @@ export class CactusLM {
       8 * (options.maxTokens ?? CactusLM.defaultCompleteOptions.maxTokens) +
       256;
 
+    this.isGenerating = true;
     try {
-      await this.init();
-
-      this.isGenerating = true;
-      const result = await this.cactus.complete(
-        messages,
-        responseBufferSize,
-        options,
-        toolsInternal,
-        onToken
-      );
-      Telemetry.logCompletion(
-        this.model,
-        result.success,
-        result.success ? undefined : result.response,
-        result
-      );
-      return result;
-    } catch (localError) {
-      if (mode === 'local') {
-        Telemetry.logCompletion(this.model, false, getErrorMessage(localError));
-        throw localError;
-      }
+      const remoteFirst =
+        mode === 'hybrid' &&
+        this.exceedsLocalLatency(
+          messages,
+          options,
+          maxLocalLatencyMs ?? CactusLM.defaultMaxLocalLatencyMs
+        );
 
-      Telemetry.logCompletion(
-        this.model,
-        false,
-        `Local completion error: ${getErrorMessage(localError)}. Falling back to remote completion.`
-      );
+      if (remoteFirst) {
+        try {
+          return await RemoteLM.complete(
+            messages,
+            options,
+            toolsInternal,
+            onToken
+          );
+        } catch (remoteError) {
+          Telemetry.logCompletion(
+            this.model,
+            false,
+            `Remote completion error: ${getErrorMessage(remoteError)}. Falling back to local completion.`
+          );
+        }
+      }
 
       try {
-        return RemoteLM.complete(messages, options, toolsInternal, onToken);
-      } catch (remoteError) {
-        throw new Error(
-          `Remote completion error: ${getErrorMessage(remoteError)}`
+        await this.init();
+
+        const result = await this.cactus.complete(
+          messages,
+          responseBufferSize,
+          options,
+          toolsInternal,
+          onToken
         );
+        Telemetry.logCompletion(
+          this.model,
+          result.success,
+          result.success ? undefined : result.response,
+          result
+        );
+        return result;
+      } catch (localError) {
+        // Remote was already tried and failed before falling back to local
+        if (mode === 'local' || remoteFirst) {
+          Telemetry.logCompletion(
+            this.model,
+            false,
+            getErrorMessage(localError)
+          );
+          throw localError;
+        }
+
+        Telemetry.logCompletion(
+          this.model,
+          false,
+          `Local completion error: ${getErrorMessage(localError)}. Falling back to remote completion.`
+        );
+
+        try {
+          return await RemoteLM.complete(
+            messages,
+            options,
+            toolsInternal,
+            onToken
+          );
+        } catch (remoteError) {
+          throw new Error(
+            `Remote completion error: ${getErrorMessage(remoteError)}`
+          );
+        }
       }
     } finally {
       this.isGenerating = false;
@@ -158,15 +269,28 @@ export class CactusLM {
   public async embed({
     text,
   }: CactusLMEmbedParams): Promise<CactusLMEmbedResult> {
-    if (this.isGenerating) {
-      throw new Error('CactusLM is already generating');
+    await this.init();
+
+    try {
+      const embedding = await this.cactus.embed(
+        text,
+        CactusLM.defaultEmbedBufferSize
+      );
+      Telemetry.logEmbedding(this.model, true);
+      return { embedding };
+    } catch (error) {
+      Telemetry.logEmbedding(this.model, false, getErrorMessage(error));
+      throw error;
     }
+  }
 
+  public async embedFloat32({
+    text,
+  }: CactusLMEmbedParams): Promise<CactusLMEmbedFloat32Result> {
     await this.init();
 
-    this.isGenerating = true;
     try {
-      const embedding = await this.cactus.embed(
+      const embedding = await this.cactus.embedFloat32(
         text,
         CactusLM.defaultEmbedBufferSize
       );
@@ -175,24 +299,41 @@ export class CactusLM {
     } catch (error) {
       Telemetry.logEmbedding(this.model, false, getErrorMessage(error));
       throw error;
-    } finally {
-      this.isGenerating = false;
+    }
+  }
+
+  public async embedBatch({
+    texts,
+  }: CactusLMEmbedBatchParams): Promise<CactusLMEmbedBatchResult> {
+    await this.init();
+
+    try {
+      const embeddings = await this.cactus.embedBatch(
+        texts,
+        CactusLM.defaultEmbedBufferSize
+      );
+      Telemetry.logEmbedding(this.model, true);
+      return { embeddings };
+    } catch (error) {
+      Telemetry.logEmbedding(this.model, false, getErrorMessage(error));
+      throw error;
     }
   }
 
   public async imageEmbed({
     imagePath,
+    imagePixels,
   }: CactusLMImageEmbedParams): Promise<CactusLMImageEmbedResult> {
-    if (this.isGenerating) {
-      throw new Error('CactusLM is already generating');
+    const image = imagePixels ?? imagePath;
+    if (!image) {
+      throw new Error('imagePath or imagePixels is required');
     }
 
     await this.init();
 
-    this.isGenerating = true;
     try {
       const embedding = await this.cactus.imageEmbed(
-        imagePath,
+        image,
         CactusLM.defaultEmbedBufferSize
       );
       Telemetry.logImageEmbedding(this.model, true);
@@ -200,15 +341,98 @@ export class CactusLM {
     } catch (error) {
       Telemetry.logImageEmbedding(this.model, false, getErrorMessage(error));
       throw error;
+    }
+  }
+
+  public async imageEmbedFloat32({
+    imagePath,
+    imagePixels,
+  }: CactusLMImageEmbedParams): Promise<CactusLMImageEmbedFloat32Result> {
+    const image = imagePixels ?? imagePath;
+    if (!image) {
+      throw new Error('imagePath or imagePixels is required');
+    }
+
+    await this.init();
+
+    try {
+      const embedding = await this.cactus.imageEmbedFloat32(
+        image,
+        CactusLM.defaultEmbedBufferSize
+      );
+      Telemetry.logImageEmbedding(this.model, true);
+      return { embedding };
+    } catch (error) {
+      Telemetry.logImageEmbedding(this.model, false, getErrorMessage(error));
+      throw error;
+    }
+  }
+
+  public async setSession(sessionId: string): Promise<void> {
+    if (this.isGenerating) {
+      throw new Error('CactusLM is already generating');
+    }
+
+    await this.init();
+
+    return this.cactus.setSession(sessionId);
+  }
+
+  public async deleteSession(sessionId: string): Promise<void> {
+    if (!this.isInitialized) {
+      return;
+    }
+
+    return this.cactus.deleteSession(sessionId);
+  }
+
+  public async benchmark(
+    params: CactusLMBenchmarkParams = {}
+  ): Promise<CactusLMBenchmarkResult> {
+    if (this.isGenerating) {
+      throw new Error('CactusLM is already generating');
+    }
+
+    await this.init();
+
+    this.isGenerating = true;
+    try {
+      return await this.cactus.benchmark(params);
     } finally {
       this.isGenerating = false;
     }
   }
 
+  public predictLatency({
+    messages,
+    options,
+  }: CactusLMPredictLatencyParams): CactusLMLatencyPrediction {
+    return this.cactus.predictLatency(
+      messages,
+      options?.maxTokens ?? CactusLM.defaultCompleteOptions.maxTokens
+    );
+  }
+
+  public getQueueDepth(): number {
+    return this.cactus.getQueueDepth();
+  }
+
+  public startTrace(): void {
+    this.cactus.startTrace();
+  }
+
+  public stopTrace(): string {
+    return this.cactus.stopTrace();
+  }
+
   public stop(): Promise<void> {
     return this.cactus.stop();
   }
 
+  public prefetchWeights(): Promise<void> {
+    return this.cactus.prefetchWeights();
+  }
+
   public async reset(): Promise<void> {
     await this.stop();
     return this.cactus.reset();
@@ -236,4 +460,17 @@ export class CactusLM {
     CactusLM.cactusModelsCache = models;
     return models;
   }
+
+  // Without a measured speed the local model is always tried first
+  private exceedsLocalLatency(
+    messages: Message[],
+    options: CompleteOptions,
+    maxLocalLatencyMs: number
+  ): boolean {
+    if (!CactusConfig.cactusToken) {
+      return false;
+    }
+    const prediction = this.predictLatency({ messages, options });
+    return prediction.calibrated && prediction.totalMs > maxLocalLatencyMs;
+  }
 }
@@ -0,0 +1,12 @@
+import { CactusUtil } from '../native';
+import type { CactusMetricsSnapshot } from '../types/CactusMetrics';
+
+export class CactusMetrics {
+  public static snapshot(): CactusMetricsSnapshot {
+    return JSON.parse(CactusUtil.getMetrics());
+  }
+
+  public static reset(): void {
+    CactusUtil.resetMetrics();
+  }
+}
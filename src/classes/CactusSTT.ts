@@ -1,4 +1,4 @@
-import { Cactus, CactusFileSystem } from '../native';
+import { Cactus, CactusFileSystem, CactusUtil } from '../native';
 import type {
   CactusSTTDownloadParams,
   CactusSTTTranscribeParams,
@@ -6,6 +6,10 @@ import type {
   CactusSTTParams,
   CactusSTTAudioEmbedParams,
   CactusSTTAudioEmbedResult,
+  CactusSTTAudioEmbedFloat32Result,
+  CactusSTTStreamTranscribeStartParams,
+  CactusSTTStreamTranscribeResult,
+  TranscribeOptions,
 } from '../types/CactusSTT';
 import type { CactusModel } from '../types/CactusModel';
 import { Telemetry } from '../telemetry/Telemetry';
@@ -13,6 +17,21 @@ import { CactusConfig } from '../config/CactusConfig';
 import { Database } from '../api/Database';
 import { getErrorMessage } from '../utils/error';
 
+interface TranscriptionStream {
+  prompt: string;
+  options: TranscribeOptions;
+  onTranscription?: (transcription: string) => void;
+  wavFile: string;
+  wavPath: string;
+  startTime: number;
+  committed: string;
+  windowSamples: number;
+  hasNewAudio: boolean;
+  stopped: boolean;
+  error?: unknown;
+  loop?: Promise<void>;
+}
+
 export class CactusSTT {
   private readonly cactus = new Cactus();
 
@@ -22,6 +41,7 @@ export class CactusSTT {
   private isDownloading = false;
   private isInitialized = false;
   private isGenerating = false;
+  private stream?: TranscriptionStream;
 
   private static readonly defaultModel = 'whisper-small';
   private static readonly defaultContextSize = 2048;
@@ -31,14 +51,34 @@ export class CactusSTT {
     maxTokens: 512,
   };
   private static readonly defaultEmbedBufferSize = 4096;
+  private static readonly emptyTranscription: CactusSTTTranscribeResult = {
+    success: true,
+    response: '',
+    timeToFirstTokenMs: 0,
+    totalTimeMs: 0,
+    tokensPerSecond: 0,
+    prefillTokens: 0,
+    decodeTokens: 0,
+    totalTokens: 0,
+    speechRatio: 0,
+  };
+  private static readonly longFormWindowSeconds = 30;
+  private static readonly streamStepMs = 1000;
+  // Whisper windows are 30s, one step is left for the audio pushed meanwhile.
+  // The native stream commits up to a quiet point in the last seconds.
+  private static readonly streamWindowSamples = 29 * 16000;
 
   private static cactusModelsCache: CactusModel[] | null = null;
+  // Numbers the files of each call, so calls on different instances never
+  // write or delete each other's files
+  private static fileCount = 0;
 
-  constructor({ model, contextSize }: CactusSTTParams = {}) {
+  constructor({ model, contextSize, thermalGovernor }: CactusSTTParams = {}) {
     Telemetry.init(CactusConfig.telemetryToken);
 
     this.model = model ?? CactusSTT.defaultModel;
     this.contextSize = contextSize ?? CactusSTT.defaultContextSize;
+    this.cactus.setThermalGovernorEnabled(thermalGovernor ?? false);
   }
 
   public async download({
@@ -91,6 +131,8 @@ export class CactusSTT {
     prompt,
     options,
     onToken,
+    longForm,
+    skipSilence,
   }: CactusSTTTranscribeParams): Promise<CactusSTTTranscribeResult> {
     if (this.isGenerating) {
       throw new Error('CactusSTT is already generating');
@@ -105,30 +147,274 @@ export class CactusSTT {
       8 * (options.maxTokens ?? CactusSTT.defaultTranscribeOptions.maxTokens) +
       256;
 
+    const speechFile = `speech_${CactusSTT.fileCount++}.wav`;
+
     this.isGenerating = true;
     try {
-      const result = await this.cactus.transcribe(
-        audioFilePath,
-        prompt,
-        responseBufferSize,
-        options,
-        onToken
-      );
+      let speechRatio: number | undefined;
+      if (skipSilence) {
+        const cactusDirectory = await CactusFileSystem.getCactusDirectory();
+        const speechFilePath = `${cactusDirectory}/${speechFile}`;
+        speechRatio = await CactusUtil.removeSilence(
+          audioFilePath,
+          speechFilePath
+        );
+        if (speechRatio === 0) {
+          return CactusSTT.emptyTranscription;
+        }
+        audioFilePath = speechFilePath;
+      }
+
+      const result = longForm
+        ? await this.transcribeWindows(
+            audioFilePath,
+            prompt,
+            responseBufferSize,
+            options,
+            onToken
+          )
+        : await this.cactus.transcribe(
+            audioFilePath,
+            prompt,
+            responseBufferSize,
+            options,
+            onToken
+          );
       Telemetry.logTranscribe(
         this.model,
         result.success,
         result.success ? undefined : result.response,
         result
       );
-      return result;
+      return speechRatio === undefined ? result : { ...result, speechRatio };
     } catch (error) {
       Telemetry.logTranscribe(this.model, false, getErrorMessage(error));
       throw error;
     } finally {
+      if (skipSilence) {
+        await CactusFileSystem.deleteFile(speechFile).catch(() => {});
+      }
+      this.isGenerating = false;
+    }
+  }
+
+  private async transcribeWindows(
+    audioFilePath: string,
+    prompt: string,
+    responseBufferSize: number,
+    options: TranscribeOptions,
+    onToken?: (token: string) => void
+  ): Promise<CactusSTTTranscribeResult> {
+    const windowDirectory = `windows_${CactusSTT.fileCount++}`;
+    const windowDir = `${await CactusFileSystem.getCactusDirectory()}/${windowDirectory}`;
+    const windowPaths = await CactusUtil.splitAudio(
+      audioFilePath,
+      windowDir,
+      CactusSTT.longFormWindowSeconds
+    );
+
+    // The timeout covers the whole audio rather than each window
+    const deadline =
+      options.timeoutMs !== undefined
+        ? Date.now() + options.timeoutMs
+        : undefined;
+
+    try {
+      const results: CactusSTTTranscribeResult[] = [];
+      for (const windowPath of windowPaths) {
+        const timeoutMs =
+          deadline !== undefined
+            ? Math.max(deadline - Date.now(), 1)
+            : undefined;
+        if (results.length > 0) {
+          onToken?.(' ');
+        }
+        const result = await this.cactus.transcribe(
+          windowPath,
+          prompt,
+          responseBufferSize,
+          { ...options, timeoutMs },
+          onToken
+        );
+        if (!result.success) {
+          return result;
+        }
+        results.push(result);
+        if (result.timedOut) {
+          break;
+        }
+      }
+
+      const sum = (key: 'totalTimeMs' | 'prefillTokens' | 'decodeTokens') =>
+        results.reduce((total, result) => total + result[key], 0);
+      const decodeTimeMs = results.reduce(
+        (total, result) =>
+          total +
+          (result.tokensPerSecond > 0
+            ? (1000 * result.decodeTokens) / result.tokensPerSecond
+            : 0),
+        0
+      );
+      const first = results[0];
+      const last = results[results.length - 1];
+      if (!first || !last) {
+        throw new Error('Audio file has no audio data');
+      }
+
+      return {
+        success: true,
+        response: results.map((result) => result.response.trim()).join(' '),
+        timeToFirstTokenMs: first.timeToFirstTokenMs,
+        totalTimeMs: sum('totalTimeMs'),
+        tokensPerSecond:
+          decodeTimeMs > 0 ? (1000 * sum('decodeTokens')) / decodeTimeMs : 0,
+        prefillTokens: sum('prefillTokens'),
+        decodeTokens: sum('decodeTokens'),
+        totalTokens: sum('prefillTokens') + sum('decodeTokens'),
+        queueWaitMs: first.queueWaitMs,
+        thermalState: last.thermalState,
+        decodeCapTokensPerSecond: last.decodeCapTokensPerSecond,
+        timedOut: last.timedOut,
+      };
+    } finally {
+      await CactusFileSystem.deleteFile(windowDirectory).catch(() => {});
+    }
+  }
+
+  public async streamTranscribeStart({
+    prompt,
+    options,
+    onTranscription,
+  }: CactusSTTStreamTranscribeStartParams = {}): Promise<void> {
+    if (this.isGenerating) {
+      throw new Error('CactusSTT is already generating');
+    }
+
+    await this.init();
+
+    const wavFile = `stream_${CactusSTT.fileCount++}.wav`;
+    const wavPath = `${await CactusFileSystem.getCactusDirectory()}/${wavFile}`;
+
+    this.isGenerating = true;
+    this.cactus.transcribeStreamClear();
+
+    const stream: TranscriptionStream = {
+      prompt: prompt ?? CactusSTT.defaultPrompt,
+      options: { ...CactusSTT.defaultTranscribeOptions, ...options },
+      onTranscription,
+      wavFile,
+      wavPath,
+      startTime: Date.now(),
+      committed: '',
+      windowSamples: 0,
+      hasNewAudio: false,
+      stopped: false,
+    };
+    stream.loop = this.runTranscriptionStream(stream);
+    this.stream = stream;
+  }
+
+  public streamTranscribeInsert(audio: Float32Array): void {
+    if (!this.stream) {
+      throw new Error('CactusSTT is not streaming');
+    }
+
+    this.cactus.transcribeStreamPush(audio);
+    this.stream.windowSamples += audio.length;
+    this.stream.hasNewAudio = true;
+  }
+
+  public async streamTranscribeStop(): Promise<CactusSTTStreamTranscribeResult> {
+    const stream = this.stream;
+    if (!stream) {
+      throw new Error('CactusSTT is not streaming');
+    }
+
+    stream.stopped = true;
+    try {
+      await stream.loop;
+      if (stream.error) {
+        throw stream.error;
+      }
+      // A long window is committed up to a quiet point, the rest goes next
+      let committed = stream.windowSamples;
+      while (committed > 0 && stream.windowSamples > 0) {
+        committed = await this.transcribeStreamWindow(stream, true);
+      }
+      return {
+        success: true,
+        response: stream.committed,
+        totalTimeMs: Date.now() - stream.startTime,
+      };
+    } finally {
+      this.cactus.transcribeStreamClear();
+      await CactusFileSystem.deleteFile(stream.wavFile).catch(() => {});
+      this.stream = undefined;
       this.isGenerating = false;
     }
   }
 
+  private async runTranscriptionStream(
+    stream: TranscriptionStream
+  ): Promise<void> {
+    while (!stream.stopped) {
+      await new Promise((resolve) =>
+        setTimeout(resolve, CactusSTT.streamStepMs)
+      );
+      if (stream.stopped || !stream.hasNewAudio) {
+        continue;
+      }
+
+      try {
+        await this.transcribeStreamWindow(stream, false);
+      } catch (error) {
+        stream.error = error;
+        return;
+      }
+    }
+  }
+
+  // Transcribes the audio since the last committed window and returns its
+  // length in samples. Full windows are committed, so the cost of a step
+  // stays bounded however long the stream runs.
+  private async transcribeStreamWindow(
+    stream: TranscriptionStream,
+    final: boolean
+  ): Promise<number> {
+    const commit =
+      final || stream.windowSamples >= CactusSTT.streamWindowSamples;
+
+    stream.hasNewAudio = false;
+    const samples = await this.cactus.transcribeStreamWrite(
+      stream.wavPath,
+      commit
+    );
+    if (commit) {
+      stream.windowSamples -= samples;
+    }
+    if (samples === 0) {
+      return 0;
+    }
+
+    const maxTokens =
+      stream.options.maxTokens ?? CactusSTT.defaultTranscribeOptions.maxTokens;
+    const result = await this.cactus.transcribe(
+      stream.wavPath,
+      stream.prompt,
+      8 * maxTokens + 256,
+      stream.options
+    );
+
+    const transcription = [stream.committed, result.response.trim()]
+      .filter(Boolean)
+      .join(' ');
+    if (commit) {
+      stream.committed = transcription;
+    }
+    stream.onTranscription?.(transcription);
+    return samples;
+  }
+
   public async audioEmbed({
     audioPath,
   }: CactusSTTAudioEmbedParams): Promise<CactusSTTAudioEmbedResult> {
@@ -154,10 +440,47 @@ export class CactusSTT {
     }
   }
 
+  public async audioEmbedFloat32({
+    audioPath,
+  }: CactusSTTAudioEmbedParams): Promise<CactusSTTAudioEmbedFloat32Result> {
+    if (this.isGenerating) {
+      throw new Error('CactusSTT is already generating');
+    }
+
+    await this.init();
+
+    this.isGenerating = true;
+    try {
+      const embedding = await this.cactus.audioEmbedFloat32(
+        audioPath,
+        CactusSTT.defaultEmbedBufferSize
+      );
+      Telemetry.logAudioEmbedding(this.model, true);
+      return { embedding };
+    } catch (error) {
+      Telemetry.logAudioEmbedding(this.model, false, getErrorMessage(error));
+      throw error;
+    } finally {
+      this.isGenerating = false;
+    }
+  }
+
+  public startTrace(): void {
+    this.cactus.startTrace();
+  }
+
+  public stopTrace(): string {
+    return this.cactus.stopTrace();
+  }
+
   public stop(): Promise<void> {
     return this.cactus.stop();
   }
 
+  public prefetchWeights(): Promise<void> {
+    return this.cactus.prefetchWeights();
+  }
+
   public async reset(): Promise<void> {
     await this.stop();
     return this.cactus.reset();
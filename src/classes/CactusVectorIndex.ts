@@ -0,0 +1,96 @@
+import { CactusFileSystem, CactusIndex } from '../native';
+import type {
+  CactusVectorIndexParams,
+  CactusVectorIndexAddParams,
+  CactusVectorIndexDeleteParams,
+  CactusVectorIndexQueryParams,
+  CactusVectorIndexQueryResult,
+} from '../types/CactusVectorIndex';
+
+export class CactusVectorIndex {
+  private readonly cactusIndex = new CactusIndex();
+
+  private readonly name: string;
+  private readonly embeddingDim: number;
+
+  private openPromise?: Promise<void>;
+
+  private static readonly defaultK = 5;
+  private static readonly defaultProbes = 8;
+
+  constructor({ name, embeddingDim }: CactusVectorIndexParams) {
+    this.name = name;
+    this.embeddingDim = embeddingDim;
+  }
+
+  public async add({
+    ids,
+    embeddings,
+  }: CactusVectorIndexAddParams): Promise<void> {
+    if (ids.length !== embeddings.length) {
+      throw new Error('ids and embeddings must have the same length');
+    }
+
+    // Sent to native as one contiguous buffer
+    const flat = new Float32Array(ids.length * this.embeddingDim);
+    embeddings.forEach((embedding, index) => {
+      if (embedding.length !== this.embeddingDim) {
+        throw new Error('Embedding has the wrong dimension');
+      }
+      flat.set(embedding, index * this.embeddingDim);
+    });
+
+    await this.open();
+    await this.cactusIndex.add(ids, flat);
+  }
+
+  public async delete({ ids }: CactusVectorIndexDeleteParams): Promise<void> {
+    await this.open();
+    await this.cactusIndex.remove(ids);
+  }
+
+  public async query({
+    embedding,
+    k = CactusVectorIndex.defaultK,
+    probes = CactusVectorIndex.defaultProbes,
+  }: CactusVectorIndexQueryParams): Promise<CactusVectorIndexQueryResult> {
+    await this.open();
+    return this.cactusIndex.query(
+      embedding instanceof Float32Array
+        ? embedding
+        : new Float32Array(embedding),
+      k,
+      probes
+    );
+  }
+
+  public async getSize(): Promise<number> {
+    await this.open();
+    return this.cactusIndex.getSize();
+  }
+
+  public async destroy(): Promise<void> {
+    const openPromise = this.openPromise;
+    this.openPromise = undefined;
+    await openPromise?.catch(() => {});
+    await this.cactusIndex.close();
+  }
+
+  private open(): Promise<void> {
+    // Concurrent calls share a single open
+    if (!this.openPromise) {
+      this.openPromise = CactusFileSystem.getCactusDirectory()
+        .then((cactusDirectory) =>
+          this.cactusIndex.open(
+            `${cactusDirectory}/indexes/${this.name}.index`,
+            this.embeddingDim
+          )
+        )
+        .catch((error) => {
+          this.openPromise = undefined;
+          throw error;
+        });
+    }
+    return this.openPromise;
+  }
+}
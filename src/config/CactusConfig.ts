@@ -5,4 +5,7 @@ export class CactusConfig {
 
   // Hybrid mode
   public static cactusToken?: string;
+
+  // Memory budget in bytes shared by all loaded models, 0 for no limit
+  public static modelMemoryBudget: number = 0;
 }
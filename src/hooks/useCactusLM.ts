@@ -5,12 +5,19 @@ import { getErrorMessage } from '../utils/error';
 import type {
   CactusLMParams,
   CactusLMCompleteResult,
+  CactusLMBenchmarkParams,
+  CactusLMBenchmarkResult,
   CactusLMEmbedParams,
   CactusLMEmbedResult,
+  CactusLMEmbedFloat32Result,
+  CactusLMEmbedBatchParams,
+  CactusLMEmbedBatchResult,
   CactusLMImageEmbedParams,
   CactusLMImageEmbedResult,
+  CactusLMImageEmbedFloat32Result,
   CactusLMCompleteParams,
   CactusLMDownloadParams,
+  CactusLMInitParams,
 } from '../types/CactusLM';
 import type { CactusModel } from '../types/CactusModel';
 
@@ -18,15 +25,33 @@ export const useCactusLM = ({
   model = 'qwen3-0.6',
   contextSize = 2048,
   corpusDir = undefined,
+  maxSessions = undefined,
+  sessionMemoryBudget = undefined,
+  thermalGovernor = false,
+  slidingWindowSize = undefined,
+  attentionSinkSize = undefined,
+  embeddingCache = false,
 }: CactusLMParams = {}) => {
   const [cactusLM, setCactusLM] = useState(
-    () => new CactusLM({ model, contextSize, corpusDir })
+    () =>
+      new CactusLM({
+        model,
+        contextSize,
+        corpusDir,
+        maxSessions,
+        sessionMemoryBudget,
+        thermalGovernor,
+        slidingWindowSize,
+        attentionSinkSize,
+        embeddingCache,
+      })
   );
 
   // State
   const [completion, setCompletion] = useState('');
   const [isGenerating, setIsGenerating] = useState(false);
   const [isInitializing, setIsInitializing] = useState(false);
+  const [initProgress, setInitProgress] = useState(0);
   const [isDownloaded, setIsDownloaded] = useState(false);
   const [isDownloading, setIsDownloading] = useState(false);
   const [downloadProgress, setDownloadProgress] = useState(0);
@@ -40,11 +65,24 @@ export const useCactusLM = ({
   }, [model]);
 
   useEffect(() => {
-    setCactusLM(new CactusLM({ model, contextSize, corpusDir }));
+    setCactusLM(
+      new CactusLM({
+        model,
+        contextSize,
+        corpusDir,
+        maxSessions,
+        sessionMemoryBudget,
+        thermalGovernor,
+        slidingWindowSize,
+        attentionSinkSize,
+        embeddingCache,
+      })
+    );
 
     setCompletion('');
     setIsGenerating(false);
     setIsInitializing(false);
+    setInitProgress(0);
     setIsDownloaded(false);
     setIsDownloading(false);
     setDownloadProgress(0);
@@ -69,7 +107,17 @@ export const useCactusLM = ({
     return () => {
       mounted = false;
     };
-  }, [model, contextSize, corpusDir]);
+  }, [
+    model,
+    contextSize,
+    corpusDir,
+    maxSessions,
+    sessionMemoryBudget,
+    thermalGovernor,
+    slidingWindowSize,
+    attentionSinkSize,
+    embeddingCache,
+  ]);
 
   useEffect(() => {
     return () => {
@@ -144,24 +192,32 @@ export const useCactusLM = ({
     [cactusLM, isDownloading, isDownloaded]
   );
 
-  const init = useCallback(async () => {
-    if (isInitializing) {
-      const message = 'CactusLM is already initializing';
-      setError(message);
-      throw new Error(message);
-    }
+  const init = useCallback(
+    async ({ onProgress }: CactusLMInitParams = {}) => {
+      if (isInitializing) {
+        const message = 'CactusLM is already initializing';
+        setError(message);
+        throw new Error(message);
+      }
 
-    setError(null);
-    setIsInitializing(true);
-    try {
-      await cactusLM.init();
-    } catch (e) {
-      setError(getErrorMessage(e));
-      throw e;
-    } finally {
-      setIsInitializing(false);
-    }
-  }, [cactusLM, isInitializing]);
+      setError(null);
+      setIsInitializing(true);
+      try {
+        await cactusLM.init({
+          onProgress: (progress) => {
+            setInitProgress(progress);
+            onProgress?.(progress);
+          },
+        });
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setIsInitializing(false);
+      }
+    },
+    [cactusLM, isInitializing]
+  );
 
   const complete = useCallback(
     async ({
@@ -170,6 +226,7 @@ export const useCactusLM = ({
       tools,
       onToken,
       mode,
+      maxLocalLatencyMs,
     }: CactusLMCompleteParams): Promise<CactusLMCompleteResult> => {
       if (isGenerating) {
         const message = 'CactusLM is already generating';
@@ -190,6 +247,7 @@ export const useCactusLM = ({
             onToken?.(token);
           },
           mode,
+          maxLocalLatencyMs,
         });
       } catch (e) {
         setError(getErrorMessage(e));
@@ -223,9 +281,58 @@ export const useCactusLM = ({
     [cactusLM, isGenerating]
   );
 
+  const embedFloat32 = useCallback(
+    async ({
+      text,
+    }: CactusLMEmbedParams): Promise<CactusLMEmbedFloat32Result> => {
+      if (isGenerating) {
+        const message = 'CactusLM is already generating';
+        setError(message);
+        throw new Error(message);
+      }
+
+      setError(null);
+      setIsGenerating(true);
+      try {
+        return await cactusLM.embedFloat32({ text });
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setIsGenerating(false);
+      }
+    },
+    [cactusLM, isGenerating]
+  );
+
+  const embedBatch = useCallback(
+    async ({
+      texts,
+    }: CactusLMEmbedBatchParams): Promise<CactusLMEmbedBatchResult> => {
+      if (isGenerating) {
+        const message = 'CactusLM is already generating';
+        setError(message);
+        throw new Error(message);
+      }
+
+      setError(null);
+      setIsGenerating(true);
+      try {
+        return await cactusLM.embedBatch({ texts });
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setIsGenerating(false);
+      }
+    },
+    [cactusLM, isGenerating]
+  );
+
   const imageEmbed = useCallback(
     async ({
       imagePath,
+      imagePixels,
     }: CactusLMImageEmbedParams): Promise<CactusLMImageEmbedResult> => {
       if (isGenerating) {
         const message = 'CactusLM is already generating';
@@ -236,7 +343,90 @@ export const useCactusLM = ({
       setError(null);
       setIsGenerating(true);
       try {
-        return await cactusLM.imageEmbed({ imagePath });
+        return await cactusLM.imageEmbed({ imagePath, imagePixels });
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setIsGenerating(false);
+      }
+    },
+    [cactusLM, isGenerating]
+  );
+
+  const imageEmbedFloat32 = useCallback(
+    async ({
+      imagePath,
+      imagePixels,
+    }: CactusLMImageEmbedParams): Promise<CactusLMImageEmbedFloat32Result> => {
+      if (isGenerating) {
+        const message = 'CactusLM is already generating';
+        setError(message);
+        throw new Error(message);
+      }
+
+      setError(null);
+      setIsGenerating(true);
+      try {
+        return await cactusLM.imageEmbedFloat32({ imagePath, imagePixels });
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setIsGenerating(false);
+      }
+    },
+    [cactusLM, isGenerating]
+  );
+
+  const setSession = useCallback(
+    async (sessionId: string) => {
+      if (isGenerating) {
+        const message = 'CactusLM is already generating';
+        setError(message);
+        throw new Error(message);
+      }
+
+      setError(null);
+      try {
+        await cactusLM.setSession(sessionId);
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setCompletion('');
+      }
+    },
+    [cactusLM, isGenerating]
+  );
+
+  const deleteSession = useCallback(
+    async (sessionId: string) => {
+      setError(null);
+      try {
+        await cactusLM.deleteSession(sessionId);
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      }
+    },
+    [cactusLM]
+  );
+
+  const benchmark = useCallback(
+    async (
+      params: CactusLMBenchmarkParams = {}
+    ): Promise<CactusLMBenchmarkResult> => {
+      if (isGenerating) {
+        const message = 'CactusLM is already generating';
+        setError(message);
+        throw new Error(message);
+      }
+
+      setError(null);
+      setIsGenerating(true);
+      try {
+        return await cactusLM.benchmark(params);
       } catch (e) {
         setError(getErrorMessage(e));
         throw e;
@@ -295,6 +485,7 @@ export const useCactusLM = ({
     completion,
     isGenerating,
     isInitializing,
+    initProgress,
     isDownloaded,
     isDownloading,
     downloadProgress,
@@ -304,7 +495,13 @@ export const useCactusLM = ({
     init,
     complete,
     embed,
+    embedFloat32,
+    embedBatch,
     imageEmbed,
+    imageEmbedFloat32,
+    setSession,
+    deleteSession,
+    benchmark,
     reset,
     stop,
     destroy,
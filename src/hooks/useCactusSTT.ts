@@ -9,15 +9,19 @@ import type {
   CactusSTTDownloadParams,
   CactusSTTAudioEmbedParams,
   CactusSTTAudioEmbedResult,
+  CactusSTTAudioEmbedFloat32Result,
+  CactusSTTStreamTranscribeStartParams,
+  CactusSTTStreamTranscribeResult,
 } from '../types/CactusSTT';
 import type { CactusModel } from '../types/CactusModel';
 
 export const useCactusSTT = ({
   model = 'whisper-small',
   contextSize = 2048,
+  thermalGovernor = false,
 }: CactusSTTParams = {}) => {
   const [cactusSTT, setCactusSTT] = useState(
-    () => new CactusSTT({ model, contextSize })
+    () => new CactusSTT({ model, contextSize, thermalGovernor })
   );
 
   // State
@@ -37,7 +41,7 @@ export const useCactusSTT = ({
   }, [model]);
 
   useEffect(() => {
-    setCactusSTT(new CactusSTT({ model, contextSize }));
+    setCactusSTT(new CactusSTT({ model, contextSize, thermalGovernor }));
 
     setTranscription('');
     setIsGenerating(false);
@@ -66,7 +70,7 @@ export const useCactusSTT = ({
     return () => {
       mounted = false;
     };
-  }, [model, contextSize]);
+  }, [model, contextSize, thermalGovernor]);
 
   useEffect(() => {
     return () => {
@@ -166,6 +170,8 @@ export const useCactusSTT = ({
       prompt,
       options,
       onToken,
+      longForm,
+      skipSilence,
     }: CactusSTTTranscribeParams): Promise<CactusSTTTranscribeResult> => {
       if (isGenerating) {
         const message = 'CactusSTT is already generating';
@@ -185,6 +191,8 @@ export const useCactusSTT = ({
             setTranscription((prev) => prev + token);
             onToken?.(token);
           },
+          longForm,
+          skipSilence,
         });
       } catch (e) {
         setError(getErrorMessage(e));
@@ -196,6 +204,66 @@ export const useCactusSTT = ({
     [cactusSTT, isGenerating]
   );
 
+  const streamTranscribeStart = useCallback(
+    async ({
+      prompt,
+      options,
+      onTranscription,
+    }: CactusSTTStreamTranscribeStartParams = {}): Promise<void> => {
+      if (isGenerating) {
+        const message = 'CactusSTT is already generating';
+        setError(message);
+        throw new Error(message);
+      }
+
+      setError(null);
+      setTranscription('');
+      setIsGenerating(true);
+      try {
+        await cactusSTT.streamTranscribeStart({
+          prompt,
+          options,
+          onTranscription: (value) => {
+            setTranscription(value);
+            onTranscription?.(value);
+          },
+        });
+      } catch (e) {
+        setError(getErrorMessage(e));
+        setIsGenerating(false);
+        throw e;
+      }
+    },
+    [cactusSTT, isGenerating]
+  );
+
+  const streamTranscribeInsert = useCallback(
+    (audio: Float32Array) => {
+      try {
+        cactusSTT.streamTranscribeInsert(audio);
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      }
+    },
+    [cactusSTT]
+  );
+
+  const streamTranscribeStop =
+    useCallback(async (): Promise<CactusSTTStreamTranscribeResult> => {
+      setError(null);
+      try {
+        const result = await cactusSTT.streamTranscribeStop();
+        setTranscription(result.response);
+        return result;
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setIsGenerating(false);
+      }
+    }, [cactusSTT]);
+
   const audioEmbed = useCallback(
     async ({
       audioPath,
@@ -220,6 +288,30 @@ export const useCactusSTT = ({
     [cactusSTT, isGenerating]
   );
 
+  const audioEmbedFloat32 = useCallback(
+    async ({
+      audioPath,
+    }: CactusSTTAudioEmbedParams): Promise<CactusSTTAudioEmbedFloat32Result> => {
+      if (isGenerating) {
+        const message = 'CactusSTT is already generating';
+        setError(message);
+        throw new Error(message);
+      }
+
+      setError(null);
+      setIsGenerating(true);
+      try {
+        return await cactusSTT.audioEmbedFloat32({ audioPath });
+      } catch (e) {
+        setError(getErrorMessage(e));
+        throw e;
+      } finally {
+        setIsGenerating(false);
+      }
+    },
+    [cactusSTT, isGenerating]
+  );
+
   const stop = useCallback(async () => {
     setError(null);
     try {
@@ -276,7 +368,11 @@ export const useCactusSTT = ({
     download,
     init,
     transcribe,
+    streamTranscribeStart,
+    streamTranscribeInsert,
+    streamTranscribeStop,
     audioEmbed,
+    audioEmbedFloat32,
     reset,
     stop,
     destroy,
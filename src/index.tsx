@@ -1,6 +1,9 @@
 // Classes
 export { CactusLM } from './classes/CactusLM';
 export { CactusSTT } from './classes/CactusSTT';
+export { CactusVectorIndex } from './classes/CactusVectorIndex';
+export { CactusMetrics } from './classes/CactusMetrics';
+export { CactusKernelBenchmark } from './classes/CactusKernelBenchmark';
 
 // Hooks
 export { useCactusLM } from './hooks/useCactusLM';
@@ -11,15 +14,26 @@ export type { CactusModel } from './types/CactusModel';
 export type {
   CactusLMParams,
   CactusLMDownloadParams,
+  CactusLMInitParams,
   Message,
   CompleteOptions,
+  CactusImagePixels,
   Tool,
   CactusLMCompleteParams,
   CactusLMCompleteResult,
+  CactusLMPredictLatencyParams,
+  CactusLMLatencyPrediction,
   CactusLMEmbedParams,
   CactusLMEmbedResult,
+  CactusLMEmbedFloat32Result,
+  CactusLMEmbedBatchParams,
+  CactusLMEmbedBatchResult,
   CactusLMImageEmbedParams,
   CactusLMImageEmbedResult,
+  CactusLMImageEmbedFloat32Result,
+  CactusLMBenchmarkParams,
+  CactusLMBenchmarkLatency,
+  CactusLMBenchmarkResult,
 } from './types/CactusLM';
 export type {
   CactusSTTParams,
@@ -27,9 +41,28 @@ export type {
   TranscribeOptions,
   CactusSTTTranscribeParams,
   CactusSTTTranscribeResult,
+  CactusSTTStreamTranscribeStartParams,
+  CactusSTTStreamTranscribeResult,
   CactusSTTAudioEmbedParams,
   CactusSTTAudioEmbedResult,
+  CactusSTTAudioEmbedFloat32Result,
 } from './types/CactusSTT';
+export type {
+  CactusVectorIndexParams,
+  CactusVectorIndexAddParams,
+  CactusVectorIndexDeleteParams,
+  CactusVectorIndexQueryParams,
+  CactusVectorIndexQueryResult,
+} from './types/CactusVectorIndex';
+export type {
+  CactusMetricsGauge,
+  CactusMetricsHistogram,
+  CactusMetricsSnapshot,
+} from './types/CactusMetrics';
+export type {
+  CactusKernelBenchmarkParams,
+  CactusKernelBenchmarkRun,
+} from './types/CactusKernelBenchmark';
 
 // Config
 export { CactusConfig } from './config/CactusConfig';
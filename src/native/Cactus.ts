@@ -1,8 +1,15 @@
 import { NitroModules } from 'react-native-nitro-modules';
 import type { Cactus as CactusSpec } from '../specs/Cactus.nitro';
+import { CactusFileSystem } from './CactusFileSystem';
 import { CactusImage } from './CactusImage';
+import { CactusUtil } from './CactusUtil';
+import { CactusConfig } from '../config/CactusConfig';
 import type {
+  CactusLMBenchmarkParams,
+  CactusLMBenchmarkResult,
   CactusLMCompleteResult,
+  CactusLMLatencyPrediction,
+  CactusImagePixels,
   Message,
   CompleteOptions,
   Tool,
@@ -16,12 +23,57 @@ export class Cactus {
   private readonly hybridCactus =
     NitroModules.createHybridObject<CactusSpec>('Cactus');
 
-  public init(
+  // Resized copies are reused so that the serialized history stays identical
+  // between turns and the native prefix cache can be reused. Only the most
+  // recently used images are kept, in insertion order.
+  private readonly resizedImages = new Map<string, string>();
+  // Messages without images are serialized once per message object, so a
+  // turn only serializes the messages appended since the previous one
+  private serializedMessages = new WeakMap<
+    Message,
+    { role: Message['role']; content?: string; json: string }
+  >();
+  private readonly imageDirectory = `images/${Cactus.instanceCount++}`;
+  private embedCount = 0;
+
+  private static instanceCount = 0;
+  private static readonly tokenDrainIntervalMs = 16;
+  private static readonly loadProgressIntervalMs = 100;
+  private static readonly maxResizedImages = 64;
+
+  public async init(
     modelPath: string,
     contextSize: number,
-    corpusDir?: string
-  ): Promise<void> {
-    return this.hybridCactus.init(modelPath, contextSize, corpusDir);
+    corpusDir?: string,
+    kvWindowSize?: number,
+    kvSinkSize?: number
+  ): Promise<number> {
+    await CactusUtil.setModelMemoryBudget(CactusConfig.modelMemoryBudget);
+    CactusUtil.watchMemoryPressure();
+    return this.hybridCactus.init(
+      modelPath,
+      contextSize,
+      corpusDir,
+      kvWindowSize,
+      kvSinkSize
+    );
+  }
+
+  // Loading runs on a native thread, so its progress is polled while run is
+  // pending
+  public async watchLoadProgress<T>(
+    run: Promise<T>,
+    onProgress: (progress: number) => void
+  ): Promise<T> {
+    const report = () => onProgress(this.hybridCactus.getLoadProgress());
+    const interval = setInterval(report, Cactus.loadProgressIntervalMs);
+    try {
+      const result = await run;
+      report();
+      return result;
+    } finally {
+      clearInterval(interval);
+    }
   }
 
   public async complete(
@@ -29,7 +81,7 @@ export class Cactus {
     responseBufferSize: number,
     options?: CompleteOptions,
     tools?: { type: 'function'; function: Tool }[],
-    callback?: (token: string, tokenId: number) => void
+    callback?: (token: string) => void
   ): Promise<CactusLMCompleteResult> {
     const messagesInternal: Message[] = [];
     for (const message of messages) {
@@ -38,19 +90,45 @@ export class Cactus {
         continue;
       }
       const resizedImages: string[] = [];
-      for (const imagePath of message.images) {
-        const resizedImage = await CactusImage.resize(
-          imagePath.replace('file://', ''),
-          128,
-          128,
-          1
-        );
+      for (const image of message.images) {
+        if (typeof image !== 'string') {
+          // Not cached by buffer, as camera pipelines refill one buffer in
+          // place. The file is named after its content, so the same image
+          // still maps to the same path and is only written once.
+          resizedImages.push(
+            await this.writeImagePixels(image, this.imageDirectory)
+          );
+          continue;
+        }
+
+        let resizedImage = this.resizedImages.get(image);
+        if (resizedImage) {
+          this.resizedImages.delete(image);
+        } else {
+          resizedImage = await CactusImage.resize(
+            image.replace('file://', ''),
+            128,
+            128,
+            1
+          );
+        }
+        this.resizedImages.set(image, resizedImage);
+        const oldest = this.resizedImages.keys().next();
+        if (this.resizedImages.size > Cactus.maxResizedImages && !oldest.done) {
+          this.resizedImages.delete(oldest.value);
+        }
         resizedImages.push(resizedImage);
       }
       messagesInternal.push({ ...message, images: resizedImages });
     }
 
-    const messagesJson = JSON.stringify(messagesInternal);
+    const messagesJson = `[${messagesInternal
+      .map((message) =>
+        message.images
+          ? JSON.stringify(message)
+          : this.serializeMessage(message)
+      )
+      .join(',')}]`;
     const optionsJson = options
       ? JSON.stringify({
           temperature: options.temperature,
@@ -58,16 +136,23 @@ export class Cactus {
           top_k: options.topK,
           max_tokens: options.maxTokens,
           stop_sequences: options.stopSequences,
+          timeout_ms: options.timeoutMs,
         })
       : undefined;
     const toolsJson = JSON.stringify(tools);
 
-    const response = await this.hybridCactus.complete(
-      messagesJson,
-      responseBufferSize,
-      optionsJson,
-      toolsJson,
-      callback
+    const response = await this.streamTokens(
+      (onToken, tokenStream) =>
+        this.hybridCactus.complete(
+          messagesJson,
+          responseBufferSize,
+          optionsJson,
+          toolsJson,
+          onToken,
+          tokenStream
+        ),
+      callback,
+      options?.batchTokens
     );
 
     try {
@@ -77,12 +162,18 @@ export class Cactus {
         success: parsed.success,
         response: parsed.response,
         functionCalls: parsed.function_calls,
+        toolCallError: parsed.tool_call_error,
+        timedOut: parsed.timed_out,
         timeToFirstTokenMs: parsed.time_to_first_token_ms,
         totalTimeMs: parsed.total_time_ms,
         tokensPerSecond: parsed.tokens_per_second,
         prefillTokens: parsed.prefill_tokens,
         decodeTokens: parsed.decode_tokens,
         totalTokens: parsed.total_tokens,
+        predictedPrefixCacheHit: parsed.predicted_prefix_cache_hit,
+        queueWaitMs: parsed.queue_wait_ms,
+        thermalState: parsed.thermal_state,
+        decodeCapTokensPerSecond: parsed.decode_cap_tokens_per_second,
       };
     } catch {
       throw new Error('Unable to parse completion response');
@@ -94,7 +185,7 @@ export class Cactus {
     prompt: string,
     responseBufferSize: number,
     options?: TranscribeOptions,
-    callback?: (token: string, tokenId: number) => void
+    callback?: (token: string) => void
   ): Promise<CactusSTTTranscribeResult> {
     const optionsJson = options
       ? JSON.stringify({
@@ -103,15 +194,22 @@ export class Cactus {
           top_k: options.topK,
           max_tokens: options.maxTokens,
           stop_sequences: options.stopSequences,
+          timeout_ms: options.timeoutMs,
         })
       : undefined;
 
-    const response = await this.hybridCactus.transcribe(
-      audioFilePath.replace('file://', ''),
-      prompt,
-      responseBufferSize,
-      optionsJson,
-      callback
+    const response = await this.streamTokens(
+      (onToken, tokenStream) =>
+        this.hybridCactus.transcribe(
+          audioFilePath.replace('file://', ''),
+          prompt,
+          responseBufferSize,
+          optionsJson,
+          onToken,
+          tokenStream
+        ),
+      callback,
+      options?.batchTokens
     );
 
     try {
@@ -126,27 +224,61 @@ export class Cactus {
         prefillTokens: parsed.prefill_tokens,
         decodeTokens: parsed.decode_tokens,
         totalTokens: parsed.total_tokens,
+        timedOut: parsed.timed_out,
+        queueWaitMs: parsed.queue_wait_ms,
+        thermalState: parsed.thermal_state,
+        decodeCapTokensPerSecond: parsed.decode_cap_tokens_per_second,
       };
     } catch {
       throw new Error('Unable to parse transcription response');
     }
   }
 
+  public transcribeStreamPush(audio: Float32Array): void {
+    this.hybridCactus.transcribeStreamPush(
+      audio.buffer.slice(
+        audio.byteOffset,
+        audio.byteOffset + audio.byteLength
+      ) as ArrayBuffer
+    );
+  }
+
+  public transcribeStreamWrite(
+    wavPath: string,
+    commit: boolean
+  ): Promise<number> {
+    return this.hybridCactus.transcribeStreamWrite(wavPath, commit);
+  }
+
+  public transcribeStreamClear(): void {
+    this.hybridCactus.transcribeStreamClear();
+  }
+
   public embed(text: string, embeddingBufferSize: number): Promise<number[]> {
     return this.hybridCactus.embed(text, embeddingBufferSize);
   }
 
-  public async imageEmbed(
-    imagePath: string,
+  public async embedBatch(
+    texts: string[],
+    embeddingBufferSize: number
+  ): Promise<Float32Array[]> {
+    const buffer = await this.hybridCactus.embedBatch(
+      texts,
+      embeddingBufferSize
+    );
+    const dimension = texts.length ? buffer.byteLength / 4 / texts.length : 0;
+    return texts.map(
+      (_, index) => new Float32Array(buffer, index * dimension * 4, dimension)
+    );
+  }
+
+  public imageEmbed(
+    image: string | CactusImagePixels,
     embeddingBufferSize: number
   ): Promise<number[]> {
-    const resizedImage = await CactusImage.resize(
-      imagePath.replace('file://', ''),
-      128,
-      128,
-      1
+    return this.withImageFile(image, (imagePath) =>
+      this.hybridCactus.imageEmbed(imagePath, embeddingBufferSize)
     );
-    return this.hybridCactus.imageEmbed(resizedImage, embeddingBufferSize);
   }
 
   public audioEmbed(
@@ -159,7 +291,97 @@ export class Cactus {
     );
   }
 
+  public async embedFloat32(
+    text: string,
+    embeddingBufferSize: number
+  ): Promise<Float32Array> {
+    return new Float32Array(
+      await this.hybridCactus.embedFloat32(text, embeddingBufferSize)
+    );
+  }
+
+  public async imageEmbedFloat32(
+    image: string | CactusImagePixels,
+    embeddingBufferSize: number
+  ): Promise<Float32Array> {
+    return new Float32Array(
+      await this.withImageFile(image, (imagePath) =>
+        this.hybridCactus.imageEmbedFloat32(imagePath, embeddingBufferSize)
+      )
+    );
+  }
+
+  public async audioEmbedFloat32(
+    audioPath: string,
+    embeddingBufferSize: number
+  ): Promise<Float32Array> {
+    return new Float32Array(
+      await this.hybridCactus.audioEmbedFloat32(
+        audioPath.replace('file://', ''),
+        embeddingBufferSize
+      )
+    );
+  }
+
+  public async benchmark({
+    prefillLengths = [128, 512, 2048],
+    decodeLengths = [32, 128],
+    embeddingBatchSizes = [1, 8, 32],
+    iterations = 3,
+    imagePath,
+    audioPath,
+  }: CactusLMBenchmarkParams): Promise<CactusLMBenchmarkResult> {
+    const resizedImage = imagePath
+      ? await CactusImage.resize(imagePath.replace('file://', ''), 128, 128, 1)
+      : undefined;
+
+    const response = await this.hybridCactus.benchmark(
+      prefillLengths,
+      decodeLengths,
+      embeddingBatchSizes,
+      iterations,
+      resizedImage,
+      audioPath?.replace('file://', '')
+    );
+
+    try {
+      const parsed = JSON.parse(response);
+
+      return {
+        threadCount: parsed.thread_count,
+        iterations: parsed.iterations,
+        peakMemoryBytes: parsed.peak_memory_bytes,
+        prefill: parsed.prefill.map((run: any) => ({
+          promptTokens: run.prompt_tokens,
+          prefillTokens: run.prefill_tokens,
+          timeToFirstTokenMs: run.time_to_first_token_ms,
+          tokensPerSecond: run.tokens_per_second,
+        })),
+        decode: parsed.decode.map((run: any) => ({
+          maxTokens: run.max_tokens,
+          decodeTokens: run.decode_tokens,
+          totalTimeMs: run.total_time_ms,
+          tokensPerSecond: run.tokens_per_second,
+        })),
+        embedding: parsed.embedding.map((run: any) => ({
+          batchSize: run.batch_size,
+          latencyMs: run.latency_ms,
+          embeddingsPerSecond: run.embeddings_per_second,
+        })),
+        imageEmbed: parsed.image_embed && {
+          latencyMs: parsed.image_embed.latency_ms,
+        },
+        audioEmbed: parsed.audio_embed && {
+          latencyMs: parsed.audio_embed.latency_ms,
+        },
+      };
+    } catch {
+      throw new Error('Unable to parse benchmark response');
+    }
+  }
+
   public reset(): Promise<void> {
+    this.resizedImages.clear();
     return this.hybridCactus.reset();
   }
 
@@ -167,7 +389,155 @@ export class Cactus {
     return this.hybridCactus.stop();
   }
 
-  public destroy(): Promise<void> {
-    return this.hybridCactus.destroy();
+  public prefetchWeights(): Promise<void> {
+    return this.hybridCactus.prefetchWeights();
+  }
+
+  public setThermalGovernorEnabled(enabled: boolean): void {
+    this.hybridCactus.setThermalGovernorEnabled(enabled);
+  }
+
+  public predictLatency(
+    messages: Message[],
+    maxTokens: number
+  ): CactusLMLatencyPrediction {
+    const prediction = JSON.parse(
+      this.hybridCactus.predictLatency(JSON.stringify(messages), maxTokens)
+    );
+    return {
+      promptTokens: prediction.prompt_tokens,
+      prefillMs: prediction.prefill_ms,
+      decodeMs: prediction.decode_ms,
+      totalMs: prediction.total_ms,
+      thermalState: prediction.thermal_state,
+      calibrated: prediction.calibrated,
+    };
+  }
+
+  public getQueueDepth(): number {
+    return this.hybridCactus.getQueueDepth();
+  }
+
+  public startTrace(): void {
+    this.hybridCactus.setTracingEnabled(true);
+  }
+
+  public stopTrace(): string {
+    this.hybridCactus.setTracingEnabled(false);
+    return this.hybridCactus.takeTrace();
+  }
+
+  public async destroy(): Promise<void> {
+    await this.hybridCactus.destroy();
+    this.resizedImages.clear();
+    await CactusFileSystem.deleteFile(this.imageDirectory).catch(() => {});
+  }
+
+  public setSession(sessionId: string): Promise<void> {
+    return this.hybridCactus.setSession(sessionId);
+  }
+
+  public deleteSession(sessionId: string): Promise<void> {
+    return this.hybridCactus.deleteSession(sessionId);
+  }
+
+  public setSessionMemoryBudget(bytes: number): Promise<void> {
+    return this.hybridCactus.setSessionMemoryBudget(bytes);
+  }
+
+  public setMaxSessions(count: number): Promise<void> {
+    return this.hybridCactus.setMaxSessions(count);
+  }
+
+  public setEmbeddingCache(directory?: string): Promise<void> {
+    return this.hybridCactus.setEmbeddingCache(directory);
+  }
+
+  // Checks the fields as well, in case the message was changed in place
+  private serializeMessage(message: Message): string {
+    const cached = this.serializedMessages.get(message);
+    if (
+      cached &&
+      cached.role === message.role &&
+      cached.content === message.content
+    ) {
+      return cached.json;
+    }
+    const json = JSON.stringify(message);
+    this.serializedMessages.set(message, {
+      role: message.role,
+      content: message.content,
+      json,
+    });
+    return json;
+  }
+
+  // Pixels are written as an uncompressed PNG at the model's input size,
+  // which skips the JPEG encode and decode of CactusImage.resize
+  private async writeImagePixels(
+    pixels: CactusImagePixels,
+    directory: string
+  ): Promise<string> {
+    const cactusDirectory = await CactusFileSystem.getCactusDirectory();
+    return CactusUtil.writeImagePixels(
+      pixels,
+      `${cactusDirectory}/${directory}`,
+      128
+    );
+  }
+
+  private async withImageFile<T>(
+    image: string | CactusImagePixels,
+    run: (imagePath: string) => Promise<T>
+  ): Promise<T> {
+    if (typeof image === 'string') {
+      return run(
+        await CactusImage.resize(image.replace('file://', ''), 128, 128, 1)
+      );
+    }
+
+    const directory = `${this.imageDirectory}/embed_${this.embedCount++}`;
+    try {
+      return await run(await this.writeImagePixels(image, directory));
+    } finally {
+      await CactusFileSystem.deleteFile(directory).catch(() => {});
+    }
+  }
+
+  // Tokens are passed to the callback one at a time, unless batchTokens is
+  // set. Batched tokens are buffered natively and delivered once per frame,
+  // so the decode thread never waits on the JS thread. Every call has its own
+  // stream, which stays empty while the call waits for the model.
+  private async streamTokens(
+    run: (
+      onToken?: (token: string, tokenId: number) => void,
+      tokenStream?: number
+    ) => Promise<string>,
+    callback?: (token: string) => void,
+    batchTokens?: boolean
+  ): Promise<string> {
+    if (!callback) {
+      return run();
+    }
+    if (!batchTokens) {
+      return run((token) => callback(token));
+    }
+
+    const tokenStream = this.hybridCactus.openTokenStream();
+    const flush = () => {
+      const tokens = this.hybridCactus.drainTokens(tokenStream);
+      if (tokens) {
+        callback(tokens);
+      }
+    };
+
+    const interval = setInterval(flush, Cactus.tokenDrainIntervalMs);
+    try {
+      return await run(undefined, tokenStream);
+    } finally {
+      clearInterval(interval);
+      flush();
+      this.hybridCactus.closeTokenStream(tokenStream);
+    }
   }
 }
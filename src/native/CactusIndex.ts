@@ -0,0 +1,52 @@
+import { NitroModules } from 'react-native-nitro-modules';
+import type { CactusIndex as CactusIndexSpec } from '../specs/CactusIndex.nitro';
+
+export class CactusIndex {
+  private readonly hybridCactusIndex =
+    NitroModules.createHybridObject<CactusIndexSpec>('CactusIndex');
+
+  public open(indexPath: string, embeddingDim: number): Promise<void> {
+    return this.hybridCactusIndex.open(indexPath, embeddingDim);
+  }
+
+  public add(ids: number[], embeddings: Float32Array): Promise<void> {
+    return this.hybridCactusIndex.add(ids, toArrayBuffer(embeddings));
+  }
+
+  public remove(ids: number[]): Promise<void> {
+    return this.hybridCactusIndex.remove(ids);
+  }
+
+  public async query(
+    embedding: Float32Array,
+    k: number,
+    probes: number
+  ): Promise<{ ids: number[]; scores: number[] }> {
+    const response = await this.hybridCactusIndex.query(
+      toArrayBuffer(embedding),
+      k,
+      probes
+    );
+
+    try {
+      return JSON.parse(response);
+    } catch {
+      throw new Error('Unable to parse index query response');
+    }
+  }
+
+  public getSize(): Promise<number> {
+    return this.hybridCactusIndex.getSize();
+  }
+
+  public close(): Promise<void> {
+    return this.hybridCactusIndex.close();
+  }
+}
+
+function toArrayBuffer(floats: Float32Array): ArrayBuffer {
+  return floats.buffer.slice(
+    floats.byteOffset,
+    floats.byteOffset + floats.byteLength
+  ) as ArrayBuffer;
+}
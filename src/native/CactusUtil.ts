@@ -1,12 +1,15 @@
 import { NitroModules } from 'react-native-nitro-modules';
 import type { CactusUtil as CactusUtilSpec } from '../specs/CactusUtil.nitro';
-import { Platform } from 'react-native';
+import { AppState, Platform } from 'react-native';
 import { CactusFileSystem } from './CactusFileSystem';
+import type { CactusImagePixels } from '../types/CactusLM';
 
 export class CactusUtil {
   private static readonly hybridCactusUtil =
     NitroModules.createHybridObject<CactusUtilSpec>('CactusUtil');
 
+  private static isWatchingMemoryPressure = false;
+
   public static async registerApp(encryptedData: string): Promise<string> {
     if (Platform.OS === 'android') {
       const cactusDirectory = await CactusFileSystem.getCactusDirectory();
@@ -24,4 +27,66 @@ export class CactusUtil {
 
     return this.hybridCactusUtil.getDeviceId();
   }
+
+  public static setModelMemoryBudget(bytes: number): Promise<void> {
+    return this.hybridCactusUtil.setModelMemoryBudget(bytes);
+  }
+
+  // Idle models shed their caches when the app goes to the background, and
+  // are unloaded on memory warnings, which come before the app is terminated.
+  // Android reports critical memory natively, see CactusTrimMemoryProvider.
+  public static watchMemoryPressure(): void {
+    if (this.isWatchingMemoryPressure) {
+      return;
+    }
+    this.isWatchingMemoryPressure = true;
+
+    AppState.addEventListener('change', (state) => {
+      if (state === 'background') {
+        this.hybridCactusUtil.trimMemory('moderate');
+      }
+    });
+    AppState.addEventListener('memoryWarning', () => {
+      this.hybridCactusUtil.trimMemory('critical');
+    });
+  }
+
+  public static benchmarkKernels(iterations: number): Promise<string> {
+    return this.hybridCactusUtil.benchmarkKernels(iterations);
+  }
+
+  public static getMetrics(): string {
+    return this.hybridCactusUtil.getMetrics();
+  }
+
+  public static resetMetrics(): void {
+    this.hybridCactusUtil.resetMetrics();
+  }
+
+  public static writeImagePixels(
+    pixels: CactusImagePixels,
+    outputDir: string,
+    outputSize: number
+  ): Promise<string> {
+    return this.hybridCactusUtil.writeImagePixels(
+      pixels.data,
+      pixels.width,
+      pixels.height,
+      pixels.format,
+      outputDir,
+      outputSize
+    );
+  }
+
+  public static splitAudio(
+    audioPath: string,
+    outputDir: string,
+    maxWindowSeconds: number
+  ): Promise<string[]> {
+    return this.hybridCactusUtil.splitAudio(
+      audioPath.replace('file://', ''),
+      outputDir,
+      maxWindowSeconds
+    );
+  }
 }
@@ -3,4 +3,5 @@ export { CactusCrypto } from './CactusCrypto';
 export { CactusDeviceInfo } from './CactusDeviceInfo';
 export { CactusFileSystem } from './CactusFileSystem';
 export { CactusImage } from './CactusImage';
+export { CactusIndex } from './CactusIndex';
 export { CactusUtil } from './CactusUtil';
@@ -4,26 +4,69 @@ export interface Cactus extends HybridObject<{ ios: 'c++'; android: 'c++' }> {
   init(
     modelPath: string,
     contextSize: number,
-    corpusDir?: string
-  ): Promise<void>;
+    corpusDir?: string,
+    kvWindowSize?: number,
+    kvSinkSize?: number
+  ): Promise<number>;
   complete(
     messagesJson: string,
     responseBufferSize: number,
     optionsJson?: string,
     toolsJson?: string,
-    callback?: (token: string, tokenId: number) => void
+    callback?: (token: string, tokenId: number) => void,
+    tokenStream?: number
   ): Promise<string>;
   transcribe(
     audioFilePath: string,
     prompt: string,
     responseBufferSize: number,
     optionsJson?: string,
-    callback?: (token: string, tokenId: number) => void
+    callback?: (token: string, tokenId: number) => void,
+    tokenStream?: number
   ): Promise<string>;
+  transcribeStreamPush(pcm: ArrayBuffer): void;
+  transcribeStreamWrite(wavPath: string, commit: boolean): Promise<number>;
+  transcribeStreamClear(): void;
   embed(text: string, embeddingBufferSize: number): Promise<number[]>;
+  embedBatch(
+    texts: string[],
+    embeddingBufferSize: number
+  ): Promise<ArrayBuffer>;
   imageEmbed(imagePath: string, embeddingBufferSize: number): Promise<number[]>;
   audioEmbed(audioPath: string, embeddingBufferSize: number): Promise<number[]>;
+  embedFloat32(text: string, embeddingBufferSize: number): Promise<ArrayBuffer>;
+  imageEmbedFloat32(
+    imagePath: string,
+    embeddingBufferSize: number
+  ): Promise<ArrayBuffer>;
+  audioEmbedFloat32(
+    audioPath: string,
+    embeddingBufferSize: number
+  ): Promise<ArrayBuffer>;
+  benchmark(
+    prefillLengths: number[],
+    decodeLengths: number[],
+    embeddingBatchSizes: number[],
+    iterations: number,
+    imagePath?: string,
+    audioPath?: string
+  ): Promise<string>;
   reset(): Promise<void>;
   stop(): Promise<void>;
+  prefetchWeights(): Promise<void>;
+  openTokenStream(): number;
+  drainTokens(tokenStream: number): string;
+  closeTokenStream(tokenStream: number): void;
+  getLoadProgress(): number;
+  predictLatency(messagesJson: string, maxTokens: number): string;
+  getQueueDepth(): number;
+  setTracingEnabled(enabled: boolean): void;
+  takeTrace(): string;
+  setThermalGovernorEnabled(enabled: boolean): void;
   destroy(): Promise<void>;
+  setSession(sessionId: string): Promise<void>;
+  deleteSession(sessionId: string): Promise<void>;
+  setSessionMemoryBudget(bytes: number): Promise<void>;
+  setMaxSessions(count: number): Promise<void>;
+  setEmbeddingCache(directory?: string): Promise<void>;
 }
@@ -0,0 +1,11 @@
+import type { HybridObject } from 'react-native-nitro-modules';
+
+export interface CactusIndex
+  extends HybridObject<{ ios: 'c++'; android: 'c++' }> {
+  open(indexPath: string, embeddingDim: number): Promise<void>;
+  add(ids: number[], embeddings: ArrayBuffer): Promise<void>;
+  remove(ids: number[]): Promise<void>;
+  query(embedding: ArrayBuffer, k: number, probes: number): Promise<string>;
+  getSize(): Promise<number>;
+  close(): Promise<void>;
+}
@@ -5,4 +5,23 @@ export interface CactusUtil
   registerApp(encryptedData: string): Promise<string>;
   getDeviceId(): Promise<string | null>;
   setAndroidDataDirectory(dataDir: string): Promise<void>;
+  setModelMemoryBudget(bytes: number): Promise<void>;
+  trimMemory(level: string): Promise<void>;
+  splitAudio(
+    audioPath: string,
+    outputDir: string,
+    maxWindowSeconds: number
+  ): Promise<string[]>;
+  removeSilence(audioPath: string, outputPath: string): Promise<number>;
+  writeImagePixels(
+    pixels: ArrayBuffer,
+    width: number,
+    height: number,
+    format: string,
+    outputDir: string,
+    outputSize: number
+  ): Promise<string>;
+  benchmarkKernels(iterations: number): Promise<string>;
+  getMetrics(): string;
+  resetMetrics(): void;
 }
@@ -0,0 +1,19 @@
+export interface CactusKernelBenchmarkParams {
+  iterations?: number;
+}
+
+export interface CactusKernelBenchmarkRun {
+  kernel:
+    | 'matmul_int8_to_int32'
+    | 'matmul_f16'
+    | 'attention_f16'
+    | 'rms_norm_f16'
+    | 'softmax_f32';
+  family: string;
+  // Dimensions joined by x, e.g. M x K x N of a matmul
+  shape: string;
+  ms: number;
+  gflops: number;
+  gbPerSecond: number;
+  maxError: number;
+}
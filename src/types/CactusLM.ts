@@ -1,17 +1,34 @@
 export interface CactusLMParams {
   model?: string;
-  contextSize?: number;
+  contextSize?: number | 'auto';
   corpusDir?: string;
+  maxSessions?: number;
+  sessionMemoryBudget?: number;
+  thermalGovernor?: boolean;
+  slidingWindowSize?: number;
+  attentionSinkSize?: number;
+  embeddingCache?: boolean;
 }
 
 export interface CactusLMDownloadParams {
   onProgress?: (progress: number) => void;
 }
 
+export interface CactusLMInitParams {
+  onProgress?: (progress: number) => void;
+}
+
+export interface CactusImagePixels {
+  data: ArrayBuffer;
+  width: number;
+  height: number;
+  format: 'rgba' | 'bgra' | 'rgb';
+}
+
 export interface Message {
   role: 'user' | 'assistant' | 'system';
   content?: string;
-  images?: string[];
+  images?: (string | CactusImagePixels)[];
 }
 
 export interface CompleteOptions {
@@ -20,6 +37,8 @@ export interface CompleteOptions {
   topK?: number;
   maxTokens?: number;
   stopSequences?: string[];
+  timeoutMs?: number;
+  batchTokens?: boolean;
 }
 
 export interface Tool {
@@ -43,6 +62,7 @@ export interface CactusLMCompleteParams {
   tools?: Tool[];
   onToken?: (token: string) => void;
   mode?: 'local' | 'hybrid';
+  maxLocalLatencyMs?: number;
 }
 
 export interface CactusLMCompleteResult {
@@ -52,12 +72,33 @@ export interface CactusLMCompleteResult {
     name: string;
     arguments: { [key: string]: any };
   }[];
+  toolCallError?: string;
+  timedOut?: boolean;
   timeToFirstTokenMs: number;
   totalTimeMs: number;
   tokensPerSecond: number;
   prefillTokens: number;
   decodeTokens: number;
   totalTokens: number;
+  // Predicted by comparing the messages with the previous call
+  predictedPrefixCacheHit?: boolean;
+  queueWaitMs?: number;
+  thermalState?: 'nominal' | 'fair' | 'serious' | 'critical';
+  decodeCapTokensPerSecond?: number;
+}
+
+export interface CactusLMPredictLatencyParams {
+  messages: Message[];
+  options?: CompleteOptions;
+}
+
+export interface CactusLMLatencyPrediction {
+  promptTokens: number;
+  prefillMs: number;
+  decodeMs: number;
+  totalMs: number;
+  thermalState: 'nominal' | 'fair' | 'serious' | 'critical';
+  calibrated: boolean;
 }
 
 export interface CactusLMEmbedParams {
@@ -68,10 +109,67 @@ export interface CactusLMEmbedResult {
   embedding: number[];
 }
 
+export interface CactusLMEmbedFloat32Result {
+  embedding: Float32Array;
+}
+
+export interface CactusLMEmbedBatchParams {
+  texts: string[];
+}
+
+export interface CactusLMEmbedBatchResult {
+  embeddings: Float32Array[];
+}
+
 export interface CactusLMImageEmbedParams {
-  imagePath: string;
+  imagePath?: string;
+  imagePixels?: CactusImagePixels;
 }
 
 export interface CactusLMImageEmbedResult {
   embedding: number[];
 }
+
+export interface CactusLMImageEmbedFloat32Result {
+  embedding: Float32Array;
+}
+
+export interface CactusLMBenchmarkParams {
+  prefillLengths?: number[];
+  decodeLengths?: number[];
+  embeddingBatchSizes?: number[];
+  iterations?: number;
+  imagePath?: string;
+  audioPath?: string;
+}
+
+export interface CactusLMBenchmarkLatency {
+  p50: number;
+  p90: number;
+  p99: number;
+}
+
+export interface CactusLMBenchmarkResult {
+  threadCount: number;
+  iterations: number;
+  peakMemoryBytes: number;
+  prefill: {
+    promptTokens: number;
+    prefillTokens: number;
+    timeToFirstTokenMs: CactusLMBenchmarkLatency;
+    tokensPerSecond: number;
+  }[];
+  decode: {
+    maxTokens: number;
+    decodeTokens: number;
+    totalTimeMs: CactusLMBenchmarkLatency;
+    tokensPerSecond: number;
+  }[];
+  embedding: {
+    batchSize: number;
+    latencyMs: CactusLMBenchmarkLatency;
+    embeddingsPerSecond: number;
+  }[];
+  imageEmbed?: { latencyMs: CactusLMBenchmarkLatency };
+  audioEmbed?: { latencyMs: CactusLMBenchmarkLatency };
+}
@@ -0,0 +1,21 @@
+export interface CactusMetricsGauge {
+  value: number;
+  peak: number;
+}
+
+export interface CactusMetricsHistogram {
+  count: number;
+  sum: number;
+  max: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  // [upper bound, count] of every non-empty bucket
+  buckets: [number, number][];
+}
+
+export interface CactusMetricsSnapshot {
+  counters: { [name: string]: number };
+  gauges: { [name: string]: CactusMetricsGauge };
+  histograms: { [name: string]: CactusMetricsHistogram };
+}
@@ -1,6 +1,7 @@
 export interface CactusSTTParams {
   model?: string;
   contextSize?: number;
+  thermalGovernor?: boolean;
 }
 
 export interface CactusSTTDownloadParams {
@@ -13,6 +14,8 @@ export interface TranscribeOptions {
   topK?: number;
   maxTokens?: number;
   stopSequences?: string[];
+  timeoutMs?: number;
+  batchTokens?: boolean;
 }
 
 export interface CactusSTTTranscribeParams {
@@ -20,6 +23,8 @@ export interface CactusSTTTranscribeParams {
   prompt?: string;
   options?: TranscribeOptions;
   onToken?: (token: string) => void;
+  longForm?: boolean;
+  skipSilence?: boolean;
 }
 
 export interface CactusSTTTranscribeResult {
@@ -31,6 +36,23 @@ export interface CactusSTTTranscribeResult {
   prefillTokens: number;
   decodeTokens: number;
   totalTokens: number;
+  timedOut?: boolean;
+  queueWaitMs?: number;
+  thermalState?: 'nominal' | 'fair' | 'serious' | 'critical';
+  decodeCapTokensPerSecond?: number;
+  speechRatio?: number;
+}
+
+export interface CactusSTTStreamTranscribeStartParams {
+  prompt?: string;
+  options?: TranscribeOptions;
+  onTranscription?: (transcription: string) => void;
+}
+
+export interface CactusSTTStreamTranscribeResult {
+  success: boolean;
+  response: string;
+  totalTimeMs: number;
 }
 
 export interface CactusSTTAudioEmbedParams {
@@ -40,3 +62,7 @@ export interface CactusSTTAudioEmbedParams {
 export interface CactusSTTAudioEmbedResult {
   embedding: number[];
 }
+
+export interface CactusSTTAudioEmbedFloat32Result {
+  embedding: Float32Array;
+}
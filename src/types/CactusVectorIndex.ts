@@ -0,0 +1,24 @@
+export interface CactusVectorIndexParams {
+  name: string;
+  embeddingDim: number;
+}
+
+export interface CactusVectorIndexAddParams {
+  ids: number[];
+  embeddings: (number[] | Float32Array)[];
+}
+
+export interface CactusVectorIndexDeleteParams {
+  ids: number[];
+}
+
+export interface CactusVectorIndexQueryParams {
+  embedding: number[] | Float32Array;
+  k?: number;
+  probes?: number;
+}
+
+export interface CactusVectorIndexQueryResult {
+  ids: number[];
+  scores: number[];
+}
@@ -0,0 +1,71 @@
+#include "CactusAudioAnalysis.hpp"
+#include "CactusTest.hpp"
+
+#include <cmath>
+
+using margelo::nitro::cactus::CactusAudioAnalysis;
+
+namespace {
+
+constexpr uint32_t kSampleRate = 16000;
+
+// A tone of the given amplitude for every second, starting at second 0
+std::vector<float> seconds(const std::vector<float> &amplitudes) {
+  std::vector<float> samples;
+  for (const float amplitude : amplitudes) {
+    for (uint32_t i = 0; i < kSampleRate; ++i) {
+      samples.push_back(amplitude * std::sin(i * 0.1f));
+    }
+  }
+  return samples;
+}
+
+} // namespace
+
+TEST(KeepsShortAudioInOneWindow) {
+  const auto samples = seconds({0.5f, 0.5f});
+  CactusAudioAnalysis analysis(samples, kSampleRate);
+  CHECK(analysis.frameSamples() == 320);
+  CHECK((analysis.windowBoundaries(30) ==
+         std::vector<size_t>{0, samples.size()}));
+}
+
+TEST(CutsWindowsAtTheQuietestPoint) {
+  // Speech throughout but for a pause in second 8
+  std::vector<float> amplitudes(25, 0.5f);
+  amplitudes[8] = 0.001f;
+  const auto samples = seconds(amplitudes);
+  CactusAudioAnalysis analysis(samples, kSampleRate);
+
+  const auto boundaries = analysis.windowBoundaries(10);
+  CHECK(boundaries.front() == 0 && boundaries.back() == samples.size());
+  CHECK(boundaries[1] >= 8 * kSampleRate && boundaries[1] < 9 * kSampleRate);
+  for (size_t i = 1; i < boundaries.size(); ++i) {
+    CHECK(boundaries[i] > boundaries[i - 1]);
+    CHECK(boundaries[i] - boundaries[i - 1] <= 10 * kSampleRate);
+  }
+}
+
+TEST(MarksSpeechAboveTheNoiseFloor) {
+  // Noise, speech in seconds 2 and 3, noise
+  const auto samples = seconds({0.001f, 0.001f, 0.3f, 0.3f, 0.001f, 0.001f});
+  CactusAudioAnalysis analysis(samples, kSampleRate);
+  const auto speech = analysis.speechFrames();
+  CHECK(speech.size() == 6 * 50);
+
+  CHECK(!speech[0] && !speech[50]);
+  CHECK(speech[100] && speech[199]);
+  CHECK(!speech[260] && !speech[299]);
+  // Padded by 200 ms on either side
+  CHECK(speech[90] && !speech[89]);
+  CHECK(speech[209] && !speech[210]);
+}
+
+TEST(FindsNoSpeechInSilence) {
+  const auto samples = seconds({0, 0.002f});
+  CactusAudioAnalysis analysis(samples, kSampleRate);
+  for (const bool frame : analysis.speechFrames()) {
+    CHECK(!frame);
+  }
+  CHECK(CactusAudioAnalysis({}, kSampleRate).speechFrames().empty());
+}
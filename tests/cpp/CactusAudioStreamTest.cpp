@@ -0,0 +1,74 @@
+#include "CactusAudioStream.hpp"
+#include "CactusTest.hpp"
+#include "CactusWav.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+using margelo::nitro::cactus::CactusAudioStream;
+using margelo::nitro::cactus::kWhisperSampleRate;
+using margelo::nitro::cactus::readWav;
+
+TEST(WritesTheBufferedWindow) {
+  cactus_test::TemporaryDirectory directory("audio_stream_write");
+  CactusAudioStream stream;
+  const float first[] = {0.5f, -0.5f};
+  const float second[] = {0.25f};
+  stream.push(first, 2);
+  stream.push(second, 1);
+
+  CHECK(stream.write(directory.file("window.wav"), false) == 3);
+  const auto audio = readWav(directory.file("window.wav"));
+  CHECK(audio.sampleRate == kWhisperSampleRate);
+  CHECK(audio.samples.size() == 3);
+  CHECK(std::fabs(audio.samples[1] + 0.5f) < 1e-3f);
+  CHECK(std::fabs(audio.samples[2] - 0.25f) < 1e-3f);
+}
+
+TEST(StartsTheNextWindowAfterACommit) {
+  cactus_test::TemporaryDirectory directory("audio_stream_commit");
+  CactusAudioStream stream;
+  const float samples[] = {0.1f, 0.2f, 0.3f};
+  stream.push(samples, 3);
+
+  CHECK(stream.write(directory.file("a.wav"), false) == 3);
+  CHECK(stream.write(directory.file("b.wav"), true) == 3);
+  stream.push(samples, 1);
+  CHECK(stream.write(directory.file("c.wav"), false) == 1);
+}
+
+TEST(WritesNothingWhileEmpty) {
+  cactus_test::TemporaryDirectory directory("audio_stream_empty");
+  CactusAudioStream stream;
+  const float samples[] = {0.1f};
+  stream.push(samples, 1);
+  stream.clear();
+
+  CHECK(stream.write(directory.file("empty.wav"), true) == 0);
+  CHECK(!std::filesystem::exists(directory.file("empty.wav")));
+}
+
+TEST(CommitsLongWindowsAtTheQuietestPoint) {
+  cactus_test::TemporaryDirectory directory("audio_stream_cut");
+  CactusAudioStream stream;
+  // 29 s of a loud tone with a pause from 25 s to 25.1 s
+  std::vector<float> samples(29 * kWhisperSampleRate);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = 0.5f * std::sin(0.1f * static_cast<float>(i));
+  }
+  const size_t pauseBegin = 25 * kWhisperSampleRate;
+  const size_t pauseEnd = pauseBegin + kWhisperSampleRate / 10;
+  std::fill(samples.begin() + pauseBegin, samples.begin() + pauseEnd, 0.0f);
+  stream.push(samples.data(), samples.size());
+
+  const size_t committed = stream.write(directory.file("a.wav"), true);
+  CHECK(committed >= pauseBegin && committed < pauseEnd);
+  CHECK(readWav(directory.file("a.wav")).samples.size() == committed);
+  // The audio after the cut starts the next window
+  CHECK(stream.write(directory.file("b.wav"), false) ==
+        samples.size() - committed);
+  CHECK(stream.write(directory.file("c.wav"), true) ==
+        samples.size() - committed);
+  CHECK(stream.write(directory.file("d.wav"), false) == 0);
+}
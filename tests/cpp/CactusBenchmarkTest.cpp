@@ -0,0 +1,192 @@
+#include "CactusBenchmark.hpp"
+#include "CactusTest.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using margelo::nitro::cactus::CactusBenchmark;
+using margelo::nitro::cactus::CactusBenchmarkOptions;
+
+namespace {
+
+// Counts the calls into the fake engine below
+struct Engine {
+  int resets = 0;
+  int completes = 0;
+  int embeds = 0;
+  int imageEmbeds = 0;
+  int audioEmbeds = 0;
+  bool fail = false;
+  std::string lastOptions;
+};
+
+Engine &engine() {
+  static Engine engine;
+  return engine;
+}
+
+const cactus_model_t kModel = reinterpret_cast<cactus_model_t>(0x1);
+
+// Only std::invalid_argument counts, so an unrelated failure does not pass
+bool rejects(const std::vector<double> &prefillLengths, double iterations) {
+  try {
+    CactusBenchmarkOptions::from(prefillLengths, {}, {}, iterations,
+                                 std::nullopt, std::nullopt);
+  } catch (const std::invalid_argument &) {
+    return true;
+  }
+  return false;
+}
+
+bool contains(const std::string &json, const std::string &part) {
+  return json.find(part) != std::string::npos;
+}
+
+} // namespace
+
+// Stand in for the engine, which is not linked into the host tests
+extern "C" void cactus_reset(cactus_model_t) { engine().resets++; }
+
+extern "C" int cactus_complete(cactus_model_t, const char *, char *buffer,
+                               size_t size, const char *options, const char *,
+                               cactus_token_callback, void *) {
+  engine().completes++;
+  engine().lastOptions = options ? options : "";
+  if (engine().fail) {
+    return -1;
+  }
+  const char *response =
+      "{\"time_to_first_token_ms\":50,\"total_time_ms\":200,"
+      "\"tokens_per_second\":40,\"prefill_tokens\":100,"
+      "\"decode_tokens\":8}";
+  std::strncpy(buffer, response, size);
+  return static_cast<int>(std::strlen(response));
+}
+
+extern "C" int cactus_embed(cactus_model_t, const char *, float *, size_t,
+                            size_t *dim) {
+  engine().embeds++;
+  *dim = 4;
+  return 0;
+}
+
+extern "C" int cactus_image_embed(cactus_model_t, const char *, float *,
+                                  size_t, size_t *dim) {
+  engine().imageEmbeds++;
+  *dim = 4;
+  return 0;
+}
+
+extern "C" int cactus_audio_embed(cactus_model_t, const char *, float *,
+                                  size_t, size_t *dim) {
+  engine().audioEmbeds++;
+  *dim = 4;
+  return 0;
+}
+
+TEST(MeasuresPrefillFromAnEmptyCache) {
+  engine() = {};
+  CactusBenchmarkOptions options;
+  options.prefillLengths = {128};
+  options.iterations = 3;
+
+  const auto json = CactusBenchmark(kModel, 2048).run(options);
+  CHECK(engine().completes == 3);
+  // Once before every run and once to leave the cache empty
+  CHECK(engine().resets == 4);
+  CHECK(engine().lastOptions == "{\"max_tokens\":1}");
+  CHECK(contains(json, "\"iterations\":3"));
+  CHECK(contains(json, "\"prompt_tokens\":128"));
+  CHECK(contains(json, "\"p50\":50.000000"));
+  // 100 prefill tokens in 50 ms
+  CHECK(contains(json, "\"tokens_per_second\":2000.000000"));
+  CHECK(contains(json, "\"peak_memory_bytes\":"));
+}
+
+TEST(SkipsLengthsThatDoNotFitTheContext) {
+  engine() = {};
+  CactusBenchmarkOptions options;
+  options.prefillLengths = {128, 1024};
+  options.decodeLengths = {64, 2048};
+  options.iterations = 1;
+
+  const auto json = CactusBenchmark(kModel, 512).run(options);
+  CHECK(engine().completes == 2);
+  CHECK(contains(json, "\"prompt_tokens\":128"));
+  CHECK(!contains(json, "\"prompt_tokens\":1024"));
+  CHECK(contains(json, "\"max_tokens\":64"));
+  CHECK(!contains(json, "\"max_tokens\":2048"));
+}
+
+TEST(RunsEveryBatchAndEncoder) {
+  engine() = {};
+  CactusBenchmarkOptions options;
+  options.embeddingBatchSizes = {1, 4};
+  options.iterations = 2;
+  options.imagePath = "/tmp/image.png";
+  options.audioPath = "/tmp/audio.wav";
+
+  const auto json = CactusBenchmark(kModel, 2048).run(options);
+  CHECK(engine().embeds == (1 + 4) * 2);
+  CHECK(engine().imageEmbeds == 2);
+  CHECK(engine().audioEmbeds == 2);
+  CHECK(contains(json, "\"batch_size\":4"));
+  CHECK(contains(json, "\"image_embed\":{\"latency_ms\":"));
+  CHECK(contains(json, "\"audio_embed\":{\"latency_ms\":"));
+  CHECK(contains(json, "\"prefill\":[],\"decode\":[]"));
+}
+
+TEST(RunsAtLeastOnce) {
+  engine() = {};
+  CactusBenchmarkOptions options;
+  options.decodeLengths = {16};
+  options.iterations = 0;
+
+  const auto json = CactusBenchmark(kModel, 2048).run(options);
+  CHECK(engine().completes == 1);
+  CHECK(contains(json, "\"iterations\":1"));
+}
+
+TEST(ThrowsWhenACompletionFails) {
+  engine() = {};
+  engine().fail = true;
+  CactusBenchmarkOptions options;
+  options.prefillLengths = {128};
+  CHECK_THROWS(CactusBenchmark(kModel, 2048).run(options));
+}
+
+TEST(ConvertsWholeCounts) {
+  const auto options = CactusBenchmarkOptions::from(
+      {128, 0}, {16}, {1, 8}, 3, std::string("image.png"), std::nullopt);
+  CHECK((options.prefillLengths == std::vector<size_t>{128, 0}));
+  CHECK((options.decodeLengths == std::vector<size_t>{16}));
+  CHECK((options.embeddingBatchSizes == std::vector<size_t>{1, 8}));
+  CHECK(options.iterations == 3);
+  CHECK(options.imagePath == "image.png");
+  CHECK(!options.audioPath);
+}
+
+TEST(RejectsCountsThatAreNotWholeNumbersInRange) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double infinity = std::numeric_limits<double>::infinity();
+
+  CHECK(rejects({nan}, 3));
+  CHECK(rejects({-1}, 3));
+  CHECK(rejects({1.5}, 3));
+  CHECK(rejects({infinity}, 3));
+  CHECK(rejects({CactusBenchmarkOptions::kMaxTokens + 1.0}, 3));
+  CHECK(rejects({1e300}, 3));
+  CHECK(rejects({128}, nan));
+  CHECK(rejects({128}, -1));
+  CHECK(rejects({128}, 2.5));
+  CHECK(rejects({128}, CactusBenchmarkOptions::kMaxIterations + 1.0));
+  CHECK_THROWS(CactusBenchmarkOptions::from({}, {nan}, {}, 3, std::nullopt,
+                                            std::nullopt));
+  CHECK_THROWS(CactusBenchmarkOptions::from(
+      {}, {}, {CactusBenchmarkOptions::kMaxBatchSize + 1.0}, 3, std::nullopt,
+      std::nullopt));
+  CHECK(!rejects({CactusBenchmarkOptions::kMaxTokens + 0.0},
+                 CactusBenchmarkOptions::kMaxIterations));
+}
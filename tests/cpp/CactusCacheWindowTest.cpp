@@ -0,0 +1,38 @@
+#include "CactusCacheWindow.hpp"
+#include "CactusTest.hpp"
+
+#include <limits>
+
+using margelo::nitro::cactus::CactusCacheWindow;
+
+TEST(KeepsTheEngineDefaultsWhenUnset) {
+  const auto window = CactusCacheWindow::from(std::nullopt, std::nullopt);
+  CHECK(!window.windowSize);
+  CHECK(!window.sinkSize);
+}
+
+TEST(AcceptsWholeTokenCounts) {
+  const auto window = CactusCacheWindow::from(512.0, 0.0);
+  CHECK(window.windowSize == 512u);
+  CHECK(window.sinkSize == 0u);
+  CHECK(CactusCacheWindow::from(std::nullopt, 1023.0).sinkSize == 1023u);
+  CHECK(CactusCacheWindow::from(8.0, std::nullopt).windowSize == 8u);
+}
+
+TEST(RejectsValuesThatAreNoTokenCount) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double infinity = std::numeric_limits<double>::infinity();
+  CHECK_THROWS(CactusCacheWindow::from(-1.0, std::nullopt));
+  CHECK_THROWS(CactusCacheWindow::from(512.5, std::nullopt));
+  CHECK_THROWS(CactusCacheWindow::from(nan, std::nullopt));
+  CHECK_THROWS(CactusCacheWindow::from(infinity, std::nullopt));
+  CHECK_THROWS(CactusCacheWindow::from(1e30, std::nullopt));
+  CHECK_THROWS(CactusCacheWindow::from(0.0, std::nullopt));
+  CHECK_THROWS(CactusCacheWindow::from(512.0, -4.0));
+}
+
+TEST(RejectsASinkThatFillsTheWindow) {
+  CHECK_THROWS(CactusCacheWindow::from(64.0, 64.0));
+  CHECK_THROWS(CactusCacheWindow::from(2.0, std::nullopt));
+  CHECK_THROWS(CactusCacheWindow::from(std::nullopt, 1024.0));
+}
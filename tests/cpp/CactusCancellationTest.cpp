@@ -0,0 +1,83 @@
+#include "CactusCancellation.hpp"
+#include "CactusTest.hpp"
+
+#include <thread>
+#include <vector>
+
+using margelo::nitro::cactus::CactusCancellation;
+
+namespace {
+
+std::vector<cactus_model_t> &stoppedModels() {
+  static std::vector<cactus_model_t> models;
+  return models;
+}
+
+} // namespace
+
+// Stands in for the engine, which is not linked into the host tests
+extern "C" void cactus_stop(cactus_model_t model) {
+  stoppedModels().push_back(model);
+}
+
+TEST(IssuesIncreasingTickets) {
+  CactusCancellation cancellation;
+  const auto first = cancellation.issue(std::nullopt);
+  const auto second = cancellation.issue(std::string("{}"));
+  CHECK(second.ticket == first.ticket + 1);
+  CHECK(cancellation.lastTicket() == second.ticket);
+  CHECK(!first.deadline && !second.deadline);
+}
+
+TEST(StopsEveryRequestUpToTheTicket) {
+  CactusCancellation cancellation;
+  const auto first = cancellation.issue(std::nullopt);
+  const auto second = cancellation.issue(std::nullopt);
+  cancellation.stop(first.ticket);
+  CHECK(cancellation.stopped(first));
+  CHECK(!cancellation.stopped(second));
+
+  // A later stop covers requests still waiting for the model
+  const auto third = cancellation.issue(std::nullopt);
+  cancellation.stop(cancellation.lastTicket());
+  CHECK(cancellation.stopped(second));
+  CHECK(cancellation.stopped(third));
+
+  // An older ticket does not take a stop back
+  cancellation.stop(first.ticket);
+  CHECK(cancellation.stopped(third));
+}
+
+TEST(InterruptsTheRunningRequestOnly) {
+  CactusCancellation cancellation;
+  int model = 0;
+  stoppedModels().clear();
+
+  const auto running = cancellation.issue(std::nullopt);
+  const auto queued = cancellation.issue(std::nullopt);
+  cancellation.begin(queued, &model);
+  cancellation.stop(running.ticket);
+  CHECK(stoppedModels().empty());
+
+  cancellation.stop(queued.ticket);
+  CHECK(stoppedModels().size() == 1 && stoppedModels()[0] == &model);
+
+  cancellation.end();
+  cancellation.stop(cancellation.issue(std::nullopt).ticket);
+  CHECK(stoppedModels().size() == 1);
+}
+
+TEST(ExpiresAfterTheTimeoutOfTheOptions) {
+  CactusCancellation cancellation;
+  const auto request =
+      cancellation.issue(std::string(R"({"temperature":0.1,"timeout_ms":20})"));
+  CHECK(request.deadline);
+  CHECK(!cancellation.expired(request));
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  CHECK(cancellation.expired(request));
+
+  const auto unlimited =
+      cancellation.issue(std::string(R"({"timeout_ms":0})"));
+  CHECK(!unlimited.deadline);
+  CHECK(!cancellation.expired(unlimited));
+}
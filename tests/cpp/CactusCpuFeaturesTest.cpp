@@ -0,0 +1,39 @@
+#include "CactusCpuFeatures.hpp"
+#include "CactusDotprod.hpp"
+#include "CactusTest.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using margelo::nitro::cactus::CactusCpuFeatures;
+
+TEST(DetectsTheFeaturesOnce) {
+  CHECK(&CactusCpuFeatures::current() == &CactusCpuFeatures::current());
+}
+
+TEST(ReportsNoArmExtensionsOnOtherCores) {
+#if !defined(__aarch64__)
+  CHECK(!CactusCpuFeatures::current().dotprod);
+#endif
+}
+
+// Only built on arm64 hosts, where the test target compiles the kernel with
+// the extension like the Android build does
+TEST(DotprodKernelMatchesTheScalarSum) {
+#ifdef CACTUS_DOTPROD_DISPATCH
+  if (!CactusCpuFeatures::current().dotprod) {
+    return;
+  }
+  for (size_t n : {0u, 1u, 15u, 16u, 17u, 48u, 100u}) {
+    std::vector<int8_t> a(n), b(n);
+    int32_t expected = 0;
+    for (size_t i = 0; i < n; i++) {
+      a[i] = static_cast<int8_t>(i * 37 % 255 - 127);
+      b[i] = static_cast<int8_t>(127 - i * 53 % 255);
+      expected += static_cast<int32_t>(a[i]) * b[i];
+    }
+    CHECK(margelo::nitro::cactus::dotInt8Dotprod(a.data(), b.data(), n) ==
+          expected);
+  }
+#endif
+}
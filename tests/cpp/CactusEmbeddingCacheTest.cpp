@@ -0,0 +1,156 @@
+#include "CactusEmbeddingCache.hpp"
+#include "CactusTest.hpp"
+
+#include <fstream>
+
+using margelo::nitro::cactus::CactusEmbeddingCache;
+using cactus_test::TemporaryDirectory;
+
+namespace {
+
+void writeFile(const std::string &path, const std::string &contents) {
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+}
+
+size_t cacheFiles(const std::filesystem::path &directory) {
+  size_t count = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    count += entry.path().extension() == ".cache";
+  }
+  return count;
+}
+
+std::filesystem::path cacheFile(const std::filesystem::path &directory) {
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == ".cache") {
+      return entry.path();
+    }
+  }
+  return {};
+}
+
+struct Fixture {
+  TemporaryDirectory root;
+  std::string model;
+  std::string cache;
+
+  explicit Fixture(const std::string &name)
+      : root(name), model(root.file("model")), cache(root.file("cache")) {
+    std::filesystem::create_directories(model);
+    writeFile(model + "/config.txt", "hidden_dim=4\n");
+    writeFile(model + "/weights.bin", "0123456789");
+  }
+};
+
+const float kVector[3] = {1.0f, 2.0f, 3.0f};
+
+} // namespace
+
+TEST(ReturnsTheEmbeddingOfTheSameTextOnly) {
+  Fixture fixture("embedding_hit");
+  auto cache = CactusEmbeddingCache::open(fixture.cache, fixture.model);
+  cache->insert("hello", kVector, 3);
+
+  std::vector<float> embedding;
+  CHECK(cache->find("hello", embedding));
+  CHECK(embedding == std::vector<float>(kVector, kVector + 3));
+  CHECK(!cache->find("hellp", embedding));
+  CHECK(!cache->find("hell", embedding));
+}
+
+TEST(KeepsEmbeddingsAcrossInstances) {
+  Fixture fixture("embedding_persist");
+  CactusEmbeddingCache::open(fixture.cache, fixture.model)
+      ->insert("hello", kVector, 3);
+
+  std::vector<float> embedding;
+  CHECK(CactusEmbeddingCache::open(fixture.cache, fixture.model)
+            ->find("hello", embedding));
+  CHECK(embedding.size() == 3 && embedding[2] == 3.0f);
+}
+
+TEST(InstancesOfTheSameModelShareOneCache) {
+  Fixture fixture("embedding_shared");
+  auto first = CactusEmbeddingCache::open(fixture.cache, fixture.model);
+  auto second = CactusEmbeddingCache::open(fixture.cache, fixture.model);
+  CHECK(first == second);
+}
+
+TEST(StartsOverWhenTheModelFilesChange) {
+  Fixture fixture("embedding_identity");
+  CactusEmbeddingCache::open(fixture.cache, fixture.model)
+      ->insert("hello", kVector, 3);
+
+  writeFile(fixture.model + "/weights.bin", "a new download");
+  std::vector<float> embedding;
+  CHECK(!CactusEmbeddingCache::open(fixture.cache, fixture.model)
+             ->find("hello", embedding));
+  // The file of the previous download is deleted
+  CHECK(cacheFiles(fixture.cache) == 1);
+}
+
+TEST(ModelVersionsInUseKeepTheirFiles) {
+  Fixture fixture("embedding_versions");
+  auto previous = CactusEmbeddingCache::open(fixture.cache, fixture.model);
+  previous->insert("hello", kVector, 3);
+
+  writeFile(fixture.model + "/weights.bin", "a new download");
+  auto current = CactusEmbeddingCache::open(fixture.cache, fixture.model);
+  current->insert("world", kVector, 3);
+
+  std::vector<float> embedding;
+  CHECK(previous->find("hello", embedding));
+  CHECK(!previous->find("world", embedding));
+  CHECK(current->find("world", embedding));
+  CHECK(!current->find("hello", embedding));
+  CHECK(cacheFiles(fixture.cache) == 2);
+}
+
+TEST(DropsARecordCutShort) {
+  Fixture fixture("embedding_torn");
+  CactusEmbeddingCache::open(fixture.cache, fixture.model)
+      ->insert("hello", kVector, 3);
+
+  const auto path = cacheFile(fixture.cache);
+  const auto size = std::filesystem::file_size(path);
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    // The start of a record header whose floats never made it to disk
+    const char torn[20] = {1, 2, 3, 4, 5, 6, 7, 8, 5, 0, 0, 0, 3, 0, 0, 0};
+    file.write(torn, sizeof(torn));
+  }
+
+  auto cache = CactusEmbeddingCache::open(fixture.cache, fixture.model);
+  CHECK(std::filesystem::file_size(path) == size);
+
+  std::vector<float> embedding;
+  CHECK(cache->find("hello", embedding));
+  cache->insert("world", kVector, 3);
+  CHECK(cache->find("world", embedding));
+}
+
+TEST(EmptiesTheFileAtItsCap) {
+  Fixture fixture("embedding_cap");
+  constexpr size_t maxBytes = 256;
+  auto cache =
+      CactusEmbeddingCache::open(fixture.cache, fixture.model, maxBytes);
+
+  for (int i = 0; i < 20; i++) {
+    cache->insert("text " + std::to_string(i), kVector, 3);
+    CHECK(std::filesystem::file_size(cacheFile(fixture.cache)) <= maxBytes);
+  }
+
+  std::vector<float> embedding;
+  CHECK(cache->find("text 19", embedding));
+  CHECK(!cache->find("text 0", embedding));
+}
+
+TEST(SkipsEmbeddingsLargerThanTheCap) {
+  Fixture fixture("embedding_oversized");
+  auto cache = CactusEmbeddingCache::open(fixture.cache, fixture.model, 64);
+  const std::vector<float> large(64, 1.0f);
+  cache->insert("large", large.data(), large.size());
+
+  std::vector<float> embedding;
+  CHECK(!cache->find("large", embedding));
+}
@@ -0,0 +1,85 @@
+#include "CactusJsonReader.hpp"
+#include "CactusTest.hpp"
+
+#include <vector>
+
+using margelo::nitro::cactus::CactusJsonReader;
+
+TEST(ReadsStringsWithEscapes) {
+  const std::string json = R"("a\"b\\c\n\t\/")";
+  CactusJsonReader reader(json);
+  std::string value;
+  CHECK(reader.string(value));
+  CHECK(value == "a\"b\\c\n\t/");
+}
+
+TEST(ReadsUnicodeEscapesAsUtf8) {
+  const std::string json = R"("\u00e9\u4E2D\ud83c\udf35")";
+  CactusJsonReader reader(json);
+  std::string value;
+  CHECK(reader.string(value));
+  CHECK(value == "\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x8C\xB5");
+}
+
+TEST(RejectsUnterminatedStrings) {
+  const std::string json = R"("never closed)";
+  CactusJsonReader reader(json);
+  std::string value;
+  CHECK(!reader.string(value));
+
+  const std::string escape = R"("\u12")";
+  CactusJsonReader escapeReader(escape);
+  CHECK(!escapeReader.string(value));
+}
+
+TEST(ReadsNumbers) {
+  const std::string json = " -12.5e1";
+  CactusJsonReader reader(json);
+  double value = 0;
+  CHECK(reader.number(value));
+  CHECK(value == -125);
+
+  const std::string text = "true";
+  CactusJsonReader textReader(text);
+  CHECK(!textReader.number(value));
+}
+
+TEST(VisitsEveryKeyOfAnObject) {
+  const std::string json =
+      R"({ "a": 1, "nested": {"b": [1, {"c": "]"}]}, "s": "x", "n": null })";
+  CactusJsonReader reader(json);
+  std::vector<std::string> keys;
+  std::string s;
+  CHECK(reader.object([&](const std::string &key) {
+    keys.push_back(key);
+    return key == "s" ? reader.string(s) : reader.skip();
+  }));
+  CHECK((keys == std::vector<std::string>{"a", "nested", "s", "n"}));
+  CHECK(s == "x");
+  CHECK(reader.peek() == 0);
+}
+
+TEST(ReadsEmptyContainers) {
+  const std::string json = R"({"a":[],"b":{}})";
+  CactusJsonReader reader(json);
+  CHECK(reader.object([&](const std::string &) { return reader.skip(); }));
+}
+
+TEST(RejectsMalformedContainers) {
+  for (const std::string json :
+       {R"({"a":1)", R"({"a" 1})", R"([1,2)", R"({a:1})", ""}) {
+    CactusJsonReader reader(json);
+    CHECK(!reader.skip());
+  }
+  const std::string json = R"({"a":1,})";
+  CactusJsonReader reader(json);
+  CHECK(!reader.object([&](const std::string &) { return reader.skip(); }));
+}
+
+TEST(PeeksPastWhitespace) {
+  const std::string json = "  \n [1]";
+  CactusJsonReader reader(json);
+  CHECK(reader.peek() == '[');
+  CHECK(reader.array([&]() { return reader.skip(); }));
+  CHECK(reader.peek() == 0);
+}
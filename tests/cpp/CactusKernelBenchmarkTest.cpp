@@ -0,0 +1,20 @@
+#include "CactusKernelBenchmark.hpp"
+#include "CactusTest.hpp"
+
+#include <stdexcept>
+#include <string>
+
+using margelo::nitro::cactus::CactusKernelBenchmark;
+
+// The kernels are only linkable from the Android arm64 build, so the host can
+// only check that the benchmark refuses to run without them
+TEST(ThrowsWhereTheKernelsAreNotLinked) {
+  std::string message;
+  try {
+    CactusKernelBenchmark(1).run();
+  } catch (const std::runtime_error &error) {
+    message = error.what();
+  }
+  CHECK(message ==
+        "Cactus kernel benchmarks are only available on Android arm64");
+}
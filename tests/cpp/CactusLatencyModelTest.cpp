@@ -0,0 +1,112 @@
+#include "CactusJsonReader.hpp"
+#include "CactusLatencyModel.hpp"
+#include "CactusTest.hpp"
+
+#include <cmath>
+#include <map>
+
+using margelo::nitro::cactus::CactusJsonReader;
+using margelo::nitro::cactus::CactusLatencyModel;
+
+namespace {
+
+const std::string kMessages =
+    R"([{"role":"system","content":"Be brief."},)"
+    R"({"role":"user","content":"What is the capital of France?"}])";
+
+struct Prediction {
+  double promptTokens = 0;
+  double prefillMs = 0;
+  double decodeMs = 0;
+  double totalMs = 0;
+  bool calibrated = false;
+};
+
+Prediction readPrediction(const std::string &json) {
+  Prediction prediction;
+  CactusJsonReader reader(json);
+  CHECK(reader.object([&](const std::string &key) {
+    if (key == "prompt_tokens") {
+      return reader.number(prediction.promptTokens);
+    }
+    if (key == "prefill_ms") {
+      return reader.number(prediction.prefillMs);
+    }
+    if (key == "decode_ms") {
+      return reader.number(prediction.decodeMs);
+    }
+    if (key == "total_ms") {
+      return reader.number(prediction.totalMs);
+    }
+    if (key == "calibrated") {
+      prediction.calibrated = reader.peek() == 't';
+    }
+    return reader.skip();
+  }));
+  return prediction;
+}
+
+bool near(double value, double expected) {
+  return std::fabs(value - expected) < 1e-3 * std::max(1.0, expected);
+}
+
+} // namespace
+
+TEST(EstimatesPromptTokensFromTheMessages) {
+  // 39 bytes of content, two messages and one image
+  const std::string messages =
+      R"([{"role":"system","content":"Be brief."},)"
+      R"({"role":"user","content":"What is the capital of France?",)"
+      R"("images":["/tmp/a.png"]}])";
+  CHECK(CactusLatencyModel::estimatePromptTokens(messages) ==
+        10 + 2 * 4 + 64);
+  CHECK(CactusLatencyModel::estimatePromptTokens("not json") == 2);
+}
+
+TEST(IsUncalibratedUntilItLearns) {
+  CactusLatencyModel model;
+  const auto prediction = readPrediction(model.predict(kMessages, 100));
+  CHECK(!prediction.calibrated);
+  CHECK(prediction.totalMs == 0);
+  CHECK(prediction.promptTokens > 0);
+}
+
+TEST(PredictsFromABenchmark) {
+  CactusLatencyModel model;
+  model.calibrate(
+      R"({"prefill":[{"prefill_tokens":64,"time_to_first_token_ms":)"
+      R"({"p50":64,"p90":80}},{"prefill_tokens":512,)"
+      R"("time_to_first_token_ms":{"p50":256,"p90":300}}],)"
+      R"("decode":[{"decode_tokens":128,"tokens_per_second":20}]})");
+
+  const auto prediction = readPrediction(model.predict(kMessages, 100));
+  CHECK(prediction.calibrated);
+  // The longest prefill run at 0.5 ms per token, 50 ms per decoded token
+  CHECK(near(prediction.prefillMs, prediction.promptTokens * 0.5));
+  CHECK(near(prediction.decodeMs, 5000));
+  CHECK(near(prediction.totalMs, prediction.prefillMs + 5000));
+}
+
+TEST(LearnsFromCompletions) {
+  CactusLatencyModel model;
+  model.observe(R"({"success":true,"time_to_first_token_ms":100.0,)"
+                R"("tokens_per_second":10.0,"prefill_tokens":100,)"
+                R"("decode_tokens":50,"total_tokens":150})");
+  auto prediction = readPrediction(model.predict(kMessages, 10));
+  CHECK(prediction.calibrated);
+  CHECK(near(prediction.decodeMs, 1000));
+
+  // Later completions move the speed a step towards what they measured
+  model.observe(R"({"time_to_first_token_ms":100.0,)"
+                R"("tokens_per_second":20.0,"prefill_tokens":100,)"
+                R"("decode_tokens":50})");
+  prediction = readPrediction(model.predict(kMessages, 10));
+  CHECK(near(prediction.decodeMs, 10 * (100 + 0.3 * (50 - 100))));
+}
+
+TEST(IgnoresCompletionsTooShortToMeasure) {
+  CactusLatencyModel model;
+  model.observe(R"({"time_to_first_token_ms":5.0,"tokens_per_second":0,)"
+                R"("prefill_tokens":3,"decode_tokens":1})");
+  CHECK(!readPrediction(model.predict(kMessages, 10)).calibrated);
+}
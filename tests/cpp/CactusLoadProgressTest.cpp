@@ -0,0 +1,72 @@
+#include "CactusLoadProgress.hpp"
+#include "CactusTest.hpp"
+
+#include <fstream>
+
+using margelo::nitro::cactus::CactusLoadProgress;
+
+namespace {
+
+void writeFile(const std::filesystem::path &path, size_t bytes) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path, std::ios::binary) << std::string(bytes, 'w');
+}
+
+// Waits for the sampling thread to publish a value above 0
+double awaitProgress(const CactusLoadProgress &progress) {
+  for (int i = 0; i < 500 && progress.progress() == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return progress.progress();
+}
+
+} // namespace
+
+TEST(StartsAtZero) {
+  CactusLoadProgress progress;
+  CHECK(progress.progress() == 0);
+}
+
+TEST(FollowsTheResidentWeightsUpToTheReadShare) {
+  cactus_test::TemporaryDirectory model("load_progress_read");
+  writeFile(model.path() / "layer_0_attn.weights", 10000);
+  writeFile(model.path() / "layer_1_ffn.weights", 10000);
+
+  CactusLoadProgress progress(std::chrono::milliseconds(1));
+  progress.begin(model.path().string());
+  // Just written, so the pages are still in the page cache
+  const double read = awaitProgress(progress);
+  CHECK(read > 0);
+  CHECK(read <= CactusLoadProgress::kReadShare);
+
+  progress.end(true);
+  CHECK(progress.progress() == 1);
+}
+
+TEST(ReportsZeroAfterAFailedLoad) {
+  cactus_test::TemporaryDirectory model("load_progress_failed");
+  writeFile(model.path() / "layer_0_attn.weights", 10000);
+
+  CactusLoadProgress progress(std::chrono::milliseconds(1));
+  progress.begin(model.path().string());
+  awaitProgress(progress);
+  progress.end(false);
+  CHECK(progress.progress() == 0);
+
+  // A later load starts from zero again
+  progress.begin(model.path().string());
+  CHECK(awaitProgress(progress) > 0);
+  progress.end(true);
+  CHECK(progress.progress() == 1);
+}
+
+TEST(StaysAtZeroForMissingModels) {
+  cactus_test::TemporaryDirectory model("load_progress_missing");
+  CactusLoadProgress progress(std::chrono::milliseconds(1));
+  progress.begin(model.file("missing"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(progress.progress() == 0);
+  // Ending without a sample in between does not hang
+  progress.end(false);
+  CHECK(progress.progress() == 0);
+}
@@ -0,0 +1,119 @@
+#include "CactusJsonReader.hpp"
+#include "CactusMetrics.hpp"
+#include "CactusTest.hpp"
+
+#include <cmath>
+#include <functional>
+#include <map>
+#include <thread>
+#include <vector>
+
+using margelo::nitro::cactus::CactusJsonReader;
+using margelo::nitro::cactus::CactusMetrics;
+
+namespace {
+
+// The numbers of a snapshot by their path, as in "histograms.latency.p50"
+std::map<std::string, double> readSnapshot(const std::string &json) {
+  std::map<std::string, double> values;
+  CactusJsonReader reader(json);
+  std::function<bool(const std::string &)> readValue =
+      [&](const std::string &path) -> bool {
+    const char next = reader.peek();
+    if (next == '{') {
+      return reader.object([&](const std::string &key) {
+        return readValue(path.empty() ? key : path + "." + key);
+      });
+    }
+    if (next == '[') {
+      return reader.skip();
+    }
+    double value;
+    if (!reader.number(value)) {
+      return false;
+    }
+    values[path] = value;
+    return true;
+  };
+  CHECK(readValue("") && reader.peek() == 0);
+  return values;
+}
+
+} // namespace
+
+TEST(ReturnsTheSameMetricForAName) {
+  CactusMetrics metrics;
+  CHECK(&metrics.counter("a") == &metrics.counter("a"));
+  CHECK(&metrics.counter("a") != &metrics.counter("b"));
+  CHECK(&metrics.histogram("a") == &metrics.histogram("a"));
+}
+
+TEST(CountsFromSeveralThreads) {
+  CactusMetrics metrics;
+  auto &counter = metrics.counter("calls");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&counter]() {
+      for (int j = 0; j < 10000; j++) {
+        counter.add();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  counter.add(5);
+  CHECK(readSnapshot(metrics.snapshot())["counters.calls"] == 40005);
+}
+
+TEST(KeepsThePeakOfAGauge) {
+  CactusMetrics metrics;
+  auto &gauge = metrics.gauge("bytes");
+  gauge.set(10);
+  gauge.set(30);
+  gauge.set(20);
+  auto values = readSnapshot(metrics.snapshot());
+  CHECK(values["gauges.bytes.value"] == 20);
+  CHECK(values["gauges.bytes.peak"] == 30);
+
+  metrics.reset();
+  values = readSnapshot(metrics.snapshot());
+  CHECK(values["gauges.bytes.value"] == 20);
+  CHECK(values["gauges.bytes.peak"] == 20);
+}
+
+TEST(ReportsPercentilesWithinTheBucketError) {
+  CactusMetrics metrics;
+  auto &histogram = metrics.histogram("latency");
+  for (int i = 1; i <= 1000; i++) {
+    histogram.record(i);
+  }
+  histogram.record(NAN);
+
+  auto values = readSnapshot(metrics.snapshot());
+  CHECK(values["histograms.latency.count"] == 1000);
+  CHECK(values["histograms.latency.sum"] == 500500);
+  CHECK(values["histograms.latency.max"] == 1000);
+  CHECK(std::fabs(values["histograms.latency.p50"] / 500 - 1) < 0.09);
+  CHECK(std::fabs(values["histograms.latency.p90"] / 900 - 1) < 0.09);
+  CHECK(values["histograms.latency.p99"] <= 1000);
+  CHECK(std::fabs(values["histograms.latency.p99"] / 990 - 1) < 0.09);
+}
+
+TEST(ZeroesCountersAndHistogramsOnReset) {
+  CactusMetrics metrics;
+  metrics.counter("calls").add(3);
+  metrics.histogram("latency").record(2);
+  metrics.reset();
+
+  auto values = readSnapshot(metrics.snapshot());
+  CHECK(values["counters.calls"] == 0);
+  CHECK(values["histograms.latency.count"] == 0);
+  CHECK(values["histograms.latency.max"] == 0);
+}
+
+TEST(WritesAnEmptySnapshot) {
+  CactusMetrics metrics;
+  CHECK(metrics.snapshot() ==
+        R"({"counters":{},"gauges":{},"histograms":{}})");
+}
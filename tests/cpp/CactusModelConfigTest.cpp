@@ -0,0 +1,72 @@
+#include "CactusModelConfig.hpp"
+#include "CactusTest.hpp"
+
+#include <fstream>
+
+using margelo::nitro::cactus::CactusModelConfig;
+
+namespace {
+
+void writeConfig(const cactus_test::TemporaryDirectory &directory,
+                 const std::string &contents) {
+  std::ofstream(directory.file("config.txt")) << contents;
+}
+
+} // namespace
+
+TEST(ReadsTheShapeOfTheCache) {
+  cactus_test::TemporaryDirectory directory("config_read");
+  writeConfig(directory, "vocab_size=151936\n"
+                         "num_layers=28\n"
+                         "attention_kv_heads=8\n"
+                         "attention_head_dim=128\n"
+                         "context_size=32768\n"
+                         "precision=FP16\n");
+
+  const auto config = CactusModelConfig::fromModelPath(directory.path());
+  CHECK(config);
+  CHECK(config->numLayers == 28);
+  CHECK(config->attentionKvHeads == 8);
+  CHECK(config->attentionHeadDim == 128);
+  CHECK(config->maxContextSize == 32768);
+  CHECK(config->elementSize == 2);
+}
+
+TEST(RejectsConfigsWithoutTheCacheShape) {
+  cactus_test::TemporaryDirectory directory("config_reject");
+  CHECK(!CactusModelConfig::fromModelPath(directory.path()));
+
+  writeConfig(directory, "num_layers=28\nattention_head_dim=128\n");
+  CHECK(!CactusModelConfig::fromModelPath(directory.path()));
+
+  writeConfig(directory, "num_layers=many\nattention_kv_heads=8\n"
+                         "attention_head_dim=128\n");
+  CHECK(!CactusModelConfig::fromModelPath(directory.path()));
+}
+
+TEST(SizesTheCacheForAContext) {
+  CactusModelConfig config;
+  config.numLayers = 28;
+  config.attentionKvHeads = 8;
+  config.attentionHeadDim = 128;
+  config.elementSize = 1;
+
+  // Keys and values of 8 heads of 128 per layer and token
+  CHECK(config.kvCacheBytes(1) == 2 * 28 * 8 * 128);
+  CHECK(config.kvCacheBytes(2048) == 2048 * config.kvCacheBytes(1));
+}
+
+TEST(FitsTheLargestContextInMemory) {
+  CactusModelConfig config;
+  config.numLayers = 2;
+  config.attentionKvHeads = 1;
+  config.attentionHeadDim = 64;
+  config.elementSize = 2;
+  const size_t perToken = config.kvCacheBytes(1);
+
+  CHECK(config.contextSizeFitting(1000 * perToken) == 768);
+  CHECK(config.contextSizeFitting(100 * perToken) == 0);
+
+  config.maxContextSize = 512;
+  CHECK(config.contextSizeFitting(1000 * perToken) == 512);
+}
@@ -0,0 +1,71 @@
+#include "CactusModelFiles.hpp"
+#include "CactusTest.hpp"
+
+#include <fstream>
+
+using margelo::nitro::cactus::modelFileBytes;
+using margelo::nitro::cactus::modelFilePaths;
+using margelo::nitro::cactus::prefetchModelFiles;
+using margelo::nitro::cactus::residentModelFileBytes;
+
+namespace {
+
+void writeFile(const std::filesystem::path &path, size_t bytes) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path, std::ios::binary) << std::string(bytes, 'w');
+}
+
+} // namespace
+
+TEST(ListsTheFilesInLayerOrder) {
+  cactus_test::TemporaryDirectory model("model_files_order");
+  writeFile(model.path() / "layer_10_attn.weights", 16);
+  writeFile(model.path() / "layer_2_ffn.weights", 16);
+  writeFile(model.path() / "layer_1_ffn.weights", 16);
+  writeFile(model.path() / "layer_0_attn.weights", 16);
+  writeFile(model.path() / "config.txt", 4);
+  writeFile(model.path() / "vision" / "patch.weights", 8);
+
+  const auto paths = modelFilePaths(model.path().string());
+  CHECK(paths.size() == 6);
+  CHECK(paths.size() == 6 && paths[0].filename() == "config.txt" &&
+        paths[1].filename() == "patch.weights" &&
+        paths[2].filename() == "layer_0_attn.weights" &&
+        paths[3].filename() == "layer_1_ffn.weights" &&
+        paths[4].filename() == "layer_2_ffn.weights" &&
+        paths[5].filename() == "layer_10_attn.weights");
+}
+
+TEST(SumsTheFileSizes) {
+  cactus_test::TemporaryDirectory model("model_files_bytes");
+  writeFile(model.path() / "a.weights", 100);
+  writeFile(model.path() / "nested" / "b.weights", 28);
+  CHECK(modelFileBytes(model.path().string()) == 128);
+}
+
+TEST(AdvisesEveryFile) {
+  cactus_test::TemporaryDirectory model("model_files_prefetch");
+  writeFile(model.path() / "a.weights", 4096);
+  writeFile(model.path() / "b.weights", 0);
+  writeFile(model.path() / "nested" / "c.weights", 4096);
+  CHECK(prefetchModelFiles(model.path().string()) == 3);
+}
+
+TEST(CountsTheResidentBytes) {
+  cactus_test::TemporaryDirectory model("model_files_resident");
+  writeFile(model.path() / "a.weights", 10000);
+  writeFile(model.path() / "b.weights", 0);
+  // Just written, so the pages are still in the page cache
+  const size_t resident = residentModelFileBytes(model.path().string());
+  CHECK(resident > 0);
+  CHECK(resident <= modelFileBytes(model.path().string()));
+}
+
+TEST(IgnoresMissingModels) {
+  cactus_test::TemporaryDirectory model("model_files_missing");
+  const std::string missing = model.file("missing");
+  CHECK(modelFilePaths(missing).empty());
+  CHECK(modelFileBytes(missing) == 0);
+  CHECK(prefetchModelFiles(missing) == 0);
+  CHECK(residentModelFileBytes(missing) == 0);
+}
@@ -0,0 +1,106 @@
+#include "CactusModelRegistry.hpp"
+#include "CactusTest.hpp"
+
+using margelo::nitro::cactus::CactusMemoryPressure;
+using margelo::nitro::cactus::CactusModelRegistry;
+
+namespace {
+
+constexpr size_t kMiB = 1024 * 1024;
+
+// Unloads unless busy and counts the calls
+struct Owner {
+  bool busy = false;
+  int unloads = 0;
+  size_t shedBytes = 0;
+
+  void acquire(CactusModelRegistry &registry, const std::string &weightsPath,
+               size_t weightBytes, size_t bytes) {
+    registry.acquire(
+        this, weightsPath, weightBytes, bytes,
+        [this]() {
+          if (busy) {
+            return false;
+          }
+          unloads++;
+          return true;
+        },
+        [this]() -> std::optional<size_t> {
+          if (busy) {
+            return std::nullopt;
+          }
+          return shedBytes;
+        });
+  }
+};
+
+} // namespace
+
+TEST(CountsSharedWeightsOnce) {
+  CactusModelRegistry registry;
+  Owner first, second, other;
+  first.acquire(registry, "/models/a", 100 * kMiB, 10 * kMiB);
+  second.acquire(registry, "/models/a/", 100 * kMiB, 20 * kMiB);
+  CHECK(registry.residentBytes() == 130 * kMiB);
+
+  other.acquire(registry, "/models/b", 50 * kMiB, 5 * kMiB);
+  CHECK(registry.residentBytes() == 185 * kMiB);
+
+  registry.release(&first);
+  CHECK(registry.residentBytes() == 175 * kMiB);
+  registry.release(&second);
+  CHECK(registry.residentBytes() == 55 * kMiB);
+}
+
+TEST(KeepsOwnersOfSharedWeightsThatFitTheBudget) {
+  CactusModelRegistry registry;
+  registry.setMemoryBudget(150 * kMiB);
+  Owner first, second;
+  first.acquire(registry, "/models/a", 100 * kMiB, 10 * kMiB);
+  second.acquire(registry, "/models/a", 100 * kMiB, 10 * kMiB);
+  CHECK(first.unloads == 0);
+  CHECK(registry.residentBytes() == 120 * kMiB);
+}
+
+TEST(EvictsLeastRecentlyUsedFirst) {
+  CactusModelRegistry registry;
+  registry.setMemoryBudget(250 * kMiB);
+  Owner first, second, third;
+  first.acquire(registry, "/models/a", 100 * kMiB, 0);
+  second.acquire(registry, "/models/b", 100 * kMiB, 0);
+  first.acquire(registry, "/models/a", 100 * kMiB, 0);
+  third.acquire(registry, "/models/c", 100 * kMiB, 0);
+  CHECK(first.unloads == 0);
+  CHECK(second.unloads == 1);
+  CHECK(third.unloads == 0);
+  CHECK(registry.residentBytes() == 200 * kMiB);
+}
+
+TEST(SkipsBusyModels) {
+  CactusModelRegistry registry;
+  registry.setMemoryBudget(150 * kMiB);
+  Owner first, second;
+  first.busy = true;
+  first.acquire(registry, "/models/a", 100 * kMiB, 0);
+  second.acquire(registry, "/models/b", 100 * kMiB, 0);
+  CHECK(first.unloads == 0);
+  CHECK(registry.residentBytes() == 200 * kMiB);
+}
+
+TEST(ShedsOrUnloadsUnderPressure) {
+  CactusModelRegistry registry;
+  Owner idle, busy;
+  idle.shedBytes = 1 * kMiB;
+  busy.busy = true;
+  idle.acquire(registry, "/models/a", 100 * kMiB, 10 * kMiB);
+  busy.acquire(registry, "/models/b", 100 * kMiB, 10 * kMiB);
+
+  registry.trim(CactusMemoryPressure::Moderate);
+  CHECK(registry.residentBytes() == 211 * kMiB);
+  CHECK(idle.unloads == 0);
+
+  registry.trim(CactusMemoryPressure::Critical);
+  CHECK(idle.unloads == 1);
+  CHECK(busy.unloads == 0);
+  CHECK(registry.residentBytes() == 110 * kMiB);
+}
@@ -0,0 +1,92 @@
+#include "CactusModelScheduler.hpp"
+#include "CactusTest.hpp"
+
+#include <thread>
+#include <vector>
+
+using margelo::nitro::cactus::CactusModelScheduler;
+using Priority = CactusModelScheduler::Priority;
+
+namespace {
+
+void waitForQueue(CactusModelScheduler &scheduler, size_t depth) {
+  while (scheduler.queueDepth() < depth) {
+    std::this_thread::yield();
+  }
+}
+
+// Queues one operation per priority while the model is busy, each waiting
+// for the previous one, and returns the order they ran in
+std::vector<int> runOrder(CactusModelScheduler &scheduler,
+                          const std::vector<Priority> &priorities) {
+  std::vector<int> order;
+  std::mutex orderMutex;
+  std::vector<std::thread> threads;
+
+  scheduler.lock(Priority::Interactive);
+  for (size_t i = 0; i < priorities.size(); i++) {
+    threads.emplace_back([&, i]() {
+      CactusModelScheduler::Guard guard(scheduler, priorities[i]);
+      std::lock_guard<std::mutex> lock(orderMutex);
+      order.push_back(static_cast<int>(i));
+    });
+    waitForQueue(scheduler, i + 1);
+  }
+  scheduler.unlock();
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return order;
+}
+
+} // namespace
+
+TEST(ServesHigherPrioritiesFirst) {
+  CactusModelScheduler scheduler;
+  const auto order = runOrder(scheduler, {Priority::Background,
+                                          Priority::Embedding,
+                                          Priority::Interactive});
+  CHECK((order == std::vector<int>{2, 1, 0}));
+}
+
+TEST(ServesAClassInArrivalOrder) {
+  CactusModelScheduler scheduler;
+  const auto order = runOrder(
+      scheduler, {Priority::Embedding, Priority::Embedding,
+                  Priority::Interactive, Priority::Embedding});
+  CHECK((order == std::vector<int>{2, 0, 1, 3}));
+}
+
+TEST(TryLockOnlySucceedsWhenIdle) {
+  CactusModelScheduler scheduler;
+  CHECK(scheduler.try_lock());
+  CHECK(!scheduler.try_lock());
+
+  std::thread waiter([&scheduler]() {
+    CactusModelScheduler::Guard guard(scheduler, Priority::Background);
+  });
+  waitForQueue(scheduler, 1);
+  scheduler.unlock();
+  waiter.join();
+
+  CHECK(scheduler.try_lock());
+  scheduler.unlock();
+}
+
+TEST(YieldLetsHigherPrioritiesRun) {
+  CactusModelScheduler scheduler;
+  CactusModelScheduler::Guard guard(scheduler, Priority::Background);
+  CHECK(!guard.yield());
+
+  bool ran = false;
+  std::thread interactive([&]() {
+    CactusModelScheduler::Guard other(scheduler, Priority::Interactive);
+    ran = true;
+  });
+  waitForQueue(scheduler, 1);
+  CHECK(guard.yield());
+  CHECK(ran);
+  CHECK(scheduler.queueDepth() == 0);
+  interactive.join();
+}
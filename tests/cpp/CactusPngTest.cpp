@@ -0,0 +1,228 @@
+#include "CactusPng.hpp"
+#include "CactusTest.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include <vector>
+
+using margelo::nitro::cactus::writeContentNamedPng;
+using margelo::nitro::cactus::writeUncompressedPng;
+
+namespace {
+
+uint32_t bigEndian(const uint8_t *data) {
+  return (uint32_t{data[0]} << 24) | (uint32_t{data[1]} << 16) |
+         (uint32_t{data[2]} << 8) | data[3];
+}
+
+uint32_t crc32(const uint8_t *data, size_t size) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; ++k) {
+      crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+ino_t inode(const std::string &path) {
+  struct stat info {};
+  stat(path.c_str(), &info);
+  return info.st_ino;
+}
+
+struct Png {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  // The filtered rows
+  std::vector<uint8_t> rows;
+  bool valid = false;
+};
+
+// Checks every chunk CRC and reads the stored deflate blocks back, which is
+// all a decoder needs for the files the wrapper writes
+Png readPng(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+  Png png;
+  const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  if (bytes.size() < 8 || !std::equal(signature, signature + 8, bytes.data())) {
+    return png;
+  }
+
+  std::vector<uint8_t> zlib;
+  bool ended = false;
+  size_t pos = 8;
+  while (pos + 12 <= bytes.size() && !ended) {
+    const uint32_t length = bigEndian(&bytes[pos]);
+    const std::string type(bytes.begin() + pos + 4, bytes.begin() + pos + 8);
+    if (pos + 12 + length > bytes.size() ||
+        crc32(&bytes[pos + 4], length + 4) !=
+            bigEndian(&bytes[pos + 8 + length])) {
+      return png;
+    }
+    const uint8_t *data = &bytes[pos + 8];
+    if (type == "IHDR") {
+      png.width = bigEndian(data);
+      png.height = bigEndian(data + 4);
+    } else if (type == "IDAT") {
+      zlib.insert(zlib.end(), data, data + length);
+    } else if (type == "IEND") {
+      ended = true;
+    }
+    pos += 12 + length;
+  }
+  if (!ended || pos != bytes.size() || zlib.size() < 6) {
+    return png;
+  }
+
+  size_t at = 2;
+  bool final = false;
+  while (!final) {
+    if (at + 5 > zlib.size() || (zlib[at] & 0x06) != 0) {
+      return png;
+    }
+    final = zlib[at] & 1;
+    const uint16_t size = zlib[at + 1] | (zlib[at + 2] << 8);
+    const uint16_t complement = zlib[at + 3] | (zlib[at + 4] << 8);
+    if (static_cast<uint16_t>(~size) != complement ||
+        at + 5 + size > zlib.size()) {
+      return png;
+    }
+    png.rows.insert(png.rows.end(), zlib.begin() + at + 5,
+                    zlib.begin() + at + 5 + size);
+    at += 5 + size;
+  }
+
+  uint32_t a = 1, b = 0;
+  for (const uint8_t byte : png.rows) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  png.valid = at + 4 == zlib.size() && bigEndian(&zlib[at]) == ((b << 16) | a);
+  return png;
+}
+
+std::vector<uint8_t> gradient(uint32_t width, uint32_t height) {
+  std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+  for (size_t i = 0; i < rgb.size(); ++i) {
+    rgb[i] = static_cast<uint8_t>(i * 7);
+  }
+  return rgb;
+}
+
+void checkRoundTrip(const std::string &path, uint32_t width,
+                    uint32_t height) {
+  const auto rgb = gradient(width, height);
+  writeUncompressedPng(path, rgb.data(), width, height);
+
+  const auto png = readPng(path);
+  CHECK(png.valid);
+  CHECK(png.width == width && png.height == height);
+  CHECK(png.rows.size() == (width * 3 + 1) * height);
+  bool matches = png.rows.size() == (width * 3 + 1) * height;
+  for (uint32_t y = 0; matches && y < height; ++y) {
+    const uint8_t *row = png.rows.data() + y * (width * 3 + 1);
+    matches = row[0] == 0 &&
+              std::equal(row + 1, row + 1 + width * 3, &rgb[y * width * 3]);
+  }
+  CHECK(matches);
+}
+
+} // namespace
+
+TEST(WritesASmallImage) {
+  cactus_test::TemporaryDirectory directory("png_small");
+  checkRoundTrip(directory.file("a.png"), 3, 2);
+}
+
+TEST(SplitsLargeImagesIntoStoredBlocks) {
+  // 385 KiB of rows, which spans several 64 KiB deflate blocks
+  cactus_test::TemporaryDirectory directory("png_large");
+  checkRoundTrip(directory.file("a.png"), 512, 257);
+}
+
+TEST(HandlesRowsAtTheBlockSize) {
+  // (3 * 13102 + 1) * 5 rows fill one block exactly, 3 * 21845 + 1 bytes
+  // leave one byte for a second block
+  cactus_test::TemporaryDirectory directory("png_exact");
+  checkRoundTrip(directory.file("a.png"), 13102, 5);
+  checkRoundTrip(directory.file("b.png"), 21845, 1);
+}
+
+TEST(ThrowsWhenItCannotWrite) {
+  cactus_test::TemporaryDirectory directory("png_fail");
+  const uint8_t rgb[3] = {};
+  CHECK_THROWS(writeUncompressedPng(directory.file("missing/a.png"), rgb, 1,
+                                    1));
+}
+
+TEST(NamesFilesAfterTheirContent) {
+  cactus_test::TemporaryDirectory directory("png_named");
+  const std::string images = directory.file("images");
+  auto rgb = gradient(4, 4);
+
+  const std::string path = writeContentNamedPng(images, rgb.data(), 4, 4);
+  CHECK(std::filesystem::path(path).parent_path() == images);
+  CHECK(readPng(path).valid);
+  CHECK(!std::filesystem::exists(path + ".part"));
+
+  // A new buffer with the same pixels maps to the same file, which is kept
+  // rather than written again under a new inode
+  const auto copy = rgb;
+  const ino_t written = inode(path);
+  CHECK(writeContentNamedPng(images, copy.data(), 4, 4) == path);
+  CHECK(inode(path) == written);
+
+  rgb[0] ^= 1;
+  const std::string other = writeContentNamedPng(images, rgb.data(), 4, 4);
+  CHECK(other != path);
+  CHECK(readPng(other).valid);
+}
+
+TEST(EvictsTheLeastRecentlyUsedImages) {
+  cactus_test::TemporaryDirectory directory("png_evict");
+  const std::string images = directory.file("images");
+  auto rgb = gradient(4, 4);
+  auto frame = [&rgb](uint8_t n) {
+    rgb[0] = n;
+    return rgb;
+  };
+
+  const auto first = frame(1);
+  const auto second = frame(2);
+  const std::string firstPath =
+      writeContentNamedPng(images, first.data(), 4, 4, 3);
+  const std::string secondPath =
+      writeContentNamedPng(images, second.data(), 4, 4, 3);
+  const auto third = frame(3);
+  writeContentNamedPng(images, third.data(), 4, 4, 3);
+  // Sending the first image again makes the second the oldest
+  CHECK(writeContentNamedPng(images, first.data(), 4, 4, 3) == firstPath);
+
+  const auto fourth = frame(4);
+  const std::string fourthPath =
+      writeContentNamedPng(images, fourth.data(), 4, 4, 3);
+  CHECK(std::filesystem::exists(firstPath));
+  CHECK(!std::filesystem::exists(secondPath));
+  CHECK(std::filesystem::exists(fourthPath));
+
+  // A feed of new frames stays at the cap
+  for (uint8_t n = 10; n < 20; ++n) {
+    const auto next = frame(n);
+    writeContentNamedPng(images, next.data(), 4, 4, 3);
+  }
+  size_t files = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(images)) {
+    (void)entry;
+    files++;
+  }
+  CHECK(files == 3);
+
+  // An evicted image is written again when it is sent again
+  CHECK(writeContentNamedPng(images, second.data(), 4, 4, 3) == secondPath);
+  CHECK(readPng(secondPath).valid);
+}
@@ -0,0 +1,48 @@
+#include "CactusResponseBuffer.hpp"
+#include "CactusTest.hpp"
+
+#include <cstring>
+
+using margelo::nitro::cactus::CactusResponseBuffer;
+
+TEST(CopiesOutExactlyTheResponse) {
+  CactusResponseBuffer buffer;
+  char *data = buffer.prepare(64);
+  std::strcpy(data, "{\"success\":true}");
+  CHECK(buffer.take(64) == "{\"success\":true}");
+}
+
+TEST(OnlyGrows) {
+  CactusResponseBuffer buffer;
+  buffer.prepare(1024);
+  buffer.prepare(16);
+  CHECK(buffer.capacity() == 1024);
+  buffer.prepare(4096);
+  CHECK(buffer.capacity() == 4096);
+}
+
+TEST(ClearsWhatAnEarlierResponseLeft) {
+  CactusResponseBuffer buffer;
+  std::strcpy(buffer.prepare(64), "{\"response\":\"earlier\"}");
+  buffer.prepare(64);
+  // The engine wrote nothing, as the response did not fit
+  CHECK_THROWS(buffer.take(64));
+}
+
+TEST(StopsAtTheRequestedSize) {
+  CactusResponseBuffer buffer;
+  char *data = buffer.prepare(8);
+  std::memset(data, 'x', 8);
+  CHECK(buffer.take(8) == "xxxxxxxx");
+  CHECK(buffer.take(4) == "xxxx");
+}
+
+TEST(ReleasesItsMemory) {
+  CactusResponseBuffer buffer;
+  buffer.prepare(1024);
+  buffer.release();
+  CHECK(buffer.capacity() == 0);
+  CHECK_THROWS(buffer.take(1024));
+  std::strcpy(buffer.prepare(0), "");
+  CHECK(buffer.capacity() == 1);
+}
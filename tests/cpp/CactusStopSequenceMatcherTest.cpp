@@ -0,0 +1,58 @@
+#include "CactusStopSequenceMatcher.hpp"
+#include "CactusTest.hpp"
+
+using margelo::nitro::cactus::CactusStopSequenceMatcher;
+
+TEST(IsDisabledWithoutSequences) {
+  CHECK(!CactusStopSequenceMatcher({}).enabled());
+  CHECK(!CactusStopSequenceMatcher({""}).enabled());
+  CHECK(CactusStopSequenceMatcher({"</s>"}).enabled());
+}
+
+TEST(StopsOnThePieceThatCompletesASequence) {
+  CactusStopSequenceMatcher matcher({"<|im_end|>"});
+  CHECK(!matcher.feed("Hello"));
+  CHECK(!matcher.feed(" <|im"));
+  CHECK(matcher.feed("_end|> trailing"));
+}
+
+TEST(MatchesSequencesThatOverlapTheOutput) {
+  // The failure links carry a partial match of "abc" over "aab"
+  CactusStopSequenceMatcher matcher({"abc"});
+  CHECK(!matcher.feed("aab"));
+  CHECK(matcher.feed("c"));
+}
+
+TEST(MatchesASequenceInsideAnother) {
+  CactusStopSequenceMatcher matcher({"xyz!", "yz"});
+  CHECK(!matcher.feed("xy"));
+  CHECK(matcher.feed("z"));
+}
+
+TEST(MatchesAnyOfSeveralSequences) {
+  CactusStopSequenceMatcher first({"\n\n", "END"});
+  CHECK(!first.feed("one\ntwo EN"));
+  CHECK(first.feed("D"));
+
+  CactusStopSequenceMatcher second({"\n\n", "END"});
+  CHECK(second.feed("one\n\n"));
+}
+
+TEST(MatchesMultiByteCharacters) {
+  CactusStopSequenceMatcher matcher({"\xE2\x9C\x93"});
+  CHECK(!matcher.feed("done \xE2"));
+  CHECK(!matcher.feed("\x9C"));
+  CHECK(matcher.feed("\x93"));
+}
+
+TEST(ReadsTheStopSequencesOfTheOptions) {
+  const auto sequences = CactusStopSequenceMatcher::sequencesOf(
+      R"({"temperature":0.7,"stop_sequences":["<|im_end|>","\n\nUser:"],)"
+      R"("max_tokens":64})");
+  CHECK(sequences.size() == 2);
+  CHECK(sequences[0] == "<|im_end|>");
+  CHECK(sequences[1] == "\n\nUser:");
+
+  CHECK(CactusStopSequenceMatcher::sequencesOf("").empty());
+  CHECK(CactusStopSequenceMatcher::sequencesOf(R"({"top_k":40})").empty());
+}
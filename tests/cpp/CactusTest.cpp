@@ -0,0 +1,12 @@
+#include "CactusTest.hpp"
+
+int main() {
+  for (const auto &test : cactus_test::cases()) {
+    const int failures = cactus_test::failures();
+    test.run();
+    std::fprintf(stderr, "%s %s\n",
+                 cactus_test::failures() == failures ? "PASS" : "FAIL",
+                 test.name);
+  }
+  return cactus_test::failures() == 0 ? 0 : 1;
+}
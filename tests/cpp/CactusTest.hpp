@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// A minimal runner for the host tests of the wrapper. Every TEST in a file is
+// run by the main of CactusTest.cpp, and a failed CHECK fails the test binary
+// without stopping the others.
+namespace cactus_test {
+
+struct Case {
+  const char *name;
+  void (*run)();
+};
+
+inline std::vector<Case> &cases() {
+  static std::vector<Case> cases;
+  return cases;
+}
+
+inline int &failures() {
+  static int failures = 0;
+  return failures;
+}
+
+struct Registration {
+  Registration(const char *name, void (*run)()) {
+    cases().push_back({name, run});
+  }
+};
+
+// An empty directory of its own, removed again with the object
+class TemporaryDirectory {
+public:
+  explicit TemporaryDirectory(const std::string &name)
+      : _path(std::filesystem::temp_directory_path() /
+              ("cactus_" + name + "_" + std::to_string(getpid()))) {
+    std::filesystem::remove_all(_path);
+    std::filesystem::create_directories(_path);
+  }
+
+  ~TemporaryDirectory() {
+    std::error_code error;
+    std::filesystem::remove_all(_path, error);
+  }
+
+  const std::filesystem::path &path() const { return _path; }
+
+  std::string file(const std::string &name) const {
+    return (_path / name).string();
+  }
+
+private:
+  std::filesystem::path _path;
+};
+
+} // namespace cactus_test
+
+#define TEST(name)                                                             \
+  static void name();                                                          \
+  static const cactus_test::Registration name##Registration(#name, name);      \
+  static void name()
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,    \
+                   #condition);                                                \
+      cactus_test::failures()++;                                               \
+    }                                                                          \
+  } while (false)
+
+#define CHECK_THROWS(statement)                                                \
+  do {                                                                         \
+    bool threw = false;                                                        \
+    try {                                                                      \
+      statement;                                                               \
+    } catch (...) {                                                            \
+      threw = true;                                                            \
+    }                                                                          \
+    if (!threw) {                                                              \
+      std::fprintf(stderr, "%s:%d: %s did not throw\n", __FILE__, __LINE__,    \
+                   #statement);                                                \
+      cactus_test::failures()++;                                               \
+    }                                                                          \
+  } while (false)
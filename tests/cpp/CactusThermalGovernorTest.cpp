@@ -0,0 +1,58 @@
+#include "CactusTest.hpp"
+#include "CactusThermalGovernor.hpp"
+
+#include <chrono>
+
+using margelo::nitro::cactus::CactusThermalGovernor;
+using margelo::nitro::cactus::CactusThermalState;
+using margelo::nitro::cactus::thermalSpeedFraction;
+using margelo::nitro::cactus::thermalStateName;
+using margelo::nitro::cactus::thermalStateOfAndroidStatus;
+
+TEST(MapsAndroidStatusesLikeTheIosStates) {
+  CHECK(thermalStateOfAndroidStatus(0) == CactusThermalState::Nominal);
+  CHECK(thermalStateOfAndroidStatus(1) == CactusThermalState::Fair);
+  CHECK(thermalStateOfAndroidStatus(2) == CactusThermalState::Fair);
+  CHECK(thermalStateOfAndroidStatus(3) == CactusThermalState::Serious);
+  CHECK(thermalStateOfAndroidStatus(4) == CactusThermalState::Critical);
+  CHECK(thermalStateOfAndroidStatus(6) == CactusThermalState::Critical);
+  // ATHERMAL_STATUS_ERROR
+  CHECK(thermalStateOfAndroidStatus(-1) == CactusThermalState::Nominal);
+}
+
+TEST(SlowsDownOnlyWhenHot) {
+  CHECK(thermalSpeedFraction(CactusThermalState::Nominal) == 1);
+  CHECK(thermalSpeedFraction(CactusThermalState::Fair) == 1);
+  CHECK(thermalSpeedFraction(CactusThermalState::Serious) < 1);
+  CHECK(thermalSpeedFraction(CactusThermalState::Critical) <
+        thermalSpeedFraction(CactusThermalState::Serious));
+  CHECK(std::string(thermalStateName(CactusThermalState::Serious)) ==
+        "serious");
+}
+
+TEST(ReportsNothingWhileDisabled) {
+  CactusThermalGovernor governor;
+  governor.begin();
+  governor.throttle();
+  governor.end(30);
+  CHECK(governor.responseFields().empty());
+}
+
+TEST(NeverCapsANominalDevice) {
+  // The host always reports a nominal state
+  CactusThermalGovernor governor;
+  governor.setEnabled(true);
+  governor.begin();
+  governor.end(1000);
+  governor.begin();
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 100; i++) {
+    governor.throttle();
+  }
+  CHECK(std::chrono::steady_clock::now() - start <
+        std::chrono::milliseconds(50));
+  CHECK(governor.responseFields() == "\"thermal_state\":\"nominal\","
+                                     "\"decode_cap_tokens_per_second\":"
+                                     "0.000000");
+}
@@ -0,0 +1,83 @@
+#include "CactusTest.hpp"
+#include "CactusTokenStream.hpp"
+
+#include <thread>
+
+using margelo::nitro::cactus::CactusTokenRingBuffer;
+using margelo::nitro::cactus::CactusTokenStream;
+
+TEST(RingDrainsWhatWasPushed) {
+  CactusTokenRingBuffer ring(8);
+  CHECK(ring.drain().empty());
+  CHECK(ring.push("abc", 3));
+  CHECK(ring.push("de", 2));
+  CHECK(ring.space() == 3);
+  CHECK(ring.drain() == "abcde");
+  CHECK(ring.space() == 8);
+}
+
+TEST(RingRefusesWhatDoesNotFit) {
+  CactusTokenRingBuffer ring(4);
+  CHECK(ring.push("abc", 3));
+  CHECK(!ring.push("de", 2));
+  CHECK(ring.drain() == "abc");
+}
+
+TEST(RingWrapsAround) {
+  CactusTokenRingBuffer ring(4);
+  CHECK(ring.push("abc", 3));
+  CHECK(ring.drain() == "abc");
+  CHECK(ring.push("defg", 4));
+  CHECK(ring.drain() == "defg");
+}
+
+TEST(StreamDeliversTokensInOrder) {
+  CactusTokenStream stream;
+  stream.push("Hello");
+  stream.push(" world");
+  CHECK(stream.drain() == "Hello world");
+  stream.finish();
+  CHECK(stream.drain().empty());
+}
+
+TEST(StreamKeepsWhatDidNotFitUntilItFinishes) {
+  // 64 KiB fill the ring, the rest waits for room
+  CactusTokenStream stream;
+  const std::string first(64 * 1024, 'a');
+  stream.push(first);
+  stream.push("tail");
+  CHECK(stream.drain() == first);
+  stream.finish();
+  CHECK(stream.drain() == "tail");
+}
+
+TEST(StreamNeverSplitsACharacter) {
+  CactusTokenStream stream;
+  stream.push(std::string(64 * 1024 - 1, 'a'));
+  stream.push("\xC3\xA9");
+  CHECK(stream.drain().size() == 64 * 1024 - 1);
+  stream.push("");
+  CHECK(stream.drain() == "\xC3\xA9");
+}
+
+TEST(StreamLosesNothingWhileDrainedConcurrently) {
+  CactusTokenStream stream;
+  std::string expected;
+  for (int i = 0; i < 200000; i++) {
+    expected += "token" + std::to_string(i) + ' ';
+  }
+
+  std::thread producer([&stream] {
+    for (int i = 0; i < 200000; i++) {
+      stream.push("token" + std::to_string(i) + ' ');
+    }
+    stream.finish();
+  });
+  std::string received;
+  while (received.size() < expected.size()) {
+    received += stream.drain();
+  }
+  producer.join();
+  received += stream.drain();
+  CHECK(received == expected);
+}
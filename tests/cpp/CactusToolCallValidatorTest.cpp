@@ -0,0 +1,122 @@
+#include "CactusTest.hpp"
+#include "CactusToolCallValidator.hpp"
+
+using margelo::nitro::cactus::CactusToolCallValidator;
+
+namespace {
+
+const std::string kTools = R"([
+  {"type":"function","function":{"name":"get_weather","parameters":{
+    "type":"object",
+    "properties":{"location":{"type":"string"},"unit":{"type":"string"}},
+    "required":["location"]}}},
+  {"type":"function","function":{"name":"free_form","parameters":{
+    "type":"object"}}}
+])";
+
+// Responses are shaped like the ones construct_response_json of the engine
+// writes, with the calls it parsed out of the decoded text
+std::string response(const std::string &functionCalls) {
+  return R"({"success":true,"response":"",)" + functionCalls +
+         R"("time_to_first_token_ms":1.00,"total_tokens":3})";
+}
+
+} // namespace
+
+TEST(IsDisabledWithoutTools) {
+  CHECK(!CactusToolCallValidator("").enabled());
+  CHECK(!CactusToolCallValidator("[]").enabled());
+  CHECK(CactusToolCallValidator(kTools).enabled());
+}
+
+TEST(IsDisabledByToolsItCannotRead) {
+  CHECK(!CactusToolCallValidator(R"([{"function":{"name":"f")").enabled());
+}
+
+TEST(AcceptsAResponseWithoutCalls) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator.check(response("")).empty());
+}
+
+TEST(AcceptsACallOfAKnownTool) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator
+            .check(response(R"("function_calls":[{"name":"get_weather",)"
+                            R"("arguments":{"location":"Paris"}}],)"))
+            .empty());
+}
+
+TEST(AcceptsBareValuesTheEngineSplitsAtCommas) {
+  // get_weather(location=[Paris], unit=}) comes out of the engine with every
+  // value as a string
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator
+            .check(response(R"("function_calls":[{"name":"get_weather",)"
+                            R"("arguments":{"location":"[Paris]",)"
+                            R"("unit":"}"}}],)"))
+            .empty());
+}
+
+TEST(AcceptsAJsonFunctionCall) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator
+            .check(response(R"("function_calls":[{"name":"get_weather",)"
+                            R"("arguments":{"location":{"city":"Paris"},)"
+                            R"("unit":["c"]}}],)"))
+            .empty());
+}
+
+TEST(AcceptsArgumentsEncodedAsAString) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator
+            .check(response(R"("function_calls":[{"name":"get_weather",)"
+                            R"("arguments":"{\"location\":\"Paris\"}"}],)"))
+            .empty());
+}
+
+TEST(AcceptsAnyArgumentOfAToolWithoutProperties) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator
+            .check(response(R"("function_calls":[{"name":"free_form",)"
+                            R"("arguments":{"anything":"goes"}}],)"))
+            .empty());
+}
+
+TEST(RejectsAnUnknownTool) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator.check(response(R"("function_calls":[{"name":"get_time",)"
+                                 R"("arguments":{}}],)")) ==
+        "Unknown tool get_time");
+}
+
+TEST(RejectsAnUnknownArgument) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator.check(
+            response(R"("function_calls":[{"name":"get_weather",)"
+                     R"("arguments":{"location":"Paris","days":"3"}}],)")) ==
+        "Unknown argument days of tool get_weather");
+}
+
+TEST(RejectsAMissingRequiredArgument) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator.check(response(R"("function_calls":[{"name":"get_weather",)"
+                                 R"("arguments":{"unit":"c"}}],)")) ==
+        "Missing argument location of tool get_weather");
+}
+
+TEST(RejectsACallWithoutArguments) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator.check(response(
+            R"("function_calls":[{"name":"get_weather"}],)")) ==
+        "Missing argument location of tool get_weather");
+}
+
+TEST(ReportsTheFirstInvalidCall) {
+  CactusToolCallValidator validator(kTools);
+  CHECK(validator.check(response(
+            R"("function_calls":[)"
+            R"({"name":"get_weather","arguments":{"location":"Paris"}},)"
+            R"({"name":"get_time","arguments":{}},)"
+            R"({"name":"get_date","arguments":{}}],)")) ==
+        "Unknown tool get_time");
+}
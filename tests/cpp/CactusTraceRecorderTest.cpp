@@ -0,0 +1,106 @@
+#include "CactusJsonReader.hpp"
+#include "CactusTest.hpp"
+#include "CactusTraceRecorder.hpp"
+
+#include <vector>
+
+using margelo::nitro::cactus::CactusJsonReader;
+using margelo::nitro::cactus::CactusTraceRecorder;
+using Clock = CactusTraceRecorder::Clock;
+
+namespace {
+
+struct Event {
+  std::string name;
+  std::string category;
+  std::string phase;
+  double ts = -1;
+  double dur = -1;
+  std::string args;
+};
+
+std::vector<Event> readTrace(const std::string &json) {
+  std::vector<Event> events;
+  CactusJsonReader reader(json);
+  CHECK(reader.object([&](const std::string &key) {
+    if (key != "traceEvents") {
+      return reader.skip();
+    }
+    return reader.array([&]() {
+      auto &added = events.emplace_back();
+      return reader.object([&](const std::string &field) {
+        if (field == "name") {
+          return reader.string(added.name);
+        }
+        if (field == "cat") {
+          return reader.string(added.category);
+        }
+        if (field == "ph") {
+          return reader.string(added.phase);
+        }
+        if (field == "ts") {
+          return reader.number(added.ts);
+        }
+        if (field == "dur") {
+          return reader.number(added.dur);
+        }
+        if (field == "args") {
+          return reader.object([&](const std::string &arg) {
+            added.args += arg;
+            return reader.skip();
+          });
+        }
+        return reader.skip();
+      });
+    });
+  }));
+  return events;
+}
+
+} // namespace
+
+TEST(RecordsNothingWhileDisabled) {
+  CactusTraceRecorder recorder;
+  const auto now = Clock::now();
+  recorder.add("complete", "model", now, now);
+  CHECK(readTrace(recorder.take()).empty());
+}
+
+TEST(WritesCompleteEventsRelativeToTheStart) {
+  CactusTraceRecorder recorder;
+  recorder.setEnabled(true);
+  const auto start = Clock::now() + std::chrono::milliseconds(5);
+  recorder.add("prefill", "model", start, start + std::chrono::milliseconds(3),
+               R"("tokens":12,"cached":true)");
+
+  const auto events = readTrace(recorder.take());
+  CHECK(events.size() == 1);
+  CHECK(events[0].name == "prefill" && events[0].category == "model");
+  CHECK(events[0].phase == "X");
+  CHECK(events[0].ts >= 5000);
+  CHECK(events[0].dur == 3000);
+  CHECK(events[0].args == "tokenscached");
+}
+
+TEST(ClearsWhatWasTaken) {
+  CactusTraceRecorder recorder;
+  recorder.setEnabled(true);
+  const auto now = Clock::now();
+  recorder.add("a", "model", now, now);
+  recorder.add("b", "model", now, now);
+  CHECK(readTrace(recorder.take()).size() == 2);
+  CHECK(readTrace(recorder.take()).empty());
+}
+
+TEST(DropsEventsFromBeforeItWasEnabledAgain) {
+  CactusTraceRecorder recorder;
+  recorder.setEnabled(true);
+  const auto now = Clock::now();
+  recorder.add("old", "model", now, now);
+  recorder.setEnabled(false);
+  recorder.setEnabled(true);
+  recorder.add("new", "model", Clock::now(), Clock::now());
+
+  const auto events = readTrace(recorder.take());
+  CHECK(events.size() == 1 && events[0].name == "new");
+}
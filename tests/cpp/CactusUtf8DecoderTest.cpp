@@ -0,0 +1,42 @@
+#include "CactusTest.hpp"
+#include "CactusUtf8Decoder.hpp"
+
+using margelo::nitro::cactus::CactusUtf8Decoder;
+
+TEST(PassesOnAsciiAsItComes) {
+  CactusUtf8Decoder decoder;
+  CHECK(decoder.feed("Hello") == "Hello");
+  CHECK(decoder.feed(" world") == " world");
+  CHECK(decoder.flush().empty());
+}
+
+TEST(HoldsACharacterUntilItIsComplete) {
+  // "é" is C3 A9
+  CactusUtf8Decoder decoder;
+  CHECK(decoder.feed("caf\xC3") == "caf");
+  CHECK(decoder.feed("\xA9!") == "\xC3\xA9!");
+}
+
+TEST(JoinsACharacterSplitOverSeveralTokens) {
+  // U+1F335 is F0 9F 8C B5
+  CactusUtf8Decoder decoder;
+  CHECK(decoder.feed("\xF0").empty());
+  CHECK(decoder.feed("\x9F").empty());
+  CHECK(decoder.feed("\x8C").empty());
+  CHECK(decoder.feed("\xB5") == "\xF0\x9F\x8C\xB5");
+  CHECK(decoder.flush().empty());
+}
+
+TEST(EndsAnUnfinishedCharacterWithAReplacement) {
+  CactusUtf8Decoder decoder;
+  CHECK(decoder.feed("a\xE2\x82") == "a");
+  CHECK(decoder.flush() == "\xEF\xBF\xBD");
+  CHECK(decoder.flush().empty());
+  CHECK(decoder.feed("b") == "b");
+}
+
+TEST(PassesOnStrayContinuationBytes) {
+  CactusUtf8Decoder decoder;
+  CHECK(decoder.feed("\xA9\xA9") == "\xA9\xA9");
+  CHECK(decoder.flush().empty());
+}
@@ -0,0 +1,199 @@
+#include "CactusTest.hpp"
+#include "CactusVectorIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+
+using margelo::nitro::cactus::CactusVectorIndex;
+
+namespace {
+
+constexpr size_t kDimension = 32;
+
+std::vector<float> randomVectors(size_t count, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::normal_distribution<float> normal;
+  std::vector<float> vectors(count * kDimension);
+  for (float &value : vectors) {
+    value = normal(random);
+  }
+  return vectors;
+}
+
+// Spread around a few topics, as embeddings of related texts are
+std::vector<float> clusteredVectors(size_t count, uint32_t seed) {
+  const auto centres = randomVectors(64, 99);
+  std::mt19937 random(seed);
+  std::normal_distribution<float> normal(0, 0.4f);
+  std::uniform_int_distribution<size_t> centre(0, 63);
+  std::vector<float> vectors(count * kDimension);
+  for (size_t i = 0; i < count; ++i) {
+    const float *from = centres.data() + centre(random) * kDimension;
+    for (size_t d = 0; d < kDimension; ++d) {
+      vectors[i * kDimension + d] = from[d] + normal(random);
+    }
+  }
+  return vectors;
+}
+
+std::vector<int64_t> sequentialIds(size_t count, int64_t first = 0) {
+  std::vector<int64_t> ids(count);
+  for (size_t i = 0; i < count; ++i) {
+    ids[i] = first + static_cast<int64_t>(i);
+  }
+  return ids;
+}
+
+// The ids of the k vectors most similar to the query, by exact search
+std::set<int64_t> exactNeighbours(const std::vector<float> &vectors,
+                                  const float *query, size_t k) {
+  std::vector<std::pair<float, int64_t>> scores;
+  for (size_t i = 0; i < vectors.size() / kDimension; ++i) {
+    float dot = 0, norm = 0;
+    for (size_t d = 0; d < kDimension; ++d) {
+      dot += vectors[i * kDimension + d] * query[d];
+      norm += vectors[i * kDimension + d] * vectors[i * kDimension + d];
+    }
+    scores.emplace_back(dot / std::sqrt(norm), static_cast<int64_t>(i));
+  }
+  std::partial_sort(scores.begin(), scores.begin() + k, scores.end(),
+                    std::greater<>());
+  std::set<int64_t> ids;
+  for (size_t i = 0; i < k; ++i) {
+    ids.insert(scores[i].second);
+  }
+  return ids;
+}
+
+} // namespace
+
+TEST(FindsAnIndexedVector) {
+  cactus_test::TemporaryDirectory directory("index_find");
+  CactusVectorIndex index(directory.file("index"), kDimension);
+  const auto vectors = randomVectors(100, 1);
+  const auto ids = sequentialIds(100, 1000);
+  index.add(ids.data(), vectors.data(), ids.size());
+
+  const auto results = index.query(vectors.data() + 42 * kDimension, 3, 1);
+  CHECK(results.size() == 3);
+  CHECK(results[0].id == 1042);
+  CHECK(results[0].score > 0.99f);
+  CHECK(results[0].score >= results[1].score);
+  CHECK(results[1].score >= results[2].score);
+}
+
+TEST(ReplacesAndRemovesIds) {
+  cactus_test::TemporaryDirectory directory("index_replace");
+  CactusVectorIndex index(directory.file("index"), kDimension);
+  const auto vectors = randomVectors(3, 2);
+  const int64_t ids[] = {1, 2, 1};
+  index.add(ids, vectors.data(), 3);
+  CHECK(index.size() == 2);
+
+  const auto results = index.query(vectors.data(), 2, 1);
+  CHECK(results.size() == 2);
+  CHECK(results[0].id != 1 || results[0].score < 0.99f);
+
+  index.remove(ids, 1);
+  CHECK(index.size() == 1);
+  CHECK(index.query(vectors.data(), 5, 1).size() == 1);
+}
+
+TEST(ReturnsNothingForAZeroQueryOrK) {
+  cactus_test::TemporaryDirectory directory("index_zero");
+  CactusVectorIndex index(directory.file("index"), kDimension);
+  const auto vectors = randomVectors(10, 3);
+  const auto ids = sequentialIds(10);
+  index.add(ids.data(), vectors.data(), ids.size());
+
+  const std::vector<float> zero(kDimension, 0);
+  CHECK(index.query(zero.data(), 5, 1).empty());
+  CHECK(index.query(vectors.data(), 0, 1).empty());
+}
+
+TEST(PersistsAcrossReopening) {
+  cactus_test::TemporaryDirectory directory("index_persist");
+  const auto vectors = randomVectors(2000, 4);
+  const auto ids = sequentialIds(2000);
+  {
+    CactusVectorIndex index(directory.file("index"), kDimension);
+    index.add(ids.data(), vectors.data(), ids.size());
+    index.remove(ids.data() + 7, 1);
+  }
+
+  CactusVectorIndex index(directory.file("index"), kDimension);
+  CHECK(index.size() == 1999);
+  const auto results = index.query(vectors.data() + 8 * kDimension, 1, 64);
+  CHECK(results.size() == 1 && results[0].id == 8);
+  CHECK_THROWS(CactusVectorIndex(directory.file("index"), kDimension + 1));
+}
+
+TEST(RecallsMostExactNeighboursOnceTrained) {
+  cactus_test::TemporaryDirectory directory("index_recall");
+  CactusVectorIndex index(directory.file("index"), kDimension);
+  const auto vectors = clusteredVectors(5000, 5);
+  const auto ids = sequentialIds(5000);
+  index.add(ids.data(), vectors.data(), ids.size());
+
+  constexpr size_t k = 10;
+  constexpr size_t queryCount = 100;
+  const auto queries = clusteredVectors(queryCount, 6);
+  auto recall = [&](size_t probes) {
+    size_t found = 0;
+    for (size_t q = 0; q < queryCount; ++q) {
+      const float *query = queries.data() + q * kDimension;
+      const auto exact = exactNeighbours(vectors, query, k);
+      for (const auto &result : index.query(query, k, probes)) {
+        found += exact.count(result.id);
+      }
+    }
+    return static_cast<double>(found) / (queryCount * k);
+  };
+  const double probed = recall(8);
+  const double exhaustive = recall(1024);
+  // Of about 71 lists. Only the int8 codes cost recall once every list is
+  // scanned.
+  CHECK(probed >= 0.9);
+  CHECK(exhaustive >= 0.95);
+}
+
+TEST(DropsARecordCutShortByAKill) {
+  cactus_test::TemporaryDirectory directory("index_torn");
+  const auto path = directory.file("index");
+  const auto vectors = randomVectors(20, 7);
+  const auto ids = sequentialIds(20);
+  {
+    CactusVectorIndex index(path, kDimension);
+    index.add(ids.data(), vectors.data(), ids.size());
+  }
+  const auto fullSize = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, fullSize - 5);
+
+  {
+    CactusVectorIndex index(path, kDimension);
+    CHECK(index.size() == 19);
+    const auto results = index.query(vectors.data() + 18 * kDimension, 1, 1);
+    CHECK(results.size() == 1 && results[0].id == 18);
+
+    // The next append follows the last whole record
+    index.add(ids.data() + 19, vectors.data() + 19 * kDimension, 1);
+    CHECK(index.size() == 20);
+  }
+
+  CactusVectorIndex index(path, kDimension);
+  CHECK(index.size() == 20);
+  const auto results = index.query(vectors.data() + 19 * kDimension, 1, 1);
+  CHECK(results.size() == 1 && results[0].id == 19);
+}
+
+TEST(RejectsAFileThatIsNoIndex) {
+  cactus_test::TemporaryDirectory directory("index_invalid");
+  const auto path = directory.file("index");
+  FILE *file = std::fopen(path.c_str(), "wb");
+  std::fputs("not an index at all, but long enough", file);
+  std::fclose(file);
+  CHECK_THROWS(CactusVectorIndex(path, kDimension));
+  CHECK_THROWS(CactusVectorIndex(directory.file("other"), 0));
+}
@@ -0,0 +1,111 @@
+#include "CactusTest.hpp"
+#include "CactusWav.hpp"
+
+#include <cmath>
+#include <fstream>
+
+using margelo::nitro::cactus::readWav;
+using margelo::nitro::cactus::writeWav;
+
+namespace {
+
+void put(std::string &out, uint32_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+// A WAV file with the given format chunk, an odd sized chunk the reader has
+// to skip and the data
+std::string wavFile(uint16_t format, uint16_t channels, uint16_t bits,
+                    const std::string &data, bool extensible = false) {
+  std::string fmt;
+  put(fmt, extensible ? 0xFFFE : format, 2);
+  put(fmt, channels, 2);
+  put(fmt, 44100, 4);
+  put(fmt, 44100 * channels * bits / 8, 4);
+  put(fmt, channels * bits / 8, 2);
+  put(fmt, bits, 2);
+  if (extensible) {
+    put(fmt, 22, 2);
+    put(fmt, bits, 2);
+    put(fmt, 0, 4);
+    put(fmt, format, 2);
+    fmt += std::string(14, '\0');
+  }
+
+  std::string body = "WAVE";
+  body += "fmt ";
+  put(body, fmt.size(), 4);
+  body += fmt;
+  body += "LIST";
+  put(body, 3, 4);
+  body += std::string("abc") + '\0';
+  body += "data";
+  put(body, data.size(), 4);
+  body += data;
+
+  std::string file = "RIFF";
+  put(file, body.size(), 4);
+  return file + body;
+}
+
+void writeFile(const std::string &path, const std::string &contents) {
+  std::ofstream(path, std::ios::binary) << contents;
+}
+
+} // namespace
+
+TEST(MixesStereoPcmDownToMono) {
+  cactus_test::TemporaryDirectory directory("wav_pcm");
+  std::string data;
+  put(data, 16384, 2);
+  put(data, static_cast<uint16_t>(-16384), 2);
+  put(data, 32767, 2);
+  put(data, 32767, 2);
+  writeFile(directory.file("a.wav"), wavFile(1, 2, 16, data));
+
+  const auto audio = readWav(directory.file("a.wav"));
+  CHECK(audio.sampleRate == 44100);
+  CHECK(audio.samples.size() == 2);
+  CHECK(std::fabs(audio.samples[0]) < 1e-6f);
+  CHECK(std::fabs(audio.samples[1] - 1) < 1e-3f);
+}
+
+TEST(ReadsFloatAndExtensibleFiles) {
+  cactus_test::TemporaryDirectory directory("wav_float");
+  const float samples[] = {0.25f, -0.75f};
+  const std::string data(reinterpret_cast<const char *>(samples),
+                         sizeof(samples));
+  writeFile(directory.file("a.wav"), wavFile(3, 1, 32, data, true));
+
+  const auto audio = readWav(directory.file("a.wav"));
+  CHECK(audio.samples.size() == 2);
+  CHECK(audio.samples[0] == 0.25f);
+  CHECK(audio.samples[1] == -0.75f);
+}
+
+TEST(ReadsBackWhatItWrites) {
+  cactus_test::TemporaryDirectory directory("wav_roundtrip");
+  const float samples[] = {0, 0.5f, -1, 2};
+  writeWav(directory.file("a.wav"), samples, 4);
+
+  const auto audio = readWav(directory.file("a.wav"));
+  CHECK(audio.sampleRate == 16000);
+  CHECK(audio.samples.size() == 4);
+  CHECK(std::fabs(audio.samples[1] - 0.5f) < 1e-3f);
+  CHECK(std::fabs(audio.samples[2] + 1) < 1e-3f);
+  // Clipped to full scale
+  CHECK(std::fabs(audio.samples[3] - 1) < 1e-3f);
+}
+
+TEST(RejectsFilesItCannotRead) {
+  cactus_test::TemporaryDirectory directory("wav_reject");
+  CHECK_THROWS(readWav(directory.file("missing.wav")));
+
+  writeFile(directory.file("text.wav"), "not a wav file at all");
+  CHECK_THROWS(readWav(directory.file("text.wav")));
+
+  writeFile(directory.file("pcm8.wav"), wavFile(1, 1, 8, "abcd"));
+  CHECK_THROWS(readWav(directory.file("pcm8.wav")));
+}